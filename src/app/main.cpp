@@ -1,95 +1,516 @@
-#include <cassert>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <optional>
 #include <string>
-#include <vector>
+#include <string_view>
 
+#include "binary_parser.h"
+#include "cpu_affinity.h"
+#include "frame_reader.h"
+#include "journal.h"
+#include "line_reader.h"
+#include "market_data_ring.h"
 #include "matching_engine.h"
 #include "messages.h"
+#include "output_writer.h"
+#include "pipelined_matching_engine.h"
+#include "recovery.h"
+#include "sharded_matching_engine.h"
+#include "snapshot.h"
+#include "symbol_registry.h"
+#include "text_parser.h"
 
 using namespace gemini;
 
-enum NewOrderFieldIndex {
-    OrderId = 0,
-    Side = 1,
-    Symbol = 2,
-    Quantity = 3,
-    Price = 4,
+// writes each outbound message as it is generated, called by its concrete type
+// (trades in one batch per inbound order) so the engine's output path is
+// resolved at compile time
+struct PrintSink {
+    const SymbolRegistry &symbols;
+    OutputWriter &writer;
+
+    void operator()(TradeSpan trades) const {
+        for (auto const &trade : trades) {
+            writer.WriteTrade(symbols.Name(trade.symbol), trade);
+        }
+    }
+    void operator()(const CancelAck &ack) const { writer.WriteCancelAck(symbols.Name(ack.symbol), ack); }
+    void operator()(const ReplaceAck &ack) const { writer.WriteReplaceAck(symbols.Name(ack.symbol), ack); }
+    void operator()(const Reject &reject) const { writer.WriteReject(symbols.Name(reject.symbol), reject); }
+};
+
+// as PrintSink, also publishing the trades to the market data ring
+struct PublishingSink {
+    PrintSink print;
+    MarketDataPublisher publish;
+
+    void operator()(TradeSpan trades) const {
+        print(trades);
+        publish(trades);
+    }
+    template <typename Msg>
+    void operator()(const Msg &msg) const {
+        print(msg);
+    }
 };
 
-// breaks the line into substrings
-std::vector<std::string> ParseLine(const std::string &line) {
-    std::vector<std::string> result;
+// as PrintSink for the pipelined engine, which hands over the symbol name with
+// each message as it calls the sink on its own thread
+struct PipelineSink {
+    OutputWriter &writer;
+
+    void operator()(const std::string &symbolName, const Trade &trade) const { writer.WriteTrade(symbolName, trade); }
+    void operator()(const std::string &symbolName, const CancelAck &ack) const {
+        writer.WriteCancelAck(symbolName, ack);
+    }
+    void operator()(const std::string &symbolName, const ReplaceAck &ack) const {
+        writer.WriteReplaceAck(symbolName, ack);
+    }
+    void operator()(const std::string &symbolName, const Reject &reject) const {
+        writer.WriteReject(symbolName, reject);
+    }
+};
+
+// throughput of the input side, written to stderr so it never mixes with the output
+//
+// unit is what the reader counts, lines for text and messages for binary input
+template <typename Reader>
+void PrintInputStats(const Reader &reader, const char *unit, unsigned long count,
+                     std::chrono::steady_clock::duration elapsed) {
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    auto megabytes = static_cast<double>(reader.Bytes()) / 1e6;
+    auto rate = static_cast<double>(count);
+
+    std::fprintf(stderr, "Read %lu %s (%.1f MB, %s) in %.3f s: %.0f %s/s, %.1f MB/s\n", count, unit, megabytes,
+                 reader.IsMapped() ? "mapped" : "streamed", seconds, seconds > 0 ? rate / seconds : 0.0, unit,
+                 seconds > 0 ? megabytes / seconds : 0.0);
+}
+
+void PrintStageStats(const char *name, const StageCounters &counters) {
+    std::fprintf(stderr, "  %-6s %lu items, %.0f items/s busy, waited %lu times for %.3f s\n", name, counters.items,
+                 counters.Rate(), counters.waits, std::chrono::duration<double>(counters.waited).count());
+}
+
+// where each stage of the pipeline spent its time, the slowest sets the pace
+void PrintPipelineStats(const PipelineStats &stats) {
+    std::fprintf(stderr, "Pipeline stages:\n");
+    PrintStageStats("parse", stats.input);
+    PrintStageStats("match", stats.matching);
+    PrintStageStats("format", stats.output);
+}
+
+// calls fn(const MessageHeader &) for each message in the text input, stops at
+// an exit line or when fn returns false
+template <typename Fn>
+void ForEachTextMessage(LineReader &reader, TextParser &parser, Fn &&fn) {
+    reader.ForEachLine([&](std::string_view line) {
+        if (line == "exit") {
+            return false;
+        }
+
+        switch (parser.Parse(line)) {
+            case ParseStatusEnum::Ok:
+                return fn(parser.Message());
+            case ParseStatusEnum::OrderIdTooLong:
+                std::cerr << "Order id too long, skipping: " << line << std::endl;
+                return true;
+            default:
+                // blank or malformed line
+                return true;
+        }
+    });
+}
 
-    std::string field;
-    for (auto c : line) {
-        if (isspace(c)) {
-            if (!field.empty()) {
-                result.push_back(std::move(field));
-                field.clear();
+// as above for binary input
+template <typename Fn>
+void ForEachBinaryMessage(FrameReader &reader, BinaryParser &parser, Fn &&fn) {
+    reader.ForEachFrame([&](const wire::Header &frame) {
+        switch (parser.Parse(frame)) {
+            case ParseStatusEnum::Ok:
+                return fn(parser.Message());
+            case ParseStatusEnum::Malformed: {
+                auto messageType = static_cast<MessageTypeEnum::Type>(frame.messageType);
+                std::cerr << "Malformed " << MessageTypeEnum::ToString(messageType) << " message, skipping"
+                          << std::endl;
+                return true;
             }
-        } else {
-            field.push_back(c);
+            default:
+                // a symbol definition
+                return true;
         }
+    });
+
+    if (reader.Corrupt()) {
+        std::cerr << "Input ends in a corrupt or truncated message" << std::endl;
+    }
+}
+
+// feeds every message to the engine, then dumps the book, returns how long the
+// input took to process
+//
+// forEachMessage(fn) must call fn(const MessageHeader &) for each message, see
+// ForEachTextMessage.
+template <typename Engine, typename ForEachMessage>
+std::chrono::steady_clock::duration Run(Engine &engine, ForEachMessage &&forEachMessage, OutputWriter &writer) {
+    // someone typing orders in expects to see the trades straight away
+    auto interactive = isatty(STDOUT_FILENO) != 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    forEachMessage([&](const MessageHeader &msg) {
+        engine.OnMessage(msg);
+
+        if (interactive) {
+            engine.Flush();
+            writer.Flush();
+        }
+        return true;
+    });
+
+    engine.Flush();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    writer.Append('\n');
+    engine.ForEachOrder(
+        [&](const std::string &symbolName, const Order &order) { writer.WriteOrder(symbolName, order); });
+    writer.Flush();
+
+    return elapsed;
+}
+
+// what went into the journal, written to stderr like the input stats
+void PrintJournalStats(const Journal &journal) {
+    std::fprintf(stderr, "Journalled %lu messages (%.1f MB, fsync %s) with %lu syncs\n", journal.Entries(),
+                 static_cast<double>(journal.BytesWritten()) / 1e6,
+                 FsyncPolicyEnum::ToString(journal.Config().fsyncPolicy), journal.Syncs());
+}
+
+// the input's idle handler while journalling: commits what the journal has
+// buffered once it is due instead of leaving it until the next message comes
+// in, returns the milliseconds until it is next due, -1 if nothing is buffered
+int CommitJournalWhileIdle(Journal &journal) {
+    journal.CommitIfDue();
+
+    auto deadline = journal.CommitDeadline();
+    if (!deadline) {
+        return -1;
+    }
+
+    auto wait = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+    return wait.count() > 0 ? static_cast<int>(wait.count()) : 0;
+}
+
+void PrintUsage(const char *program) {
+    std::cerr << "Usage: " << program
+              << " [--shards N | --pipeline | [--journal FILE [--fsync POLICY]] [--snapshot FILE] [--recover]"
+                 " [--market-data NAME]] [--binary] [input-file]"
+              << std::endl;
+    std::cerr << "  --shards N      match symbols on N worker threads, output is the same as with one" << std::endl;
+    std::cerr << "  --pipeline      parse, match and format on three pinned threads, output is the same" << std::endl;
+    std::cerr << "  --journal FILE  append every message to FILE before matching it" << std::endl;
+    std::cerr << "  --fsync POLICY  ALWAYS, BATCHED (the default), DEFERRED or NEVER, see journal.h" << std::endl;
+    std::cerr << "  --snapshot FILE write the books to FILE once the input ends, see snapshot.h" << std::endl;
+    std::cerr << "  --recover       first rebuild the books from the snapshot and the journal, see recovery.h"
+              << std::endl;
+    std::cerr << "  --market-data NAME  also publish trades, level and order updates to the shared memory ring NAME,"
+                 " see market_data_ring.h"
+              << std::endl;
+    std::cerr << "  --binary        the input is binary messages, see text_to_binary" << std::endl;
+}
+
+struct Options {
+    const char *path = nullptr;
+    unsigned long numShards = 0;
+    bool pipelined = false;
+    bool binary = false;
+    const char *journalPath = nullptr;
+    FsyncPolicyEnum::Type fsyncPolicy = FsyncPolicyEnum::Batched;
+    const char *snapshotPath = nullptr;
+    bool recover = false;
+    const char *marketDataName = nullptr;
+};
+
+// opens the file if there is one, leaving fd at -1 if not, returns false if
+// it exists but cannot be opened
+bool OpenIfExists(const char *path, int flags, int &fd) {
+    fd = -1;
+    if (path == nullptr) {
+        return true;
     }
 
-    // push final field (if any)
-    if (!field.empty()) {
-        result.push_back(std::move(field));
+    fd = open(path, flags);
+    if (fd < 0 && errno != ENOENT) {
+        std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// brings the engine back to where it was before the restart from whichever
+// of the snapshot and the journal exist, see Recover, returns false if they
+// do not fit together
+//
+// An entry cut short at the end of the journal is cut off, so the journal
+// can be appended to again.
+template <typename Engine>
+bool RecoverEngine(Engine &engine, SymbolRegistry &symbols, const Options &options) {
+    auto start = std::chrono::steady_clock::now();
+
+    int snapshotFd;
+    int journalFd;
+    if (!OpenIfExists(options.snapshotPath, O_RDONLY, snapshotFd) ||
+        !OpenIfExists(options.journalPath, O_RDWR, journalFd)) {
+        return false;
+    }
+
+    auto result = Recover(engine, symbols, snapshotFd, journalFd);
+    auto ok = result.status == RecoveryStatusEnum::Ok;
+    if (ok && result.journalCutShort) {
+        std::fprintf(stderr, "Journal ends part way through an entry, cutting it back to %lu bytes\n",
+                     result.journalBytes);
+        ok = ftruncate(journalFd, static_cast<off_t>(result.journalBytes)) == 0;
+    }
+
+    if (snapshotFd >= 0) {
+        close(snapshotFd);
+    }
+    if (journalFd >= 0) {
+        close(journalFd);
+    }
+
+    if (!ok) {
+        std::cerr << "Cannot recover: " << RecoveryStatusEnum::ToString(result.status) << std::endl;
+        return false;
     }
 
-    return result;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::fprintf(stderr,
+                 "Recovered to sequence number %lu: snapshot at %lu, replayed %lu journal entries in %.3f s\n",
+                 engine.SequenceNumber(), result.snapshotSequenceNumber, result.replayed, elapsed.count());
+    return true;
 }
 
-// Constructs a new order from an exploded line
-NewOrder ConstructNewOrderFromFields(const std::vector<std::string> &fields) {
-    NewOrder result;
+// writes the snapshot to a file next to the path and then renames it over the
+// path, so a crash part way through leaves any previous snapshot as it was
+template <typename Engine>
+bool SaveSnapshot(const Engine &engine, const SymbolRegistry &symbols, const char *path) {
+    auto temporaryPath = std::string(path) + ".tmp";
 
-    if (fields.size() != 5) {
-        return result;
+    auto fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << temporaryPath << ": " << std::strerror(errno) << std::endl;
+        return false;
     }
 
-    result.orderId = fields[NewOrderFieldIndex::OrderId];
-    result.side = SideEnum::FromString(fields[NewOrderFieldIndex::Side]);
-    result.symbol = fields[NewOrderFieldIndex::Symbol];
-    result.quantity = std::stoul(fields[NewOrderFieldIndex::Quantity]);
-    result.price = std::stoul(fields[NewOrderFieldIndex::Price]);
+    SnapshotWriter writer(fd, symbols);
+    auto ok = engine.WriteSnapshot(writer) && fdatasync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || std::rename(temporaryPath.c_str(), path) != 0) {
+        std::cerr << "Cannot write snapshot " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
 
-    return result;
+    std::fprintf(stderr, "Wrote snapshot at sequence number %lu to %s\n", engine.SequenceNumber(), path);
+    return true;
 }
 
-void PrintTrade(const Trade &trade) {
-    std::cout << "TRADE " << trade.symbol << ' ' << trade.orderId << ' ' << trade.contraOrderId << ' ' << trade.quantity
-              << ' ' << trade.price << '\n';
+// runs the input through the serial engine, recovering it first and writing a
+// snapshot afterwards if the options ask for them
+template <typename Engine, typename ForEachMessage>
+bool RunSerialEngine(Engine &engine, const Options &options, SymbolRegistry &symbols, OutputWriter &writer,
+                     Journal *journal, std::chrono::steady_clock::duration &elapsed,
+                     ForEachMessage &&forEachMessage) {
+    if (options.recover && !RecoverEngine(engine, symbols, options)) {
+        return false;
+    }
+
+    // attached after recovery, which must not journal what it replays again
+    engine.AttachJournal(journal);
+    elapsed = Run(engine, forEachMessage, writer);
+
+    // everything the snapshot covers must be in the journal first
+    if (journal != nullptr) {
+        journal->Commit();
+    }
+    return options.snapshotPath == nullptr || SaveSnapshot(engine, symbols, options.snapshotPath);
 }
 
-int main() {
-    MatchingEngine engine{[](const MessageHeader &msg) {
-        switch (msg.messageType) {
-            case MessageTypeEnum::Trade:
-                PrintTrade(static_cast<const Trade &>(msg));
-                break;
-            default:
-                assert(!"unexpected message type");
+// runs the input through the engine the options ask for, see Run, returns
+// false if recovery failed or the snapshot could not be written
+//
+// Only the serial engine recovers, journals, writes snapshots and publishes
+// market data, the journal and the market data ring are nullptr otherwise.
+template <typename ForEachMessage>
+bool RunEngine(const Options &options, SymbolRegistry &symbols, OutputWriter &writer, Journal *journal,
+               MarketDataWriter *marketData, std::chrono::steady_clock::duration &elapsed,
+               ForEachMessage &&forEachMessage) {
+    if (options.pipelined) {
+        // this thread parses, the engine starts one thread to match and one to format
+        PinCurrentThread(0);
+
+        PipelineConfig config;
+        config.pinThreads = true;
+        config.matchingCpu = 1;
+        config.outputCpu = 2;
+
+        PipelinedMatchingEngine<PipelineSink> engine{symbols, PipelineSink{writer}, config};
+        elapsed = Run(engine, forEachMessage, writer);
+        PrintPipelineStats(engine.Stats());
+        return true;
+    }
+
+    if (options.numShards > 0) {
+        ShardedMatchingEngine<PrintSink> engine{symbols, options.numShards, PrintSink{symbols, writer}};
+        elapsed = Run(engine, forEachMessage, writer);
+        return true;
+    }
+
+    if (marketData != nullptr) {
+        MarketDataPublisher publisher{*marketData, symbols};
+        BasicMatchingEngine<PublishingSink, MarketDataPublisher> engine{
+            symbols, PublishingSink{PrintSink{symbols, writer}, publisher}, publisher};
+        return RunSerialEngine(engine, options, symbols, writer, journal, elapsed, forEachMessage);
+    }
+
+    BasicMatchingEngine<PrintSink> engine{symbols, PrintSink{symbols, writer}};
+    return RunSerialEngine(engine, options, symbols, writer, journal, elapsed, forEachMessage);
+}
+
+// reads from the file named on the command line, or stdin if there is none
+int main(int argc, char *argv[]) {
+    Options options;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--shards" && i + 1 < argc && ParseUnsigned(argv[i + 1], options.numShards) &&
+            options.numShards > 0) {
+            ++i;
+        } else if (arg == "--pipeline") {
+            options.pipelined = true;
+        } else if (arg == "--binary") {
+            options.binary = true;
+        } else if (arg == "--journal" && i + 1 < argc) {
+            options.journalPath = argv[++i];
+        } else if (arg == "--fsync" && i + 1 < argc) {
+            options.fsyncPolicy = FsyncPolicyEnum::FromString(argv[++i]);
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            options.snapshotPath = argv[++i];
+        } else if (arg == "--recover") {
+            options.recover = true;
+        } else if (arg == "--market-data" && i + 1 < argc) {
+            options.marketDataName = argv[++i];
+        } else if (arg.substr(0, 1) != "-" && options.path == nullptr) {
+            options.path = argv[i];
+        } else {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // the journal and snapshots follow the serial engine's sequence numbers,
+    // and only it publishes market data
+    auto recoverable = options.journalPath != nullptr || options.snapshotPath != nullptr;
+    auto serialOnly = recoverable || options.marketDataName != nullptr;
+    if ((options.pipelined && options.numShards > 0) || options.fsyncPolicy == FsyncPolicyEnum::Unknown ||
+        (serialOnly && (options.pipelined || options.numShards > 0)) || (options.recover && !recoverable)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    auto fd = STDIN_FILENO;
+    if (options.path != nullptr) {
+        fd = open(options.path, O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Cannot open " << options.path << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+
+    SymbolRegistry symbols;
+    OutputWriter writer(STDOUT_FILENO);
+
+    auto journalFd = -1;
+    std::optional<Journal> journal;
+    if (options.journalPath != nullptr) {
+        journalFd = open(options.journalPath, O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (journalFd < 0) {
+            std::cerr << "Cannot open " << options.journalPath << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+
+        JournalConfig config;
+        config.fsyncPolicy = options.fsyncPolicy;
+        journal.emplace(journalFd, symbols, config);
+    }
+    auto *journalPtr = journal ? &*journal : nullptr;
+
+    // left in place when the engine exits, so readers can finish with it
+    std::optional<MarketDataWriter> marketData;
+    if (options.marketDataName != nullptr) {
+        auto marketDataFd = OpenSharedMemory(options.marketDataName, true);
+        if (marketDataFd >= 0) {
+            marketData.emplace(marketDataFd);
+            close(marketDataFd);
         }
-    }};
+        if (!marketData || !marketData->IsMapped()) {
+            std::cerr << "Cannot set up market data ring " << options.marketDataName << ": " << std::strerror(errno)
+                      << std::endl;
+            return 1;
+        }
+    }
+    auto *marketDataPtr = marketData ? &*marketData : nullptr;
 
     std::cerr << "====== Match Engine =====" << std::endl;
-    std::cerr << "Enter 'exit' to quit" << std::endl;
 
-    std::string line;
-    while (getline(std::cin, line) && line != "exit") {
-        /* std::cout << "Received: '" << line << "'" << std::endl; */
+    std::chrono::steady_clock::duration elapsed{};
+    auto ok = true;
+
+    // either way a file (or stdin redirected from one) is mapped, a pipe is streamed
+    if (options.binary) {
+        FrameReader reader(fd);
+        BinaryParser parser(symbols);
+        if (journal) {
+            reader.SetIdleHandler([&] { return CommitJournalWhileIdle(*journal); });
+        }
+
+        ok = RunEngine(options, symbols, writer, journalPtr, marketDataPtr, elapsed,
+                       [&](auto &&fn) { ForEachBinaryMessage(reader, parser, fn); });
+        PrintInputStats(reader, "messages", reader.Frames(), elapsed);
+    } else {
+        std::cerr << "Enter 'exit' to quit" << std::endl;
 
-        auto fields = ParseLine(line);
-        auto newOrder = ConstructNewOrderFromFields(fields);
-        engine.OnMessage(newOrder);
+        LineReader reader(fd);
+        TextParser parser(symbols);
+        if (journal) {
+            reader.SetIdleHandler([&] { return CommitJournalWhileIdle(*journal); });
+        }
+
+        ok = RunEngine(options, symbols, writer, journalPtr, marketDataPtr, elapsed,
+                       [&](auto &&fn) { ForEachTextMessage(reader, parser, fn); });
+        PrintInputStats(reader, "lines", reader.Lines(), elapsed);
+    }
+
+    if (fd != STDIN_FILENO) {
+        close(fd);
     }
 
-    std::cout << '\n';
-    auto orders = engine.Dump();
-    for (auto const &order : orders) {
-        std::cout << order << '\n';
+    if (journal) {
+        auto committed = journal->Commit();
+        PrintJournalStats(*journal);
+        journal.reset();
+        close(journalFd);
+
+        if (!committed) {
+            std::cerr << "Cannot write journal " << options.journalPath << std::endl;
+            return 1;
+        }
     }
 
-    return 0;
+    return ok ? 0 : 1;
 }
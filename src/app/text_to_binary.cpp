@@ -0,0 +1,94 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+
+#include "binary_parser.h"
+#include "line_reader.h"
+#include "output_writer.h"
+#include "symbol_registry.h"
+#include "text_parser.h"
+
+using namespace gemini;
+
+// converts text input to binary input for matching_engine --binary
+//
+// Lines are parsed exactly as matching_engine parses them, skipped lines are
+// left out and conversion stops at an exit line, so replaying the binary
+// output gives the same results as the text it came from.
+int main(int argc, char *argv[]) {
+    if (argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " [input-file [output-file]]" << std::endl;
+        return 1;
+    }
+
+    auto in = STDIN_FILENO;
+    if (argc > 1) {
+        in = open(argv[1], O_RDONLY);
+        if (in < 0) {
+            std::cerr << "Cannot open " << argv[1] << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+
+    auto out = STDOUT_FILENO;
+    if (argc > 2) {
+        out = open(argv[2], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            std::cerr << "Cannot create " << argv[2] << ": " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+
+    SymbolRegistry symbols;
+    LineReader reader(in);
+    TextParser parser(symbols);
+    BinaryEncoder encoder(symbols);
+
+    unsigned long messages = 0;
+    unsigned long skipped = 0;
+    {
+        OutputWriter writer(out);
+
+        reader.ForEachLine([&](std::string_view line) {
+            if (line == "exit") {
+                return false;
+            }
+
+            switch (parser.Parse(line)) {
+                case ParseStatusEnum::Ok: {
+                    auto encoded = encoder.Encode(parser.Message());
+                    if (encoded.empty()) {
+                        std::cerr << "Cannot encode, skipping: " << line << std::endl;
+                        skipped++;
+                        break;
+                    }
+                    writer.Append(encoded);
+                    messages++;
+                    break;
+                }
+                case ParseStatusEnum::Blank:
+                    break;
+                default:
+                    skipped++;
+                    break;
+            }
+            return true;
+        });
+    }
+
+    std::cerr << "Converted " << messages << " messages from " << reader.Lines() << " lines, skipped " << skipped
+              << std::endl;
+
+    if (in != STDIN_FILENO) {
+        close(in);
+    }
+    if (out != STDOUT_FILENO) {
+        close(out);
+    }
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+#ifndef MATCHING_ENGINE__BENCH_H
+#define MATCHING_ENGINE__BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace gemini {
+namespace bench {
+
+using Clock = std::chrono::steady_clock;
+
+inline unsigned long ElapsedNanos(Clock::time_point start, Clock::time_point end) {
+    return static_cast<unsigned long>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+}
+
+// keeps the compiler from optimising away a result that is otherwise unused
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// collects per-operation latencies and prints their distribution
+class LatencyRecorder {
+   public:
+    explicit LatencyRecorder(std::size_t expectedSamples) { m_samples.reserve(expectedSamples); }
+
+    void Record(unsigned long nanos) { m_samples.push_back(nanos); }
+
+    void Report(const std::string &name) {
+        if (m_samples.empty()) {
+            return;
+        }
+
+        std::sort(m_samples.begin(), m_samples.end());
+
+        unsigned long total = 0;
+        for (auto sample : m_samples) {
+            total += sample;
+        }
+
+        std::printf("%-40s n=%-9zu mean=%-7lu p50=%-7lu p90=%-7lu p99=%-7lu p99.9=%-7lu (ns)\n", name.c_str(),
+                    m_samples.size(), total / m_samples.size(), Percentile(0.50), Percentile(0.90), Percentile(0.99),
+                    Percentile(0.999));
+        m_samples.clear();
+    }
+
+   private:
+    unsigned long Percentile(double fraction) const {
+        auto index = static_cast<std::size_t>(fraction * static_cast<double>(m_samples.size() - 1));
+        return m_samples[index];
+    }
+
+    std::vector<unsigned long> m_samples;
+};
+
+// prints the rate of a batch of operations timed as a whole
+inline void ReportThroughput(const std::string &name, unsigned long operations, unsigned long nanos) {
+    auto ops = static_cast<double>(operations);
+    auto seconds = static_cast<double>(nanos) / 1e9;
+    std::printf("%-40s n=%-9lu %.2f Mops/s %.1f ns/op\n", name.c_str(), operations, ops / seconds / 1e6,
+                static_cast<double>(nanos) / ops);
+}
+
+}  // namespace bench
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__BENCH_H
@@ -0,0 +1,117 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "legacy_order_book.h"
+#include "order_book.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kOrders = 1000000;
+constexpr unsigned long kBasePrice = 10000;
+constexpr unsigned long kPriceLevels = 200;
+
+// prices are drawn this many ticks either side of the middle of the ladder so
+// roughly half the orders cross and the rest build depth near the touch
+constexpr unsigned long kSpread = 10;
+
+std::vector<NewOrder> GenerateOrders() {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<unsigned long> side(0, 1);
+    std::uniform_int_distribution<unsigned long> quantity(1, 100);
+    std::uniform_int_distribution<unsigned long> price(kBasePrice + kPriceLevels / 2 - kSpread,
+                                                       kBasePrice + kPriceLevels / 2 + kSpread);
+
+    std::vector<NewOrder> orders;
+    orders.reserve(kOrders);
+
+    for (unsigned long i = 0; i < kOrders; ++i) {
+        NewOrder newOrder;
+
+        newOrder.orderId = OrderId(std::to_string(i));
+        newOrder.symbol = 0;
+        newOrder.side = side(random) == 0 ? SideEnum::Buy : SideEnum::Sell;
+        newOrder.quantity = quantity(random);
+        newOrder.price = price(random);
+
+        orders.push_back(newOrder);
+    }
+
+    return orders;
+}
+
+void BenchLegacy(const std::vector<NewOrder> &orders) {
+    unsigned long trades = 0;
+    legacy::OrderBook orderBook("BTCUSD", [&trades](const legacy::Trade &) { trades++; });
+
+    LatencyRecorder recorder(orders.size());
+    unsigned long total = 0;
+
+    unsigned long sequenceNumber = 0;
+    for (auto const &newOrder : orders) {
+        // the legacy book takes its strings by value, build them outside the timed region
+        legacy::Order order{++sequenceNumber, std::string(newOrder.orderId.View()), "BTCUSD",
+                            newOrder.side,    newOrder.price,
+                            newOrder.quantity};
+
+        auto start = Clock::now();
+        orderBook.AddOrder(std::move(order));
+        auto end = Clock::now();
+
+        recorder.Record(ElapsedNanos(start, end));
+        total += ElapsedNanos(start, end);
+    }
+
+    DoNotOptimize(trades);
+    recorder.Report("add legacy");
+    ReportThroughput("add legacy", orders.size(), total);
+}
+
+void BenchBook(BookTypeEnum::Type bookType, const std::vector<NewOrder> &orders) {
+    OrderBookConfig config;
+    config.bookType = bookType;
+    config.basePrice = kBasePrice;
+    config.numLevels = kPriceLevels;
+    config.pool.initialCapacity = orders.size();
+
+    unsigned long trades = 0;
+    auto onTrades = [&trades](TradeSpan batch) { trades += batch.Size(); };
+    BasicOrderBook<decltype(onTrades)> orderBook(0, config, onTrades);
+
+    LatencyRecorder recorder(orders.size());
+    unsigned long total = 0;
+
+    unsigned long sequenceNumber = 0;
+    for (auto const &newOrder : orders) {
+        Order order(++sequenceNumber, newOrder);
+
+        auto start = Clock::now();
+        orderBook.AddOrder(std::move(order));
+        auto end = Clock::now();
+
+        recorder.Record(ElapsedNanos(start, end));
+        total += ElapsedNanos(start, end);
+    }
+
+    DoNotOptimize(trades);
+    auto name = std::string("add ") + BookTypeEnum::ToString(bookType);
+    recorder.Report(name);
+    ReportThroughput(name, orders.size(), total);
+}
+
+}  // namespace
+
+int main() {
+    auto orders = GenerateOrders();
+
+    BenchLegacy(orders);
+    for (auto bookType : {BookTypeEnum::Map, BookTypeEnum::Ladder}) {
+        BenchBook(bookType, orders);
+    }
+
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "book_builder.h"
+#include "matching_engine.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kMessages = 2000000;
+constexpr unsigned long kSymbols = 4;
+constexpr unsigned long kBasePrice = 10000;
+constexpr unsigned long kPriceLevels = 200;
+
+// as bench_book, orders around the middle of the ladder so about half cross
+constexpr unsigned long kSpread = 10;
+
+// the rate the builder is expected to keep up with
+constexpr double kTargetEventsPerSecond = 10e6;
+
+struct NoOutput {
+    template <typename Message>
+    void operator()(const Message &) const noexcept {}
+};
+
+// takes order updates, so the books make them, but does nothing with them
+struct DiscardOrderUpdates {
+    void operator()(const LevelUpdate &) const noexcept {}
+    void operator()(const OrderUpdate &) const noexcept {}
+};
+
+struct RecordOrderUpdates {
+    std::vector<OrderUpdate> *updates;
+
+    void operator()(const LevelUpdate &) const noexcept {}
+    void operator()(const OrderUpdate &update) const { updates->push_back(update); }
+};
+
+struct Message {
+    NewOrder newOrder;
+    CancelOrder cancelOrder;
+    ReplaceOrder replaceOrder;
+    MessageTypeEnum::Type messageType;
+};
+
+// new orders with a cancel or replace of a recent order now and then, so
+// every kind of order update turns up
+std::vector<Message> GenerateMessages(const std::vector<SymbolId> &ids) {
+    std::mt19937 random(25);
+    std::uniform_int_distribution<unsigned long> quantity(1, 100);
+    std::uniform_int_distribution<unsigned long> offset(0, 2 * kSpread);
+
+    std::vector<Message> messages(kMessages);
+    for (unsigned long i = 0; i < kMessages; ++i) {
+        auto &msg = messages[i];
+        auto symbol = ids[random() % ids.size()];
+        auto recent = OrderId(std::to_string(i - random() % (i + 1 < 1000 ? i + 1 : 1000)));
+        auto price = kBasePrice + kPriceLevels / 2 - kSpread + offset(random);
+
+        switch (random() % 10) {
+            case 0:
+                msg.messageType = MessageTypeEnum::CancelOrder;
+                msg.cancelOrder.orderId = recent;
+                msg.cancelOrder.symbol = symbol;
+                break;
+            case 1:
+                msg.messageType = MessageTypeEnum::ReplaceOrder;
+                msg.replaceOrder.orderId = recent;
+                msg.replaceOrder.symbol = symbol;
+                msg.replaceOrder.quantity = quantity(random);
+                msg.replaceOrder.price = price;
+                break;
+            default:
+                msg.messageType = MessageTypeEnum::NewOrder;
+                msg.newOrder.orderId = OrderId(std::to_string(i));
+                msg.newOrder.symbol = symbol;
+                msg.newOrder.side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+                msg.newOrder.quantity = quantity(random);
+                msg.newOrder.price = price;
+                break;
+        }
+    }
+    return messages;
+}
+
+template <typename Engine>
+void Configure(Engine &engine, const std::vector<SymbolId> &ids) {
+    OrderBookConfig config;
+    config.bookType = BookTypeEnum::Ladder;
+    config.basePrice = kBasePrice;
+    config.numLevels = kPriceLevels;
+    config.pool.initialCapacity = kMessages / ids.size();
+
+    for (auto symbol : ids) {
+        engine.ConfigureSymbol(symbol, config);
+    }
+}
+
+template <typename Engine>
+unsigned long Run(Engine &engine, const std::vector<Message> &messages) {
+    auto start = Clock::now();
+    for (auto const &msg : messages) {
+        switch (msg.messageType) {
+            case MessageTypeEnum::NewOrder:
+                engine.OnMessage(msg.newOrder);
+                break;
+            case MessageTypeEnum::CancelOrder:
+                engine.OnMessage(msg.cancelOrder);
+                break;
+            default:
+                engine.OnMessage(msg.replaceOrder);
+                break;
+        }
+    }
+    return ElapsedNanos(start, Clock::now());
+}
+
+// what making the updates costs the matching thread
+template <typename MarketDataSink>
+void BenchEngine(const char *name, const SymbolRegistry &symbols, const std::vector<SymbolId> &ids,
+                 const std::vector<Message> &messages) {
+    BasicMatchingEngine<NoOutput, MarketDataSink> engine(symbols, NoOutput{});
+    Configure(engine, ids);
+    ReportThroughput(name, messages.size(), Run(engine, messages));
+}
+
+void ReportRate(const char *name, unsigned long events, unsigned long nanos) {
+    ReportThroughput(name, events, nanos);
+    auto rate = static_cast<double>(events) * 1e9 / static_cast<double>(nanos);
+    std::printf("  %s the target of %.0f M events/s\n", rate >= kTargetEventsPerSecond ? "meets" : "misses",
+                kTargetEventsPerSecond / 1e6);
+}
+
+}  // namespace
+
+int main() {
+    SymbolRegistry symbols;
+    std::vector<SymbolId> ids;
+    for (unsigned long i = 0; i < kSymbols; ++i) {
+        ids.push_back(symbols.Intern("SYM" + std::to_string(i)));
+    }
+    auto messages = GenerateMessages(ids);
+
+    BenchEngine<NoLevelUpdates>("engine, no order updates", symbols, ids, messages);
+    BenchEngine<DiscardOrderUpdates>("engine, order updates", symbols, ids, messages);
+
+    // the feed, kept as the engine sent it and as it would come off the ring
+    std::vector<OrderUpdate> updates;
+    updates.reserve(kMessages * 3);
+    BasicMatchingEngine<NoOutput, RecordOrderUpdates> engine(symbols, NoOutput{}, RecordOrderUpdates{&updates});
+    Configure(engine, ids);
+    Run(engine, messages);
+
+    std::vector<wire::OrderUpdate> encoded;
+    encoded.reserve(updates.size());
+    for (auto const &update : updates) {
+        encoded.push_back(ToWire(update));
+    }
+
+    unsigned long refused = 0;
+    {
+        BookBuilder builder(kMessages / 8);
+        auto start = Clock::now();
+        for (auto const &update : updates) {
+            if (!builder.Apply(update)) {
+                refused++;
+            }
+        }
+        ReportRate("apply", updates.size(), ElapsedNanos(start, Clock::now()));
+
+        if (builder.Dump(symbols) != engine.Dump()) {
+            std::fprintf(stderr, "rebuilt books do not match the engine\n");
+            return 1;
+        }
+    }
+    {
+        BookBuilder builder(kMessages / 8);
+        auto start = Clock::now();
+        for (auto const &msg : encoded) {
+            OrderUpdate update;
+            if (!FromWire(msg, update) || !builder.Apply(update)) {
+                refused++;
+            }
+        }
+        ReportRate("decode and apply", encoded.size(), ElapsedNanos(start, Clock::now()));
+    }
+
+    if (refused != 0) {
+        std::fprintf(stderr, "%lu updates refused\n", refused);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "order_book.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kIterations = 200000;
+constexpr unsigned long kPriceLevels = 100;
+constexpr unsigned long kBasePrice = 10000;
+
+NewOrder ConstructNewOrder(unsigned long id, unsigned long price) {
+    NewOrder newOrder;
+
+    newOrder.orderId = OrderId(std::to_string(id));
+    newOrder.symbol = 0;
+    newOrder.side = SideEnum::Buy;
+    newOrder.quantity = 10;
+    newOrder.price = price;
+
+    return newOrder;
+}
+
+// cancels a random resting order out of a book of the given depth, then puts
+// it back at the end of its level so the depth stays constant
+void BenchCancel(BookTypeEnum::Type bookType, unsigned long depth) {
+    OrderBookConfig config;
+    config.bookType = bookType;
+    config.basePrice = kBasePrice;
+    config.numLevels = kPriceLevels;
+    config.pool.initialCapacity = depth + 1;
+
+    OrderBook orderBook(0, config, [](TradeSpan) {});
+
+    std::vector<NewOrder> orders;
+    orders.reserve(depth);
+
+    unsigned long sequenceNumber = 0;
+    for (unsigned long i = 0; i < depth; ++i) {
+        orders.push_back(ConstructNewOrder(i, kBasePrice + i % kPriceLevels));
+        orderBook.AddOrder(Order(++sequenceNumber, orders.back()));
+    }
+
+    std::mt19937 random(depth);
+    LatencyRecorder recorder(kIterations);
+
+    for (unsigned long i = 0; i < kIterations; ++i) {
+        auto const &newOrder = orders[random() % depth];
+
+        auto start = Clock::now();
+        auto cancelled = orderBook.CancelOrder(newOrder.orderId);
+        auto end = Clock::now();
+
+        DoNotOptimize(cancelled);
+        recorder.Record(ElapsedNanos(start, end));
+
+        orderBook.AddOrder(Order(++sequenceNumber, newOrder));
+    }
+
+    recorder.Report(std::string("cancel ") + BookTypeEnum::ToString(bookType) + " depth=" + std::to_string(depth));
+}
+
+}  // namespace
+
+int main() {
+    for (auto bookType : {BookTypeEnum::Map, BookTypeEnum::Ladder}) {
+        for (unsigned long depth : {10ul, 100ul, 1000ul, 10000ul, 100000ul}) {
+            BenchCancel(bookType, depth);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "bench.h"
+#include "binary_parser.h"
+#include "frame_reader.h"
+#include "line_reader.h"
+#include "symbol_registry.h"
+#include "text_parser.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kMessages = 2000000;
+constexpr unsigned long kSymbols = 100;
+constexpr unsigned long kBasePrice = 10000;
+
+// a mix of new orders, cancels and replaces like a day's capture
+std::string GenerateText() {
+    std::mt19937 random(42);
+    std::string text;
+
+    for (unsigned long i = 0; i < kMessages; ++i) {
+        auto symbol = "SYM" + std::to_string(random() % kSymbols);
+        auto action = random() % 10;
+
+        if (action == 0) {
+            text += std::to_string(random() % (i + 1)) + " CANCEL " + symbol;
+        } else if (action == 1) {
+            text += std::to_string(random() % (i + 1)) + " REPLACE " + symbol + ' ' +
+                    std::to_string(1 + random() % 100) + ' ' + std::to_string(kBasePrice + random() % 200);
+        } else {
+            text += std::to_string(i) + (random() % 2 == 0 ? " BUY " : " SELL ") + symbol + ' ' +
+                    std::to_string(1 + random() % 100) + ' ' + std::to_string(kBasePrice + random() % 200);
+        }
+        text += '\n';
+    }
+
+    return text;
+}
+
+std::string Encode(const std::string &text) {
+    SymbolRegistry symbols;
+    TextParser parser(symbols);
+    BinaryEncoder encoder(symbols);
+
+    std::string bytes;
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        auto end = text.find('\n', begin);
+        if (parser.Parse(std::string_view(text).substr(begin, end - begin)) == ParseStatusEnum::Ok) {
+            bytes.append(encoder.Encode(parser.Message()));
+        }
+        begin = end + 1;
+    }
+
+    return bytes;
+}
+
+// a temporary file holding the bytes, so the readers map it as they would a capture
+std::FILE *WriteTemporary(const std::string &bytes) {
+    auto *file = std::tmpfile();
+    if (file == nullptr || std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size()) {
+        std::perror("tmpfile");
+        return nullptr;
+    }
+    std::fflush(file);
+    return file;
+}
+
+// reading, splitting and parsing every message, as matching_engine does before matching
+void BenchText(std::FILE *file) {
+    SymbolRegistry symbols;
+    LineReader reader(fileno(file));
+    TextParser parser(symbols);
+
+    unsigned long messages = 0;
+    auto start = Clock::now();
+    reader.ForEachLine([&](std::string_view line) {
+        if (parser.Parse(line) == ParseStatusEnum::Ok) {
+            DoNotOptimize(parser.Message());
+            messages++;
+        }
+        return true;
+    });
+    auto end = Clock::now();
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "decode text (%.1f MB)", static_cast<double>(reader.Bytes()) / 1e6);
+    ReportThroughput(name, messages, ElapsedNanos(start, end));
+}
+
+void BenchBinary(std::FILE *file) {
+    SymbolRegistry symbols;
+    FrameReader reader(fileno(file));
+    BinaryParser parser(symbols);
+
+    unsigned long messages = 0;
+    auto start = Clock::now();
+    reader.ForEachFrame([&](const wire::Header &frame) {
+        if (parser.Parse(frame) == ParseStatusEnum::Ok) {
+            DoNotOptimize(parser.Message());
+            messages++;
+        }
+        return true;
+    });
+    auto end = Clock::now();
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "decode binary (%.1f MB)", static_cast<double>(reader.Bytes()) / 1e6);
+    ReportThroughput(name, messages, ElapsedNanos(start, end));
+}
+
+}  // namespace
+
+int main() {
+    auto text = GenerateText();
+    auto bytes = Encode(text);
+
+    auto *textFile = WriteTemporary(text);
+    auto *binaryFile = WriteTemporary(bytes);
+    if (textFile == nullptr || binaryFile == nullptr) {
+        return 1;
+    }
+
+    // twice each, the first pass also faults the pages in
+    for (int pass = 0; pass < 2; ++pass) {
+        BenchText(textFile);
+        BenchBinary(binaryFile);
+    }
+
+    std::fclose(textFile);
+    std::fclose(binaryFile);
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "order_book.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kBasePrice = 10000;
+constexpr unsigned long kOrdersPerLevel = 2;
+
+// fewer queries on deeper books, so the scans take about as long on each
+constexpr unsigned long kQueries = 1000000;
+constexpr unsigned long kScannedLevels = 50000000;
+
+// the books are only ever asks, so nothing trades
+struct NoTrades {
+    void operator()(TradeSpan) const noexcept {}
+};
+
+using Book = BasicOrderBook<NoTrades>;
+
+struct Query {
+    unsigned long price;
+    unsigned long quantity;
+};
+
+NewOrder MakeOrder(unsigned long id, unsigned long quantity, unsigned long price) {
+    NewOrder newOrder;
+
+    newOrder.orderId = OrderId(std::to_string(id));
+    newOrder.symbol = 0;
+    newOrder.side = SideEnum::Sell;
+    newOrder.quantity = quantity;
+    newOrder.price = price;
+
+    return newOrder;
+}
+
+// asks on every level of the ladder
+void Populate(Book &book, unsigned long numLevels) {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<unsigned long> quantity(1, 100);
+
+    unsigned long sequenceNumber = 0;
+    for (unsigned long level = 0; level < numLevels; ++level) {
+        for (unsigned long i = 0; i < kOrdersPerLevel; ++i) {
+            ++sequenceNumber;
+            book.AddOrder(Order(sequenceNumber, MakeOrder(sequenceNumber, quantity(random), kBasePrice + level)));
+        }
+    }
+}
+
+// what a caller had to do before: every level from the best price, one at a time
+unsigned long ScanQuantityThrough(const Book &book, unsigned long numLevels, unsigned long price) {
+    unsigned long total = 0;
+    for (auto level = kBasePrice; level <= price && level < kBasePrice + numLevels; ++level) {
+        total += book.Level(SideEnum::Sell, level).quantity;
+    }
+    return total;
+}
+
+std::optional<unsigned long> ScanPriceToFill(const Book &book, unsigned long numLevels, unsigned long quantity) {
+    unsigned long total = 0;
+    for (auto level = kBasePrice; level < kBasePrice + numLevels; ++level) {
+        total += book.Level(SideEnum::Sell, level).quantity;
+        if (total >= quantity) {
+            return level;
+        }
+    }
+    return std::nullopt;
+}
+
+// times fn(query) over the queries, returning a checksum of the answers so the
+// methods can be compared
+template <typename Fn>
+unsigned long Time(const std::string &name, const std::vector<Query> &queries, unsigned long numQueries, Fn &&fn) {
+    unsigned long checksum = 0;
+
+    auto start = Clock::now();
+    for (unsigned long i = 0; i < numQueries; ++i) {
+        checksum += fn(queries[i]);
+    }
+    auto end = Clock::now();
+
+    DoNotOptimize(checksum);
+    ReportThroughput(name, numQueries, ElapsedNanos(start, end));
+    return checksum;
+}
+
+void BenchDepth(unsigned long numLevels) {
+    OrderBookConfig config;
+    config.basePrice = kBasePrice;
+    config.numLevels = numLevels;
+    config.pool.initialCapacity = numLevels * kOrdersPerLevel;
+
+    config.bookType = BookTypeEnum::Ladder;
+    Book ladder(0, config, NoTrades{});
+    Populate(ladder, numLevels);
+
+    config.bookType = BookTypeEnum::Map;
+    Book map(0, config, NoTrades{});
+    Populate(map, numLevels);
+
+    auto total = ladder.QuantityThrough(SideEnum::Sell, kBasePrice + numLevels);
+
+    std::mt19937 random(11);
+    std::uniform_int_distribution<unsigned long> price(kBasePrice, kBasePrice + numLevels - 1);
+    std::uniform_int_distribution<unsigned long> quantity(1, total);
+    std::vector<Query> queries(kQueries);
+    for (auto &query : queries) {
+        query = Query{price(random), quantity(random)};
+    }
+
+    auto scanned = std::min(kQueries, std::max(1000ul, kScannedLevels / numLevels));
+    auto levels = std::to_string(numLevels) + " levels ";
+
+    auto quantityThrough = [](const Book &book) {
+        return [&book](const Query &query) { return book.QuantityThrough(SideEnum::Sell, query.price); };
+    };
+    auto priceToFill = [](const Book &book) {
+        return [&book](const Query &query) { return book.PriceToFill(SideEnum::Sell, query.quantity).value_or(0); };
+    };
+
+    auto expected = Time(levels + "quantity through, ladder scan", queries, scanned, [&](const Query &query) {
+        return ScanQuantityThrough(ladder, numLevels, query.price);
+    });
+    auto fromMap = Time(levels + "quantity through, map", queries, scanned, quantityThrough(map));
+    auto fromLadder = Time(levels + "quantity through, ladder", queries, scanned, quantityThrough(ladder));
+    if (fromMap != expected || fromLadder != expected) {
+        std::fprintf(stderr, "quantity through differs from the scan\n");
+    }
+
+    expected = Time(levels + "price to fill, ladder scan", queries, scanned, [&](const Query &query) {
+        return ScanPriceToFill(ladder, numLevels, query.quantity).value_or(0);
+    });
+    fromMap = Time(levels + "price to fill, map", queries, scanned, priceToFill(map));
+    fromLadder = Time(levels + "price to fill, ladder", queries, scanned, priceToFill(ladder));
+    if (fromMap != expected || fromLadder != expected) {
+        std::fprintf(stderr, "price to fill differs from the scan\n");
+    }
+}
+
+}  // namespace
+
+int main() {
+    for (auto numLevels : {100ul, 1000ul, 10000ul, 100000ul}) {
+        BenchDepth(numLevels);
+    }
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "journal.h"
+#include "matching_engine.h"
+#include "symbol_registry.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kOrders = 1000000;
+
+// syncing every message is orders of magnitude slower, a sample is enough
+constexpr unsigned long kAlwaysOrders = 20000;
+
+constexpr unsigned long kBasePrice = 10000;
+constexpr unsigned long kSpread = 10;
+
+std::vector<NewOrder> GenerateOrders(SymbolRegistry &symbols) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<unsigned long> side(0, 1);
+    std::uniform_int_distribution<unsigned long> quantity(1, 100);
+    std::uniform_int_distribution<unsigned long> price(kBasePrice - kSpread, kBasePrice + kSpread);
+
+    auto symbol = symbols.Intern("BTCUSD");
+
+    std::vector<NewOrder> orders;
+    orders.reserve(kOrders);
+
+    for (unsigned long i = 0; i < kOrders; ++i) {
+        NewOrder newOrder;
+
+        newOrder.orderId = OrderId(std::to_string(i));
+        newOrder.symbol = symbol;
+        newOrder.side = side(random) == 0 ? SideEnum::Buy : SideEnum::Sell;
+        newOrder.quantity = quantity(random);
+        newOrder.price = price(random);
+
+        orders.push_back(newOrder);
+    }
+
+    return orders;
+}
+
+struct CountingSink {
+    unsigned long *messages;
+
+    void operator()(TradeSpan trades) const { *messages += trades.Size(); }
+    void operator()(const CancelAck &) const { *messages += 1; }
+    void operator()(const ReplaceAck &) const { *messages += 1; }
+    void operator()(const Reject &) const { *messages += 1; }
+};
+
+// times each order through the engine, journalled to a new file in the
+// directory unless the policy is Unknown, then the whole run including the
+// final commit
+void BenchJournal(const SymbolRegistry &symbols, const std::vector<NewOrder> &orders, const std::string &directory,
+                  FsyncPolicyEnum::Type fsyncPolicy) {
+    auto numOrders = fsyncPolicy == FsyncPolicyEnum::Always ? kAlwaysOrders : orders.size();
+
+    auto path = directory + "/bench_journal.XXXXXX";
+    auto fd = mkstemp(path.data());
+    if (fd < 0) {
+        std::perror(path.c_str());
+        std::exit(1);
+    }
+    unlink(path.c_str());
+
+    JournalConfig config;
+    config.fsyncPolicy = fsyncPolicy;
+    Journal journal(fd, symbols, config);
+
+    unsigned long messages = 0;
+    BasicMatchingEngine<CountingSink> engine(symbols, CountingSink{&messages});
+    if (fsyncPolicy != FsyncPolicyEnum::Unknown) {
+        engine.AttachJournal(&journal);
+    }
+
+    LatencyRecorder recorder(numOrders);
+
+    auto begin = Clock::now();
+    for (unsigned long i = 0; i < numOrders; ++i) {
+        auto start = Clock::now();
+        engine.OnMessage(orders[i]);
+        auto end = Clock::now();
+
+        recorder.Record(ElapsedNanos(start, end));
+    }
+    if (fsyncPolicy != FsyncPolicyEnum::Unknown) {
+        journal.Commit();
+    }
+    auto end = Clock::now();
+
+    DoNotOptimize(messages);
+    if (journal.Failed()) {
+        std::fprintf(stderr, "journal failed\n");
+    }
+
+    auto name = std::string("journal ") +
+                (fsyncPolicy == FsyncPolicyEnum::Unknown ? "OFF" : FsyncPolicyEnum::ToString(fsyncPolicy));
+    recorder.Report(name);
+    ReportThroughput(name, numOrders, ElapsedNanos(begin, end));
+    if (fsyncPolicy != FsyncPolicyEnum::Unknown) {
+        std::printf("%-40s %lu bytes, %lu syncs\n", name.c_str(), journal.BytesWritten(), journal.Syncs());
+    }
+
+    close(fd);
+}
+
+}  // namespace
+
+// journals to the directory named on the command line, or the current one;
+// a tmpfs makes every sync free, so point it at a real disk
+int main(int argc, char *argv[]) {
+    std::string directory = argc > 1 ? argv[1] : ".";
+
+    SymbolRegistry symbols;
+    auto orders = GenerateOrders(symbols);
+
+    for (auto fsyncPolicy : {FsyncPolicyEnum::Unknown, FsyncPolicyEnum::Never, FsyncPolicyEnum::Deferred,
+                             FsyncPolicyEnum::Batched, FsyncPolicyEnum::Always}) {
+        BenchJournal(symbols, orders, directory, fsyncPolicy);
+    }
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cpu_affinity.h"
+#include "market_data_ring.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kMessages = 200000;
+
+// the writer waits this long between messages, about the rate a busy symbol
+// trades at, so the latency measured is that of a reader keeping up
+constexpr unsigned long kIntervalNanos = 1000;
+
+void Pin(unsigned cpu) {
+    if (!PinCurrentThread(cpu)) {
+        std::fprintf(stderr, "could not pin thread to cpu %u\n", cpu);
+    }
+}
+
+// publish to read latency seen by each of a number of readers, each reading
+// through a mapping of its own as a separate process would; the writer stamps
+// the time it published at into each trade's price
+void BenchFanOut(unsigned numReaders) {
+    auto *file = std::tmpfile();
+    if (file == nullptr) {
+        std::perror("tmpfile");
+        return;
+    }
+
+    MarketDataWriter writer(fileno(file));
+    if (!writer.IsMapped()) {
+        std::fprintf(stderr, "could not map the ring\n");
+        std::fclose(file);
+        return;
+    }
+
+    auto start = Clock::now();
+    std::atomic<bool> stop{false};
+    std::atomic<unsigned> ready{0};
+    std::vector<std::vector<unsigned long>> latencies(numReaders);
+    std::vector<unsigned long> missed(numReaders);
+    std::vector<unsigned long> lapped(numReaders);
+
+    std::vector<std::thread> readers;
+    for (unsigned reader = 0; reader < numReaders; ++reader) {
+        readers.emplace_back([&, reader] {
+            Pin(reader + 1);
+
+            MarketDataReader ring(fileno(file));
+            auto &samples = latencies[reader];
+            samples.reserve(kMessages);
+            ready.fetch_add(1);
+
+            while (true) {
+                // stop is only acted on once everything published before it has been read
+                auto stopping = stop.load(std::memory_order_acquire);
+                auto status = ring.Read();
+                if (status == RingReadStatusEnum::Ok) {
+                    auto const &trade = reinterpret_cast<const wire::Trade &>(ring.Message());
+                    samples.push_back(ElapsedNanos(start, Clock::now()) - trade.price);
+                } else if (status == RingReadStatusEnum::Lapped) {
+                    lapped[reader]++;
+                } else if (stopping) {
+                    break;
+                } else {
+                    CpuRelax();
+                }
+            }
+            missed[reader] = ring.Missed();
+        });
+    }
+
+    while (ready.load() < numReaders) {
+        std::this_thread::yield();
+    }
+
+    Pin(0);
+    Trade trade;
+    trade.symbol = 0;
+    trade.orderId = OrderId("aggressor");
+    trade.contraOrderId = OrderId("resting");
+    trade.quantity = 1;
+    auto msg = ToWire(trade);
+
+    auto publishStart = Clock::now();
+    for (unsigned long i = 0; i < kMessages; ++i) {
+        auto now = Clock::now();
+        msg.price = ElapsedNanos(start, now);
+        writer.Publish(msg.header);
+
+        while (ElapsedNanos(now, Clock::now()) < kIntervalNanos) {
+            CpuRelax();
+        }
+    }
+    auto elapsed = ElapsedNanos(publishStart, Clock::now());
+
+    stop.store(true, std::memory_order_release);
+    for (auto &reader : readers) {
+        reader.join();
+    }
+
+    LatencyRecorder recorder(kMessages * numReaders);
+    unsigned long totalMissed = 0;
+    unsigned long totalLapped = 0;
+    for (unsigned reader = 0; reader < numReaders; ++reader) {
+        for (auto nanos : latencies[reader]) {
+            recorder.Record(nanos);
+        }
+        totalMissed += missed[reader];
+        totalLapped += lapped[reader];
+    }
+
+    auto name = "fan out, " + std::to_string(numReaders) + " readers";
+    recorder.Report(name);
+    ReportThroughput(name, kMessages, elapsed);
+    std::printf("  lapped %lu times, missed %lu of %lu messages\n", totalLapped, totalMissed,
+                kMessages * numReaders);
+
+    std::fclose(file);
+}
+
+// what publishing costs the writer with nobody reading
+void BenchPublish() {
+    auto *file = std::tmpfile();
+    if (file == nullptr) {
+        std::perror("tmpfile");
+        return;
+    }
+
+    MarketDataWriter writer(fileno(file));
+    Trade trade;
+    trade.orderId = OrderId("aggressor");
+    trade.contraOrderId = OrderId("resting");
+    trade.quantity = 1;
+    auto msg = ToWire(trade);
+
+    // a number of laps, so every slot has been touched before it is timed
+    constexpr unsigned long kPublishes = 10000000;
+    auto start = Clock::now();
+    for (unsigned long i = 0; i < kPublishes; ++i) {
+        msg.price = i;
+        writer.Publish(msg.header);
+    }
+    ReportThroughput("publish", kPublishes, ElapsedNanos(start, Clock::now()));
+
+    std::fclose(file);
+}
+
+}  // namespace
+
+int main() {
+    BenchPublish();
+
+    for (auto numReaders : {1u, 4u, 16u}) {
+        BenchFanOut(numReaders);
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "order_book.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kSamples = 200000;
+constexpr unsigned long kBasePrice = 10000;
+constexpr unsigned long kPriceLevels = 200;
+
+// asks rest on this many levels from kBestAsk up, each with the same orders
+constexpr unsigned long kBestAsk = kBasePrice + kPriceLevels / 2;
+constexpr unsigned long kAskLevels = 20;
+constexpr unsigned long kOrdersPerLevel = 5;
+constexpr unsigned long kOrderQuantity = 10;
+
+struct Case {
+    const char *name;
+    OrderTypeEnum::Type orderType;
+    TimeInForceEnum::Type timeInForce;
+    unsigned long quantity;
+    unsigned long price;
+};
+
+// buys, each taking whole resting orders so the book can be put back exactly
+const Case kCases[] = {
+    {"LIMIT GTC", OrderTypeEnum::Limit, TimeInForceEnum::GoodTillCancel, 120, kBestAsk + 2},
+    {"MARKET", OrderTypeEnum::Market, TimeInForceEnum::GoodTillCancel, 120, 0},
+    {"LIMIT IOC", OrderTypeEnum::Limit, TimeInForceEnum::ImmediateOrCancel, 150, kBestAsk + 1},
+    {"LIMIT FOK filled", OrderTypeEnum::Limit, TimeInForceEnum::FillOrKill, 120, kBestAsk + 2},
+    {"LIMIT FOK killed", OrderTypeEnum::Limit, TimeInForceEnum::FillOrKill, 1000, kBestAsk + 2},
+    {"MARKET FOK killed", OrderTypeEnum::Market, TimeInForceEnum::FillOrKill, 1000000, 0},
+};
+
+NewOrder MakeOrder(unsigned long id, SideEnum::Type side, unsigned long quantity, unsigned long price) {
+    NewOrder newOrder;
+
+    newOrder.orderId = OrderId(std::to_string(id));
+    newOrder.symbol = 0;
+    newOrder.side = side;
+    newOrder.quantity = quantity;
+    newOrder.price = price;
+
+    return newOrder;
+}
+
+// times one kind of buy order against the same book every time, the orders it
+// takes are entered again afterwards outside the timed region
+void BenchOrderType(BookTypeEnum::Type bookType, const Case &testCase) {
+    OrderBookConfig config;
+    config.bookType = bookType;
+    config.basePrice = kBasePrice;
+    config.numLevels = kPriceLevels;
+    config.pool.initialCapacity = kAskLevels * kOrdersPerLevel * 2;
+
+    // what was taken from the book by the order being timed
+    std::vector<std::pair<unsigned long, unsigned long>> taken;
+    auto onTrades = [&taken](TradeSpan trades) {
+        for (auto const &trade : trades) {
+            taken.emplace_back(trade.price, trade.quantity);
+        }
+    };
+    BasicOrderBook<decltype(onTrades)> orderBook(0, config, onTrades);
+
+    unsigned long sequenceNumber = 0;
+    unsigned long orderId = 0;
+    for (unsigned long level = 0; level < kAskLevels; ++level) {
+        for (unsigned long i = 0; i < kOrdersPerLevel; ++i) {
+            orderBook.AddOrder(
+                Order(++sequenceNumber, MakeOrder(++orderId, SideEnum::Sell, kOrderQuantity, kBestAsk + level)));
+        }
+    }
+
+    unsigned long unfilled = 0;
+    auto onUnfilled = [&unfilled](const Order &order) { unfilled += order.Quantity(); };
+
+    LatencyRecorder recorder(kSamples);
+    unsigned long total = 0;
+
+    for (unsigned long i = 0; i < kSamples; ++i) {
+        Order order(++sequenceNumber, MakeOrder(++orderId, SideEnum::Buy, testCase.quantity, testCase.price));
+
+        auto start = Clock::now();
+        orderBook.AddOrder(std::move(order), testCase.orderType, testCase.timeInForce, onUnfilled);
+        auto end = Clock::now();
+
+        recorder.Record(ElapsedNanos(start, end));
+        total += ElapsedNanos(start, end);
+
+        for (auto const &[price, quantity] : taken) {
+            orderBook.AddOrder(Order(++sequenceNumber, MakeOrder(++orderId, SideEnum::Sell, quantity, price)));
+        }
+        taken.clear();
+    }
+
+    DoNotOptimize(unfilled);
+    auto name = std::string(BookTypeEnum::ToString(bookType)) + ' ' + testCase.name;
+    recorder.Report(name);
+    ReportThroughput(name, kSamples, total);
+}
+
+}  // namespace
+
+int main() {
+    for (auto bookType : {BookTypeEnum::Map, BookTypeEnum::Ladder}) {
+        for (auto const &testCase : kCases) {
+            BenchOrderType(bookType, testCase);
+        }
+    }
+
+    return 0;
+}
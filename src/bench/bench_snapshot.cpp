@@ -0,0 +1,141 @@
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "matching_engine.h"
+#include "snapshot.h"
+#include "symbol_registry.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kBasePrice = 10000;
+constexpr unsigned long kDepth = 100;
+
+struct NullSink {
+    void operator()(TradeSpan) const {}
+    void operator()(const CancelAck &) const {}
+    void operator()(const ReplaceAck &) const {}
+    void operator()(const Reject &) const {}
+};
+
+using Engine = BasicMatchingEngine<NullSink>;
+
+// a day of orders that never cross, each side kept at restingOrders / 2 by
+// cancelling its oldest order once it is full
+std::vector<std::unique_ptr<MessageHeader>> GenerateHistory(SymbolRegistry &symbols, unsigned long numMessages,
+                                                            unsigned long restingOrders) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<unsigned long> quantity(1, 100);
+    std::uniform_int_distribution<unsigned long> level(1, kDepth);
+
+    std::vector<std::unique_ptr<MessageHeader>> history;
+    history.reserve(numMessages);
+
+    // oldest first, on each side
+    std::deque<std::pair<OrderId, SymbolId>> resting[2];
+    for (unsigned long i = 0; history.size() < numMessages; ++i) {
+        auto side = i % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+        auto symbol = symbols.Intern(i % 4 < 2 ? "BTCUSD" : "ETHUSD");
+        auto &queue = resting[i % 2];
+
+        if (queue.size() == restingOrders / 2) {
+            auto cancelOrder = std::make_unique<CancelOrder>();
+            cancelOrder->orderId = queue.front().first;
+            cancelOrder->symbol = queue.front().second;
+            queue.pop_front();
+            history.push_back(std::move(cancelOrder));
+            continue;
+        }
+
+        auto newOrder = std::make_unique<NewOrder>();
+        newOrder->orderId = OrderId(std::to_string(i));
+        newOrder->symbol = symbol;
+        newOrder->side = side;
+        newOrder->quantity = quantity(random);
+        newOrder->price = side == SideEnum::Buy ? kBasePrice - level(random) : kBasePrice + level(random);
+
+        queue.emplace_back(newOrder->orderId, symbol);
+        history.push_back(std::move(newOrder));
+    }
+
+    return history;
+}
+
+double Millis(unsigned long nanos) { return static_cast<double>(nanos) / 1e6; }
+
+// rebuilds the same books by replaying the history and by loading a snapshot
+// of them, the former grows with the history and the latter with the book
+void BenchRestart(unsigned long numMessages, unsigned long restingOrders) {
+    SymbolRegistry symbols;
+    auto history = GenerateHistory(symbols, numMessages, restingOrders);
+
+    Engine engine(symbols, NullSink{});
+
+    auto start = Clock::now();
+    for (auto const &msg : history) {
+        engine.OnMessage(*msg);
+    }
+    auto replayed = Clock::now();
+
+    auto *file = std::tmpfile();
+    if (file == nullptr) {
+        std::perror("tmpfile");
+        std::exit(1);
+    }
+
+    SnapshotWriter writer(fileno(file), symbols);
+    if (!engine.WriteSnapshot(writer)) {
+        std::fprintf(stderr, "could not write snapshot\n");
+        std::exit(1);
+    }
+    auto written = Clock::now();
+    auto snapshotBytes = lseek(fileno(file), 0, SEEK_END);
+
+    lseek(fileno(file), 0, SEEK_SET);
+    auto loadStart = Clock::now();
+    SnapshotReader reader(fileno(file), symbols);
+    Engine restored(symbols, NullSink{});
+    if (!restored.LoadSnapshot(reader)) {
+        std::fprintf(stderr, "could not load snapshot\n");
+        std::exit(1);
+    }
+    auto loaded = Clock::now();
+
+    std::fclose(file);
+
+    std::printf(
+        "history %-9lu resting %-8lu replay %8.1f ms   snapshot %6.1f MB written %6.1f ms loaded %6.1f ms (%.1f ns "
+        "per order)\n",
+        numMessages, restingOrders, Millis(ElapsedNanos(start, replayed)), static_cast<double>(snapshotBytes) / 1e6,
+        Millis(ElapsedNanos(replayed, written)), Millis(ElapsedNanos(loadStart, loaded)),
+        static_cast<double>(ElapsedNanos(loadStart, loaded)) / static_cast<double>(restingOrders));
+
+    if (restored.SequenceNumber() != engine.SequenceNumber()) {
+        std::fprintf(stderr, "restored engine is at sequence number %lu, expected %lu\n", restored.SequenceNumber(),
+                     engine.SequenceNumber());
+    }
+}
+
+}  // namespace
+
+int main() {
+    for (auto numMessages : {1000000ul, 4000000ul, 16000000ul}) {
+        BenchRestart(numMessages, 100000);
+    }
+    for (auto restingOrders : {10000ul, 1000000ul}) {
+        BenchRestart(4000000, restingOrders);
+    }
+
+    return 0;
+}
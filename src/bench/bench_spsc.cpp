@@ -0,0 +1,159 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "bench.h"
+#include "cpu_affinity.h"
+#include "spsc_queue.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kRecords = 10000000;
+constexpr unsigned long kRoundTrips = 100000;
+constexpr std::size_t kCapacity = 4096;
+constexpr std::size_t kBatch = 64;
+
+// the size of a typical inbound or outbound message
+struct Record {
+    unsigned long sequenceNumber;
+    unsigned long payload[7];
+};
+
+static_assert(sizeof(Record) == 64, "one record per cache line");
+
+template <typename WaitStrategy>
+const char *NameOf();
+
+template <>
+const char *NameOf<BusyPollWait>() {
+    return "busy-poll";
+}
+
+template <>
+const char *NameOf<FutexWait>() {
+    return "futex";
+}
+
+// pins the producer and the consumer to different cpus where there are enough
+void Pin(unsigned cpu) {
+    if (!PinCurrentThread(cpu)) {
+        std::fprintf(stderr, "could not pin thread to cpu %u\n", cpu);
+    }
+}
+
+// streams records from one thread to the other as fast as they can be taken,
+// pushing and popping either one at a time or in batches
+template <typename WaitStrategy>
+void BenchThroughput(bool batched) {
+    SpscQueue<Record, WaitStrategy> queue(kCapacity);
+    unsigned long outOfOrder = 0;
+
+    auto start = Clock::now();
+
+    std::thread consumer([&] {
+        Pin(1);
+
+        unsigned long received = 0;
+        auto check = [&](const Record &record) {
+            if (record.sequenceNumber != received) {
+                outOfOrder++;
+            }
+            received++;
+        };
+
+        Record record;
+        while (received < kRecords) {
+            if (batched) {
+                queue.WaitForRecords();
+                queue.PopBatch(check, kBatch);
+            } else {
+                queue.Pop(record);
+                check(record);
+            }
+        }
+    });
+
+    Pin(0);
+
+    Record record{};
+    for (unsigned long i = 0; i < kRecords; ++i) {
+        record.sequenceNumber = i;
+        if (batched) {
+            queue.Stage(record);
+            if ((i + 1) % kBatch == 0) {
+                queue.Publish();
+            }
+        } else {
+            queue.Push(record);
+        }
+    }
+    queue.Publish();
+
+    consumer.join();
+    auto end = Clock::now();
+
+    ReportThroughput(std::string("spsc ") + NameOf<WaitStrategy>() + (batched ? " batched" : " single"), kRecords,
+                     ElapsedNanos(start, end));
+    if (outOfOrder != 0) {
+        std::fprintf(stderr, "%lu records out of order\n", outOfOrder);
+    }
+}
+
+// bounces one record between two threads through a pair of queues and times
+// each round trip
+template <typename WaitStrategy>
+void BenchRoundTrip() {
+    SpscQueue<Record, WaitStrategy> ping(kCapacity);
+    SpscQueue<Record, WaitStrategy> pong(kCapacity);
+
+    std::thread echo([&] {
+        Pin(1);
+
+        Record record;
+        for (unsigned long i = 0; i < kRoundTrips; ++i) {
+            ping.Pop(record);
+            pong.Push(record);
+        }
+    });
+
+    Pin(0);
+
+    LatencyRecorder recorder(kRoundTrips);
+
+    Record record{};
+    for (unsigned long i = 0; i < kRoundTrips; ++i) {
+        record.sequenceNumber = i;
+
+        auto start = Clock::now();
+        ping.Push(record);
+        pong.Pop(record);
+        auto end = Clock::now();
+
+        recorder.Record(ElapsedNanos(start, end));
+    }
+
+    echo.join();
+
+    recorder.Report(std::string("spsc ") + NameOf<WaitStrategy>() + " round trip");
+}
+
+}  // namespace
+
+int main() {
+    if (AvailableCpus() < 2) {
+        std::fprintf(stderr, "only one cpu available, both threads will share it\n");
+    }
+
+    for (bool batched : {false, true}) {
+        BenchThroughput<BusyPollWait>(batched);
+        BenchThroughput<FutexWait>(batched);
+    }
+
+    BenchRoundTrip<BusyPollWait>();
+    BenchRoundTrip<FutexWait>();
+
+    return 0;
+}
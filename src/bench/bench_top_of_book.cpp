@@ -0,0 +1,126 @@
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "cpu_affinity.h"
+#include "order_book.h"
+
+using namespace gemini;
+using namespace gemini::bench;
+
+namespace {
+
+constexpr unsigned long kOrders = 1000000;
+constexpr unsigned long kBasePrice = 10000;
+constexpr unsigned long kPriceLevels = 200;
+
+// orders land this far either side of the middle of the ladder, so they often
+// cross and the top of book changes all the time
+constexpr unsigned long kSpread = 10;
+
+struct NoTrades {
+    void operator()(TradeSpan) const noexcept {}
+};
+
+void Pin(unsigned cpu) {
+    if (!PinCurrentThread(cpu)) {
+        std::fprintf(stderr, "could not pin thread to cpu %u\n", cpu);
+    }
+}
+
+std::vector<NewOrder> GenerateOrders() {
+    std::mt19937 random(5);
+    std::uniform_int_distribution<unsigned long> quantity(1, 100);
+    std::uniform_int_distribution<unsigned long> offset(0, 2 * kSpread);
+
+    std::vector<NewOrder> orders(kOrders);
+    for (unsigned long i = 0; i < kOrders; ++i) {
+        auto &newOrder = orders[i];
+        newOrder.orderId = OrderId(std::to_string(i));
+        newOrder.symbol = 0;
+        newOrder.side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+        newOrder.quantity = quantity(random);
+        newOrder.price = kBasePrice + kPriceLevels / 2 - kSpread + offset(random);
+    }
+    return orders;
+}
+
+// add order latency on the matching thread while readers on other cpus poll
+// its top of book as fast as they can
+void BenchReaders(const std::vector<NewOrder> &orders, unsigned numReaders) {
+    OrderBookConfig config;
+    config.bookType = BookTypeEnum::Ladder;
+    config.basePrice = kBasePrice;
+    config.numLevels = kPriceLevels;
+    config.pool.initialCapacity = kOrders;
+
+    BasicOrderBook<NoTrades> orderBook(0, config, NoTrades{});
+
+    std::atomic<bool> stop{false};
+    std::vector<unsigned long> reads(numReaders);
+    std::vector<unsigned long> versionsSeen(numReaders);
+    std::vector<std::thread> readers;
+    for (unsigned reader = 0; reader < numReaders; ++reader) {
+        readers.emplace_back([&, reader] {
+            Pin(reader + 1);
+
+            unsigned long count = 0;
+            unsigned long lastVersion = 0;
+            unsigned long changes = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto top = orderBook.Top().Read();
+                if (top.version != lastVersion) {
+                    lastVersion = top.version;
+                    changes++;
+                }
+                count++;
+            }
+
+            reads[reader] = count;
+            versionsSeen[reader] = changes;
+        });
+    }
+
+    Pin(0);
+    LatencyRecorder recorder(kOrders);
+
+    auto start = Clock::now();
+    for (unsigned long i = 0; i < kOrders; ++i) {
+        auto before = Clock::now();
+        orderBook.AddOrder(Order(i + 1, orders[i]));
+        recorder.Record(ElapsedNanos(before, Clock::now()));
+    }
+    auto elapsed = ElapsedNanos(start, Clock::now());
+
+    stop.store(true, std::memory_order_relaxed);
+    for (auto &reader : readers) {
+        reader.join();
+    }
+
+    auto name = "add, " + std::to_string(numReaders) + " readers";
+    recorder.Report(name);
+    ReportThroughput(name, kOrders, elapsed);
+
+    auto published = orderBook.Top().Read().version;
+    for (unsigned reader = 0; reader < numReaders; ++reader) {
+        std::printf("  reader %u: %.1f M reads/s, saw %lu of %lu versions\n", reader,
+                    static_cast<double>(reads[reader]) * 1e3 / static_cast<double>(elapsed), versionsSeen[reader],
+                    published);
+    }
+}
+
+}  // namespace
+
+int main() {
+    auto orders = GenerateOrders();
+
+    for (auto numReaders : {0u, 1u, 4u}) {
+        BenchReaders(orders, numReaders);
+    }
+
+    return 0;
+}
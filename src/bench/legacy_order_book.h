@@ -0,0 +1,153 @@
+#ifndef MATCHING_ENGINE__LEGACY_ORDER_BOOK_H
+#define MATCHING_ENGINE__LEGACY_ORDER_BOOK_H
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "fields.h"
+
+namespace gemini {
+namespace bench {
+namespace legacy {
+
+// The original order book, kept only as a baseline for the benchmarks: orders
+// are owned by a std::multimap keyed on a price level whose ordering branches
+// on the side at runtime, ids and symbols are strings and trades are collected
+// into a fresh vector before being handed to a std::function.
+
+struct PriceLevel {
+    unsigned long price;
+    SideEnum::Type side;
+};
+
+inline bool operator<(const PriceLevel &lhs, const PriceLevel &rhs) noexcept {
+    assert(lhs.side == rhs.side);
+    if (lhs.side == SideEnum::Buy) {
+        return lhs.price > rhs.price;
+    } else {
+        return lhs.price < rhs.price;
+    }
+}
+
+struct Order {
+    unsigned long sequenceNumber;
+    std::string orderId;
+    std::string symbol;
+    SideEnum::Type side;
+    unsigned long price;
+    unsigned long quantity;
+};
+
+struct Trade {
+    std::string symbol;
+    std::string orderId;
+    std::string contraOrderId;
+    unsigned long quantity;
+    unsigned long price;
+};
+
+class OrderBook {
+   public:
+    using OrderMatchedFn = std::function<void(const Trade &)>;
+
+    OrderBook(std::string symbol, OrderMatchedFn fn) : m_symbol(std::move(symbol)), m_orderMatched(std::move(fn)) {}
+
+    void AddOrder(Order order) {
+        auto trades = GenerateTrades(order);
+
+        for (auto &trade : trades) {
+            m_orderMatched(trade);
+        }
+
+        if (order.quantity > 0) {
+            auto indexes = GetIndexesForSide(order.side);
+
+            PriceLevel priceLevel{order.price, order.side};
+            auto sequenceNumber = order.sequenceNumber;
+            auto it = indexes.byPriceLevel.insert(std::make_pair(priceLevel, std::move(order)));
+
+            indexes.bySequenceNumber.insert(std::make_pair(sequenceNumber, it));
+        }
+    }
+
+   private:
+    using PriceLevelIndex = std::multimap<PriceLevel, Order>;
+    using OrderIterator = PriceLevelIndex::iterator;
+
+    using SequenceNumberIndex = std::map<unsigned long, OrderIterator>;
+
+    struct Indexes {
+        PriceLevelIndex &byPriceLevel;
+        SequenceNumberIndex &bySequenceNumber;
+    };
+
+    Indexes GetIndexesForSide(SideEnum::Type side) noexcept {
+        if (side == SideEnum::Buy) {
+            return {m_bids, m_bidsBySequenceNumber};
+        }
+        return {m_asks, m_asksBySequenceNumber};
+    }
+
+    static bool OrdersMatch(const Order &inboundOrder, const Order &restingOrder) {
+        if (inboundOrder.side == SideEnum::Buy) {
+            return restingOrder.price <= inboundOrder.price;
+        } else {
+            return inboundOrder.price <= restingOrder.price;
+        }
+    }
+
+    std::vector<Trade> GenerateTrades(Order &inboundOrder) {
+        std::vector<Trade> trades;
+        std::vector<OrderIterator> filledRestingOrders;
+
+        auto contraSideIndexes = GetIndexesForSide(SideEnum::ContraSide(inboundOrder.side));
+
+        auto it = contraSideIndexes.byPriceLevel.begin();
+        while (it != contraSideIndexes.byPriceLevel.end() && OrdersMatch(inboundOrder, it->second)) {
+            auto tradeQuantity = std::min(inboundOrder.quantity, it->second.quantity);
+
+            trades.push_back(
+                Trade{m_symbol, inboundOrder.orderId, it->second.orderId, tradeQuantity, it->second.price});
+
+            inboundOrder.quantity -= tradeQuantity;
+            it->second.quantity -= tradeQuantity;
+
+            if (it->second.quantity == 0) {
+                filledRestingOrders.push_back(it);
+            }
+
+            if (inboundOrder.quantity == 0) {
+                break;
+            }
+
+            ++it;
+        }
+
+        for (auto filledOrderIt : filledRestingOrders) {
+            contraSideIndexes.bySequenceNumber.erase(filledOrderIt->second.sequenceNumber);
+            contraSideIndexes.byPriceLevel.erase(filledOrderIt);
+        }
+
+        return trades;
+    }
+
+    std::string m_symbol;
+
+    OrderMatchedFn m_orderMatched;
+
+    PriceLevelIndex m_bids;
+    PriceLevelIndex m_asks;
+
+    SequenceNumberIndex m_bidsBySequenceNumber;
+    SequenceNumberIndex m_asksBySequenceNumber;
+};
+
+}  // namespace legacy
+}  // namespace bench
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__LEGACY_ORDER_BOOK_H
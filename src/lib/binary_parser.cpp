@@ -0,0 +1,208 @@
+#include "binary_parser.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+
+namespace gemini {
+
+BinaryParser::BinaryParser(SymbolRegistry &symbols) : m_symbols(symbols), m_message(nullptr), m_sequenceNumber(0) {}
+
+ParseStatusEnum::Type BinaryParser::Parse(const wire::Header &frame) {
+    switch (frame.messageType) {
+        case MessageTypeEnum::SymbolDefinition:
+            return ParseSymbolDefinition(frame);
+        case MessageTypeEnum::JournalEntry:
+            return ParseJournalEntry(frame);
+        default:
+            m_sequenceNumber = 0;
+            return ParseInbound(frame);
+    }
+}
+
+const MessageHeader &BinaryParser::Message() const noexcept {
+    assert(m_message != nullptr);
+    return *m_message;
+}
+
+unsigned long BinaryParser::SequenceNumber() const noexcept { return m_sequenceNumber; }
+
+bool BinaryParser::FindSymbol(std::uint32_t symbol, SymbolId &result) const noexcept {
+    if (symbol >= m_symbolIds.size()) {
+        return false;
+    }
+    result = m_symbolIds[symbol];
+    return true;
+}
+
+ParseStatusEnum::Type BinaryParser::ParseInbound(const wire::Header &frame) {
+    switch (frame.messageType) {
+        case MessageTypeEnum::NewOrder:
+            return ParseMessage<wire::NewOrder>(frame, m_newOrder);
+        case MessageTypeEnum::CancelOrder:
+            return ParseMessage<wire::CancelOrder>(frame, m_cancelOrder);
+        case MessageTypeEnum::ReplaceOrder:
+            return ParseMessage<wire::ReplaceOrder>(frame, m_replaceOrder);
+        default:
+            return ParseStatusEnum::Malformed;
+    }
+}
+
+ParseStatusEnum::Type BinaryParser::ParseJournalEntry(const wire::Header &frame) {
+    if (frame.length < sizeof(wire::JournalEntry) + sizeof(wire::Header)) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    auto const &entry = *reinterpret_cast<const wire::JournalEntry *>(&frame);
+    auto const &inner = *reinterpret_cast<const wire::Header *>(&entry + 1);
+    if (inner.length != frame.length - sizeof(entry) || entry.sequenceNumber == 0) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    auto status = ParseInbound(inner);
+    m_sequenceNumber = status == ParseStatusEnum::Ok ? entry.sequenceNumber : 0;
+    return status;
+}
+
+ParseStatusEnum::Type BinaryParser::ParseSymbolDefinition(const wire::Header &frame) {
+    if (frame.length < sizeof(wire::SymbolDefinition)) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    // the header is the first member of the message, so shares its address
+    auto const &definition = *reinterpret_cast<const wire::SymbolDefinition *>(&frame);
+    if (frame.length != wire::SymbolDefinitionSize(definition.nameLength)) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    // ids are handed out in order, which also bounds how far the table can
+    // grow for each definition
+    if (definition.symbol > m_symbolIds.size()) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    auto *name = reinterpret_cast<const char *>(&definition + 1);
+    auto id = m_symbols.Intern(std::string_view(name, definition.nameLength));
+
+    if (definition.symbol == m_symbolIds.size()) {
+        m_symbolIds.push_back(id);
+    } else {
+        m_symbolIds[definition.symbol] = id;
+    }
+    return ParseStatusEnum::Definition;
+}
+
+template <typename Wire, typename Inbound>
+ParseStatusEnum::Type BinaryParser::ParseMessage(const wire::Header &frame, Inbound &message) {
+    if (frame.length != sizeof(Wire)) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    auto const &msg = *reinterpret_cast<const Wire *>(&frame);
+    if (msg.symbol >= m_symbolIds.size() || !FromWire(msg, message)) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    message.symbol = m_symbolIds[msg.symbol];
+    m_message = &message;
+    return ParseStatusEnum::Ok;
+}
+
+BinaryEncoder::BinaryEncoder(const SymbolRegistry &symbols) : m_symbols(symbols), m_defined(0) {}
+
+std::string_view BinaryEncoder::Encode(const MessageHeader &msg) {
+    m_buffer.clear();
+
+    if (!Define(msg)) {
+        return {};
+    }
+    AppendMessage(msg);
+    return m_buffer;
+}
+
+std::string_view BinaryEncoder::Encode(const MessageHeader &msg, unsigned long sequenceNumber) {
+    m_buffer.clear();
+
+    if (!Define(msg)) {
+        return {};
+    }
+
+    wire::JournalEntry entry{};
+    entry.header.messageType = MessageTypeEnum::JournalEntry;
+    entry.sequenceNumber = sequenceNumber;
+
+    auto offset = m_buffer.size();
+    Append(entry);
+    AppendMessage(msg);
+
+    // the length is only known once the message is in
+    auto length = static_cast<std::uint16_t>(m_buffer.size() - offset);
+    std::memcpy(&m_buffer[offset + offsetof(wire::Header, length)], &length, sizeof(length));
+    return m_buffer;
+}
+
+bool BinaryEncoder::EncodeDefinitions(SymbolId symbol, std::string_view &result) {
+    m_buffer.clear();
+
+    if (!Define(symbol)) {
+        return false;
+    }
+    result = m_buffer;
+    return true;
+}
+
+bool BinaryEncoder::Define(const MessageHeader &msg) {
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            return Define(static_cast<const NewOrder &>(msg).symbol);
+        case MessageTypeEnum::CancelOrder:
+            return Define(static_cast<const CancelOrder &>(msg).symbol);
+        case MessageTypeEnum::ReplaceOrder:
+            return Define(static_cast<const ReplaceOrder &>(msg).symbol);
+        default:
+            return false;
+    }
+}
+
+bool BinaryEncoder::Define(SymbolId symbol) {
+    // define every id up to this one, so the stream's ids stay in order
+    for (; m_defined <= symbol; ++m_defined) {
+        auto const &name = m_symbols.Name(m_defined);
+        if (name.size() > wire::MaxSymbolNameLength) {
+            m_buffer.clear();
+            return false;
+        }
+
+        wire::SymbolDefinition definition{};
+        definition.header.messageType = MessageTypeEnum::SymbolDefinition;
+        definition.header.length = static_cast<std::uint16_t>(wire::SymbolDefinitionSize(name.size()));
+        definition.symbol = m_defined;
+        definition.nameLength = static_cast<std::uint32_t>(name.size());
+
+        Append(definition);
+        m_buffer.append(name);
+        m_buffer.append(definition.header.length - sizeof(definition) - name.size(), '\0');
+    }
+    return true;
+}
+
+void BinaryEncoder::AppendMessage(const MessageHeader &msg) {
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            Append(ToWire(static_cast<const NewOrder &>(msg)));
+            break;
+        case MessageTypeEnum::CancelOrder:
+            Append(ToWire(static_cast<const CancelOrder &>(msg)));
+            break;
+        default:
+            Append(ToWire(static_cast<const ReplaceOrder &>(msg)));
+            break;
+    }
+}
+
+template <typename Wire>
+void BinaryEncoder::Append(const Wire &msg) {
+    m_buffer.append(reinterpret_cast<const char *>(&msg), sizeof(msg));
+}
+
+}  // namespace gemini
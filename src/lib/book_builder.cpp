@@ -0,0 +1,179 @@
+#include "book_builder.h"
+
+#include <algorithm>
+
+namespace gemini {
+
+namespace {
+std::size_t CapacityFor(std::size_t expectedOrders) {
+    std::size_t capacity = 16;
+    while (capacity < expectedOrders * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// everything but the quantity, which is what updates change
+bool Matches(const Order &order, const OrderUpdate &update) noexcept {
+    return order.Symbol() == update.symbol && order.OrderId() == update.orderId && order.Side() == update.side &&
+           order.Price() == update.price;
+}
+
+// asks come first in a dump, then each side in sequence number order
+bool DumpsBefore(const Order *lhs, const Order *rhs) noexcept {
+    if (lhs->Side() != rhs->Side()) {
+        return lhs->Side() == SideEnum::Sell;
+    }
+    return lhs->SequenceNumber() < rhs->SequenceNumber();
+}
+}  // namespace
+
+BookBuilder::BookBuilder(std::size_t expectedOrders) : m_mask(0), m_size(0) {
+    Rehash(CapacityFor(expectedOrders));
+}
+
+bool BookBuilder::Apply(const OrderUpdate &update) {
+    if (update.updateType == OrderUpdateTypeEnum::Add) {
+        if (update.sequenceNumber == 0 || update.quantity == 0) {
+            return false;
+        }
+        if ((m_size + 1) * 2 > m_slots.size()) {
+            Rehash(m_slots.size() * 2);
+        }
+
+        auto &slot = m_slots[FindSlot(update.sequenceNumber)];
+        if (slot) {
+            return false;
+        }
+
+        NewOrder newOrder;
+        newOrder.orderId = update.orderId;
+        newOrder.symbol = update.symbol;
+        newOrder.side = update.side;
+        newOrder.quantity = update.quantity;
+        newOrder.price = update.price;
+
+        slot.emplace(update.sequenceNumber, newOrder);
+        m_size++;
+        return true;
+    }
+
+    auto index = FindSlot(update.sequenceNumber);
+    auto &slot = m_slots[index];
+    if (!slot || !Matches(*slot, update)) {
+        return false;
+    }
+
+    auto remaining = slot->Quantity();
+    switch (update.updateType) {
+        case OrderUpdateTypeEnum::Fill:
+            if (update.quantity == 0 || update.quantity > remaining) {
+                return false;
+            }
+            break;
+        case OrderUpdateTypeEnum::Reduce:
+            if (update.quantity == 0 || update.quantity >= remaining) {
+                return false;
+            }
+            break;
+        case OrderUpdateTypeEnum::Delete:
+            if (update.quantity != remaining) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    if (update.quantity == remaining) {
+        Erase(index);
+    } else {
+        slot->DecreaseQuantity(update.quantity);
+    }
+    return true;
+}
+
+std::size_t BookBuilder::NumOrders() const noexcept { return m_size; }
+
+const Order *BookBuilder::FindOrder(unsigned long sequenceNumber) const noexcept {
+    auto const &slot = m_slots[FindSlot(sequenceNumber)];
+    return slot ? &*slot : nullptr;
+}
+
+std::vector<std::string> BookBuilder::Dump(SymbolId symbol, const std::string &symbolName) const {
+    std::vector<std::string> result;
+
+    ForEachOrder(symbol, [&](const Order &order) { result.push_back(order.ToString(symbolName)); });
+
+    return result;
+}
+
+std::vector<std::string> BookBuilder::Dump(const SymbolRegistry &symbols) const {
+    std::vector<SymbolId> ids;
+    for (auto const &slot : m_slots) {
+        if (slot) {
+            ids.push_back(slot->Symbol());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::sort(ids.begin(), ids.end(),
+              [&](SymbolId lhs, SymbolId rhs) { return symbols.Name(lhs) < symbols.Name(rhs); });
+
+    std::vector<std::string> result;
+    for (auto symbol : ids) {
+        auto lines = Dump(symbol, symbols.Name(symbol));
+        result.insert(result.end(), lines.begin(), lines.end());
+    }
+    return result;
+}
+
+std::size_t BookBuilder::HomeSlot(unsigned long sequenceNumber) const noexcept { return sequenceNumber & m_mask; }
+
+std::size_t BookBuilder::FindSlot(unsigned long sequenceNumber) const noexcept {
+    // the table is never full, so the probe always ends
+    auto index = HomeSlot(sequenceNumber);
+    while (m_slots[index] && m_slots[index]->SequenceNumber() != sequenceNumber) {
+        index = (index + 1) & m_mask;
+    }
+    return index;
+}
+
+void BookBuilder::Erase(std::size_t hole) noexcept {
+    // shift back any entry that probed past the hole, as OrderIdIndex::Erase
+    for (auto next = (hole + 1) & m_mask; m_slots[next]; next = (next + 1) & m_mask) {
+        auto home = HomeSlot(m_slots[next]->SequenceNumber());
+        if (((next - home) & m_mask) >= ((next - hole) & m_mask)) {
+            m_slots[hole] = std::move(m_slots[next]);
+            hole = next;
+        }
+    }
+
+    m_slots[hole].reset();
+    m_size--;
+}
+
+void BookBuilder::Rehash(std::size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    std::swap(slots, m_slots);
+    m_mask = capacity - 1;
+
+    for (auto &slot : slots) {
+        if (slot) {
+            m_slots[FindSlot(slot->SequenceNumber())] = std::move(slot);
+        }
+    }
+}
+
+std::vector<const Order *> BookBuilder::SortedOrders(SymbolId symbol) const {
+    std::vector<const Order *> result;
+    for (auto const &slot : m_slots) {
+        if (slot && slot->Symbol() == symbol) {
+            result.push_back(&*slot);
+        }
+    }
+    std::sort(result.begin(), result.end(), DumpsBefore);
+    return result;
+}
+
+}  // namespace gemini
@@ -0,0 +1,58 @@
+#include "cpu_affinity.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <cstddef>
+
+namespace gemini {
+
+namespace {
+
+bool AllowedCpus(cpu_set_t &cpus) noexcept {
+    CPU_ZERO(&cpus);
+    return sched_getaffinity(0, sizeof(cpus), &cpus) == 0;
+}
+
+}  // namespace
+
+unsigned AvailableCpus() noexcept {
+    cpu_set_t cpus;
+    if (!AllowedCpus(cpus)) {
+        return 1;
+    }
+    auto count = CPU_COUNT(&cpus);
+    return count > 0 ? static_cast<unsigned>(count) : 1;
+}
+
+bool PinCurrentThread(unsigned n) noexcept {
+    cpu_set_t allowed;
+    if (!AllowedCpus(allowed)) {
+        return false;
+    }
+
+    auto count = CPU_COUNT(&allowed);
+    if (count <= 0) {
+        return false;
+    }
+    auto wanted = n % static_cast<unsigned>(count);
+
+    // find the wanted cpu among those allowed, they need not be numbered contiguously
+    for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
+        }
+        if (wanted-- != 0) {
+            continue;
+        }
+
+        cpu_set_t pinned;
+        CPU_ZERO(&pinned);
+        CPU_SET(cpu, &pinned);
+        return pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned) == 0;
+    }
+
+    return false;
+}
+
+}  // namespace gemini
@@ -0,0 +1,113 @@
+#ifndef MATCHING_ENGINE__BINARY_PARSER_H
+#define MATCHING_ENGINE__BINARY_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "messages.h"
+#include "symbol_registry.h"
+#include "text_parser.h"
+#include "wire_messages.h"
+
+namespace gemini {
+
+// Binary input is a stream of messages in their wire layouts (see
+// wire_messages.h), read with FrameReader. Symbol ids in the stream belong to
+// the stream: they are handed out from 0 in order, and each is defined by a
+// wire::SymbolDefinition before the first message using it. A journal is the
+// same with each message wrapped in a wire::JournalEntry carrying its
+// sequence number.
+
+// turns binary input into inbound messages, the counterpart of TextParser
+class BinaryParser {
+   public:
+    explicit BinaryParser(SymbolRegistry &symbols);
+
+    // the frame must be a whole message as handed out by FrameReader
+    //
+    // On ParseStatusEnum::Ok the message is available from Message() until the
+    // next call, its symbol interned in the registry. A symbol definition gives
+    // ParseStatusEnum::Definition, anything else the stream should not contain
+    // ParseStatusEnum::Malformed.
+    ParseStatusEnum::Type Parse(const wire::Header &frame);
+
+    const MessageHeader &Message() const noexcept;
+
+    // the sequence number the message was journalled with, 0 if it was not
+    unsigned long SequenceNumber() const noexcept;
+
+    // the registry id of one of the stream's symbol ids, for streams that
+    // carry other messages too; false if it has not been defined
+    bool FindSymbol(std::uint32_t symbol, SymbolId &result) const noexcept;
+
+   private:
+    ParseStatusEnum::Type ParseSymbolDefinition(const wire::Header &frame);
+    ParseStatusEnum::Type ParseJournalEntry(const wire::Header &frame);
+
+    // the inbound messages, on their own or in a journal entry
+    ParseStatusEnum::Type ParseInbound(const wire::Header &frame);
+
+    template <typename Wire, typename Inbound>
+    ParseStatusEnum::Type ParseMessage(const wire::Header &frame, Inbound &message);
+
+    SymbolRegistry &m_symbols;
+
+    // registry id of each of the stream's symbol ids
+    std::vector<SymbolId> m_symbolIds;
+
+    NewOrder m_newOrder;
+    CancelOrder m_cancelOrder;
+    ReplaceOrder m_replaceOrder;
+
+    // points at whichever of the above the last frame filled in
+    const MessageHeader *m_message;
+
+    unsigned long m_sequenceNumber;
+};
+
+// turns inbound messages into binary input, for converting text input
+class BinaryEncoder {
+   public:
+    // ids in the encoded stream are the registry's, defined as they are first used
+    explicit BinaryEncoder(const SymbolRegistry &symbols);
+
+    // the message in its wire layout, preceded by the definitions of any
+    // symbols it needs that have not been defined yet
+    //
+    // The result is valid until the next call, and empty if the message
+    // cannot be encoded (not an inbound message, or a symbol name too long).
+    std::string_view Encode(const MessageHeader &msg);
+
+    // as above wrapped in a journal entry
+    std::string_view Encode(const MessageHeader &msg, unsigned long sequenceNumber);
+
+    // just the definitions the symbol needs, for streams that carry other
+    // messages too; false if a name is too long
+    bool EncodeDefinitions(SymbolId symbol, std::string_view &result);
+
+   private:
+    // appends the definitions of the symbols the message needs, false if it
+    // cannot be encoded
+    bool Define(const MessageHeader &msg);
+    bool Define(SymbolId symbol);
+
+    // appends the message itself, which Define has accepted
+    void AppendMessage(const MessageHeader &msg);
+
+    template <typename Wire>
+    void Append(const Wire &msg);
+
+    const SymbolRegistry &m_symbols;
+
+    // symbols below this have been defined
+    SymbolId m_defined;
+
+    std::string m_buffer;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__BINARY_PARSER_H
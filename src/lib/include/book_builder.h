@@ -0,0 +1,87 @@
+#ifndef MATCHING_ENGINE__BOOK_BUILDER_H
+#define MATCHING_ENGINE__BOOK_BUILDER_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "messages.h"
+#include "order.h"
+#include "symbol_registry.h"
+
+namespace gemini {
+
+// Rebuilds the books of an engine from its order updates (see OrderUpdate),
+// as a consumer of the market data feed would, for instance after reading
+// them from a MarketDataReader.
+//
+// The resting orders of every book are kept in one open-addressing hash table
+// keyed by sequence number, laid out as OrderIdIndex is: linear probing over a
+// power of two table kept at most half full, erasing by shifting entries back.
+// Sequence numbers are handed out in order, so an order's home slot is just
+// the low bits of its sequence number: orders added around the same time sit
+// next to each other, and the part of the table the feed is busy with stays in
+// cache. Each update is one lookup, and nothing is kept in price or time
+// order, so putting the books in order is left to ForEachOrder and Dump, which
+// sort.
+//
+// Updates are checked against the book as built so far, so a builder fed
+// every update from when the books were empty ends up with exactly the orders
+// of the engine, which Dump gives in the same order and format as the
+// engine's, to be compared with it.
+class BookBuilder {
+   public:
+    // sized so expectedOrders resting orders fit without rehashing
+    explicit BookBuilder(std::size_t expectedOrders = 1024);
+
+    // returns false, leaving the books unchanged, if the update does not
+    // follow from them: an add under a sequence number that is 0 or already
+    // resting, or any other update of an order that is not resting, that does
+    // not match it (symbol, order id, side and price) or takes more than it
+    // has left; a delete must take exactly what is left
+    bool Apply(const OrderUpdate &update);
+
+    std::size_t NumOrders() const noexcept;
+
+    // the order resting under this sequence number, nullptr if there is none
+    const Order *FindOrder(unsigned long sequenceNumber) const noexcept;
+
+    // calls fn(const Order &) for each order resting on the book of a symbol,
+    // in the order BasicOrderBook::ForEachOrder visits them
+    template <typename Fn>
+    void ForEachOrder(SymbolId symbol, Fn &&fn) const;
+
+    // as BasicOrderBook::Dump for the book of one symbol
+    std::vector<std::string> Dump(SymbolId symbol, const std::string &symbolName) const;
+
+    // as BasicMatchingEngine::Dump, books in symbol name order
+    std::vector<std::string> Dump(const SymbolRegistry &symbols) const;
+
+   private:
+    // empty without an order
+    using Slot = std::optional<Order>;
+
+    std::size_t HomeSlot(unsigned long sequenceNumber) const noexcept;
+    std::size_t FindSlot(unsigned long sequenceNumber) const noexcept;
+    void Erase(std::size_t hole) noexcept;
+    void Rehash(std::size_t capacity);
+
+    // asks before bids, each side in sequence number order
+    std::vector<const Order *> SortedOrders(SymbolId symbol) const;
+
+    std::vector<Slot> m_slots;
+    std::size_t m_mask;
+    std::size_t m_size;
+};
+
+template <typename Fn>
+void BookBuilder::ForEachOrder(SymbolId symbol, Fn &&fn) const {
+    for (auto *order : SortedOrders(symbol)) {
+        fn(*order);
+    }
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__BOOK_BUILDER_H
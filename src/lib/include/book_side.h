@@ -0,0 +1,329 @@
+#ifndef MATCHING_ENGINE__BOOK_SIDE_H
+#define MATCHING_ENGINE__BOOK_SIDE_H
+
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <vector>
+
+#include "depth_index.h"
+#include "order_list.h"
+#include "price_level.h"
+#include "side_traits.h"
+
+namespace gemini {
+
+// One side (bids or asks) of an order book, kept in price-time priority.
+//
+// Both implementations are specialised on the side at compile time and expose
+// the same interface so the matching code in OrderBook can be written once:
+//
+//   CanHold(price)                - true if an order at this price can rest on this side
+//   Insert(node)                  - rests the order behind any others at the same price
+//   Best()                        - the highest priority resting order, nullptr if empty
+//   PopBest()                     - unlinks and returns the highest priority resting order
+//   Remove(node)                  - unlinks a resting order from anywhere in the side
+//   DecreaseBest(quantity)        - takes quantity from the highest priority resting order
+//   DecreaseQuantity(node, qty)   - takes quantity from a resting order, which keeps its place
+//   Totals(price), BestTotals()   - what is resting at a price, or at the best price
+//   QuantityThrough(price)        - the total quantity resting at price or better
+//   PriceToFill(quantity)         - the worst price taking quantity would trade at, if enough is resting
+//   BySequenceNumber()            - the resting orders in sequence number order
+//
+// Insert, Remove and DecreaseQuantity return the totals of the order's level
+// once it has changed, all zero if the level is left empty. Sides never own
+// the order nodes, they only link them into their lists.
+
+// sorted tree of price levels, any price can be held
+template <SideEnum::Type S>
+class MapBookSide {
+   public:
+    static constexpr SideEnum::Type Side = S;
+
+    bool CanHold(unsigned long) const noexcept { return true; }
+
+    LevelTotals Insert(OrderNode *node) {
+        auto &level = m_levels[node->order.Price()];
+        level.PushBack(node);
+        m_bySequenceNumber.PushBack(node);
+        return level.Totals();
+    }
+
+    OrderNode *Best() noexcept {
+        if (m_levels.empty()) {
+            return nullptr;
+        }
+        return m_levels.begin()->second.Front();
+    }
+
+    OrderNode *PopBest() {
+        assert(!m_levels.empty());
+
+        auto level = m_levels.begin();
+        auto *node = level->second.Front();
+        Remove(level, node);
+        return node;
+    }
+
+    LevelTotals Remove(OrderNode *node) {
+        auto it = m_levels.find(node->order.Price());
+        assert(it != m_levels.end());
+
+        return Remove(it, node);
+    }
+
+    void DecreaseBest(unsigned long quantity) noexcept {
+        assert(!m_levels.empty());
+
+        auto &level = m_levels.begin()->second;
+        level.DecreaseQuantity(level.Front(), quantity);
+    }
+
+    LevelTotals DecreaseQuantity(OrderNode *node, unsigned long quantity) {
+        auto it = m_levels.find(node->order.Price());
+        assert(it != m_levels.end());
+
+        it->second.DecreaseQuantity(node, quantity);
+        return it->second.Totals();
+    }
+
+    LevelTotals Totals(unsigned long price) const {
+        auto it = m_levels.find(price);
+        return it != m_levels.end() ? it->second.Totals() : LevelTotals{};
+    }
+
+    LevelTotals BestTotals() const noexcept {
+        assert(!m_levels.empty());
+        return m_levels.begin()->second.Totals();
+    }
+
+    // both from the level totals, so only the levels are walked and never their orders
+    unsigned long QuantityThrough(unsigned long price) const noexcept {
+        unsigned long total = 0;
+        for (auto it = m_levels.begin(); it != m_levels.end() && SideTraits<S>::IsAtOrBetter(it->first, price); ++it) {
+            total += it->second.Totals().quantity;
+        }
+        return total;
+    }
+
+    std::optional<unsigned long> PriceToFill(unsigned long quantity) const noexcept {
+        unsigned long total = 0;
+        for (auto const &[price, level] : m_levels) {
+            total += level.Totals().quantity;
+            if (total >= quantity) {
+                return price;
+            }
+        }
+        return std::nullopt;
+    }
+
+    const SequenceList &BySequenceNumber() const noexcept { return m_bySequenceNumber; }
+
+   private:
+    // primary index is by price, each level keeps its orders in time priority
+    using LevelIndex = std::map<unsigned long, PriceLevel, typename SideTraits<S>::PriceCompare>;
+    using LevelIterator = typename LevelIndex::iterator;
+
+    LevelTotals Remove(LevelIterator level, OrderNode *node) {
+        level->second.Remove(node);
+        m_bySequenceNumber.Remove(node);
+
+        if (level->second.Empty()) {
+            m_levels.erase(level);
+            return {};
+        }
+        return level->second.Totals();
+    }
+
+    LevelIndex m_levels;
+
+    // orders only ever rest in increasing sequence number order, so appending
+    // keeps this list sorted
+    SequenceList m_bySequenceNumber;
+};
+
+// dense array of price levels indexed by (price - base) / tick
+//
+// Only prices on a tick boundary inside [base, base + tick * numLevels) can be
+// held. Inserting, removing and finding the best price are O(1); removing the
+// last order at the best price scans towards the worse prices for the next
+// non-empty level, which is cheap when the book is concentrated around the touch.
+// The quantity of every level is also kept in a DepthIndex, ordered from the
+// best price down, so cumulative depth is O(log levels) however deep the book.
+template <SideEnum::Type S>
+class LadderBookSide {
+   public:
+    static constexpr SideEnum::Type Side = S;
+
+    LadderBookSide(unsigned long basePrice, unsigned long tickSize, unsigned long numLevels)
+        : m_basePrice(basePrice),
+          m_tickSize(tickSize),
+          m_levels(numLevels),
+          m_depth(numLevels),
+          m_best(0),
+          m_orderCount(0) {
+        assert(tickSize > 0);
+    }
+
+    bool CanHold(unsigned long price) const noexcept {
+        if (price < m_basePrice) {
+            return false;
+        }
+
+        auto offset = price - m_basePrice;
+        return offset % m_tickSize == 0 && offset / m_tickSize < m_levels.size();
+    }
+
+    LevelTotals Insert(OrderNode *node) {
+        assert(CanHold(node->order.Price()));
+
+        auto index = LevelIndex(node->order.Price());
+        m_levels[index].PushBack(node);
+        m_depth.Add(DepthLevel(index), node->order.Quantity());
+        m_bySequenceNumber.PushBack(node);
+
+        if (m_orderCount == 0 || IsBetter(index, m_best)) {
+            m_best = index;
+        }
+        m_orderCount++;
+
+        return m_levels[index].Totals();
+    }
+
+    OrderNode *Best() noexcept {
+        if (m_orderCount == 0) {
+            return nullptr;
+        }
+        return m_levels[m_best].Front();
+    }
+
+    OrderNode *PopBest() {
+        assert(m_orderCount > 0);
+
+        auto *node = m_levels[m_best].Front();
+        Remove(node);
+        return node;
+    }
+
+    LevelTotals Remove(OrderNode *node) {
+        auto index = LevelIndex(node->order.Price());
+        auto &level = m_levels[index];
+
+        level.Remove(node);
+        m_depth.Subtract(DepthLevel(index), node->order.Quantity());
+        m_bySequenceNumber.Remove(node);
+        m_orderCount--;
+
+        // walk towards the worse prices for the next level with orders, there is
+        // always one to find as long as any orders remain on this side
+        if (index == m_best && level.Empty() && m_orderCount > 0) {
+            do {
+                m_best = S == SideEnum::Buy ? m_best - 1 : m_best + 1;
+            } while (m_levels[m_best].Empty());
+        }
+
+        return level.Totals();
+    }
+
+    void DecreaseBest(unsigned long quantity) noexcept {
+        assert(m_orderCount > 0);
+
+        auto &level = m_levels[m_best];
+        level.DecreaseQuantity(level.Front(), quantity);
+        m_depth.Subtract(DepthLevel(m_best), quantity);
+    }
+
+    LevelTotals DecreaseQuantity(OrderNode *node, unsigned long quantity) noexcept {
+        auto index = LevelIndex(node->order.Price());
+        auto &level = m_levels[index];
+        level.DecreaseQuantity(node, quantity);
+        m_depth.Subtract(DepthLevel(index), quantity);
+        return level.Totals();
+    }
+
+    LevelTotals Totals(unsigned long price) const noexcept {
+        return CanHold(price) ? m_levels[LevelIndex(price)].Totals() : LevelTotals{};
+    }
+
+    LevelTotals BestTotals() const noexcept {
+        assert(m_orderCount > 0);
+        return m_levels[m_best].Totals();
+    }
+
+    unsigned long QuantityThrough(unsigned long price) const noexcept {
+        return m_depth.Sum(NumLevelsThrough(price));
+    }
+
+    std::optional<unsigned long> PriceToFill(unsigned long quantity) const noexcept {
+        if (m_orderCount == 0) {
+            return std::nullopt;
+        }
+        if (quantity == 0) {
+            return LevelPrice(m_best);
+        }
+
+        auto depthLevel = m_depth.FindLevel(quantity);
+        if (depthLevel == m_levels.size()) {
+            return std::nullopt;
+        }
+        return LevelPrice(DepthLevel(depthLevel));
+    }
+
+    const SequenceList &BySequenceNumber() const noexcept { return m_bySequenceNumber; }
+
+   private:
+    std::size_t LevelIndex(unsigned long price) const noexcept { return (price - m_basePrice) / m_tickSize; }
+
+    unsigned long LevelPrice(std::size_t index) const noexcept { return m_basePrice + index * m_tickSize; }
+
+    // the depth index counts from the best possible price, so the bids are
+    // held in it the other way round; this maps either way between the two
+    std::size_t DepthLevel(std::size_t index) const noexcept {
+        return S == SideEnum::Buy ? m_levels.size() - 1 - index : index;
+    }
+
+    // how many levels, from the best possible price, are at price or better
+    std::size_t NumLevelsThrough(unsigned long price) const noexcept {
+        if (S == SideEnum::Buy) {
+            if (price <= m_basePrice) {
+                return m_levels.size();
+            }
+            // the first level at or above price
+            auto offset = price - m_basePrice;
+            auto first = offset / m_tickSize + (offset % m_tickSize != 0 ? 1 : 0);
+            return first < m_levels.size() ? m_levels.size() - first : 0;
+        }
+
+        if (price < m_basePrice) {
+            return 0;
+        }
+        // the levels at or below price
+        auto count = (price - m_basePrice) / m_tickSize + 1;
+        return count < m_levels.size() ? count : m_levels.size();
+    }
+
+    // true if level lhs has a better price than level rhs, higher levels hold higher prices
+    static constexpr bool IsBetter(std::size_t lhs, std::size_t rhs) noexcept {
+        return S == SideEnum::Buy ? lhs > rhs : lhs < rhs;
+    }
+
+    unsigned long m_basePrice;
+    unsigned long m_tickSize;
+
+    // level i holds the orders at price m_basePrice + i * m_tickSize
+    std::vector<PriceLevel> m_levels;
+
+    // the quantity of each level, see DepthLevel
+    DepthIndex m_depth;
+
+    // cached cursor to the best non-empty level, only valid if m_orderCount > 0
+    std::size_t m_best;
+    std::size_t m_orderCount;
+
+    SequenceList m_bySequenceNumber;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__BOOK_SIDE_H
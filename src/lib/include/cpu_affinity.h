@@ -0,0 +1,15 @@
+#ifndef MATCHING_ENGINE__CPU_AFFINITY_H
+#define MATCHING_ENGINE__CPU_AFFINITY_H
+
+namespace gemini {
+
+// number of cpus this process may run on
+unsigned AvailableCpus() noexcept;
+
+// pins the calling thread to the nth cpu this process may run on, wrapping
+// around if there are fewer than n, returns false if the thread could not be pinned
+bool PinCurrentThread(unsigned n) noexcept;
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__CPU_AFFINITY_H
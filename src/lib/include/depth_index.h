@@ -0,0 +1,83 @@
+#ifndef MATCHING_ENGINE__DEPTH_INDEX_H
+#define MATCHING_ENGINE__DEPTH_INDEX_H
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace gemini {
+
+// cumulative quantity over a fixed number of levels, as a Fenwick tree
+//
+// Levels are numbered from 0. Changing the quantity of a level, summing the
+// first n levels and finding how many levels it takes to reach a quantity are
+// all O(log levels), so depth through any price can be answered without
+// walking the levels in between.
+class DepthIndex {
+   public:
+    explicit DepthIndex(std::size_t numLevels) : m_tree(numLevels + 1, 0), m_topStep(1) {
+        while (m_topStep * 2 <= numLevels) {
+            m_topStep *= 2;
+        }
+    }
+
+    std::size_t NumLevels() const noexcept { return m_tree.size() - 1; }
+
+    void Add(std::size_t level, unsigned long quantity) noexcept {
+        assert(level < NumLevels());
+
+        for (auto i = level + 1; i < m_tree.size(); i += LowestBit(i)) {
+            m_tree[i] += quantity;
+        }
+    }
+
+    // the level must hold at least this much
+    void Subtract(std::size_t level, unsigned long quantity) noexcept {
+        assert(level < NumLevels());
+
+        for (auto i = level + 1; i < m_tree.size(); i += LowestBit(i)) {
+            m_tree[i] -= quantity;
+        }
+    }
+
+    // of levels [0, count)
+    unsigned long Sum(std::size_t count) const noexcept {
+        assert(count <= NumLevels());
+
+        unsigned long total = 0;
+        for (auto i = count; i > 0; i -= LowestBit(i)) {
+            total += m_tree[i];
+        }
+        return total;
+    }
+
+    // the first level at which the running total reaches quantity, which must
+    // be more than zero, or NumLevels() if all of them together hold less
+    std::size_t FindLevel(unsigned long quantity) const noexcept {
+        assert(quantity > 0);
+
+        // descends to the longest prefix still short of quantity, the level
+        // after it is the one that reaches it
+        std::size_t count = 0;
+        for (auto step = m_topStep; step > 0; step /= 2) {
+            if (count + step < m_tree.size() && m_tree[count + step] < quantity) {
+                count += step;
+                quantity -= m_tree[count];
+            }
+        }
+        return count;
+    }
+
+   private:
+    static constexpr std::size_t LowestBit(std::size_t i) noexcept { return i & (~i + 1); }
+
+    // m_tree[i] holds the total of the LowestBit(i) levels ending at level i - 1
+    std::vector<unsigned long> m_tree;
+
+    // the highest power of two no more than the number of levels
+    std::size_t m_topStep;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__DEPTH_INDEX_H
@@ -1,10 +1,15 @@
 #ifndef MATCHING_ENGINE__FIELDS_H
 #define MATCHING_ENGINE__FIELDS_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace gemini {
 
+// dense id for an instrument, see SymbolRegistry
+using SymbolId = std::uint32_t;
+
 namespace SideEnum {
 enum Type {
     Unknown,
@@ -26,7 +31,7 @@ constexpr const char *ToString(Type type) {
     return "<UNKNOWN>";
 }
 
-inline Type FromString(const std::string &str) {
+inline Type FromString(std::string_view str) {
     if (str == "BUY") {
         return Type::Buy;
     } else if (str == "SELL") {
@@ -43,5 +48,111 @@ constexpr Type ContraSide(Type type) {
 }
 }  // namespace SideEnum
 
+namespace BookTypeEnum {
+enum Type {
+    Unknown,
+    Map = 'M',
+    Ladder = 'L',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::Map:
+            return "MAP";
+        case Type::Ladder:
+            return "LADDER";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+    return "<UNKNOWN>";
+}
+
+inline Type FromString(const std::string &str) {
+    if (str == "MAP") {
+        return Type::Map;
+    } else if (str == "LADDER") {
+        return Type::Ladder;
+    }
+    return Type::Unknown;
+}
+}  // namespace BookTypeEnum
+
+// how the price of a new order limits what it trades with
+namespace OrderTypeEnum {
+enum Type {
+    Unknown,
+    // trades at its price or better, whatever is left rests if its time in
+    // force allows
+    Limit = 'L',
+    // trades at any price and never rests
+    Market = 'M',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::Limit:
+            return "LIMIT";
+        case Type::Market:
+            return "MARKET";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+    return "<UNKNOWN>";
+}
+
+inline Type FromString(std::string_view str) {
+    if (str == "LIMIT") {
+        return Type::Limit;
+    } else if (str == "MARKET") {
+        return Type::Market;
+    }
+    return Type::Unknown;
+}
+}  // namespace OrderTypeEnum
+
+// how long a new order stays on the book
+namespace TimeInForceEnum {
+enum Type {
+    Unknown,
+    // whatever is left once matched rests until cancelled
+    GoodTillCancel = 'G',
+    // whatever is left once matched is cancelled
+    ImmediateOrCancel = 'I',
+    // trades all of its quantity at once or is rejected without trading
+    FillOrKill = 'F',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::GoodTillCancel:
+            return "GTC";
+        case Type::ImmediateOrCancel:
+            return "IOC";
+        case Type::FillOrKill:
+            return "FOK";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+    return "<UNKNOWN>";
+}
+
+inline Type FromString(std::string_view str) {
+    if (str == "GTC") {
+        return Type::GoodTillCancel;
+    } else if (str == "IOC") {
+        return Type::ImmediateOrCancel;
+    } else if (str == "FOK") {
+        return Type::FillOrKill;
+    }
+    return Type::Unknown;
+}
+}  // namespace TimeInForceEnum
+
 }  // namespace gemini
 #endif  // MATCHING_ENGINE__FIELDS_H
@@ -0,0 +1,157 @@
+#ifndef MATCHING_ENGINE__FRAME_READER_H
+#define MATCHING_ENGINE__FRAME_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "wire_messages.h"
+
+namespace gemini {
+
+// reads length prefixed binary messages from a file descriptor without copying them
+//
+// The binary counterpart of LineReader: a regular file is mapped and each
+// message is handed out where it lies in the mapping, anything else is read in
+// large chunks into a reused buffer. Every message starts with a wire::Header
+// whose length covers the whole message and is a multiple of
+// wire::FrameAlignment, so messages are always handed out suitably aligned.
+class FrameReader {
+   public:
+    // the descriptor must stay open for as long as the reader is used
+    explicit FrameReader(int fd, std::size_t chunkSize = DefaultChunkSize);
+
+    ~FrameReader();
+
+    // the mapping is released in the destructor, so the reader cannot be copied
+    FrameReader(const FrameReader &) = delete;
+    FrameReader &operator=(const FrameReader &) = delete;
+
+    bool IsMapped() const noexcept;
+
+    // as LineReader::SetIdleHandler
+    void SetIdleHandler(std::function<int()> idle);
+
+    // calls fn(const wire::Header &) for each message until the input ends or
+    // fn returns false, the header is followed by the rest of the message
+    //
+    // A length that is too short or not aligned loses track of where the next
+    // message starts, so reading stops there, as it does at a message cut short
+    // by the end of the input. Corrupt() tells these apart from a clean end,
+    // and CutShort() the last from the others.
+    template <typename Fn>
+    void ForEachFrame(Fn &&fn);
+
+    bool Corrupt() const noexcept;
+
+    // the input ends part way through a message, as a crash while appending
+    // to it would leave it, rather than being corrupt before its end
+    bool CutShort() const noexcept;
+
+    // totals for the messages handed out so far
+    unsigned long Frames() const noexcept;
+    unsigned long Bytes() const noexcept;
+
+   private:
+    static constexpr std::size_t DefaultChunkSize = 1 << 20;
+
+    // calls fn for each complete message in [begin, end), returns the start of
+    // the trailing partial message, or nullptr if fn asked to stop or the
+    // input is corrupt
+    template <typename Fn>
+    const char *SplitFrames(const char *begin, const char *end, Fn &fn);
+
+    // as LineReader::Fill
+    std::size_t Fill(std::size_t used);
+
+    // as LineReader::WaitForInput
+    void WaitForInput();
+
+    char *BufferData() noexcept;
+    std::size_t BufferSize() const noexcept;
+
+    int m_fd;
+
+    // the whole file if it could be mapped, nullptr otherwise
+    const char *m_mapped;
+    std::size_t m_mappedSize;
+
+    // streaming only, held as words so messages in it are aligned
+    std::vector<std::uint64_t> m_buffer;
+    std::function<int()> m_idle;
+
+    bool m_corrupt;
+    bool m_cutShort;
+
+    unsigned long m_frames;
+    unsigned long m_bytes;
+};
+
+template <typename Fn>
+void FrameReader::ForEachFrame(Fn &&fn) {
+    if (m_mapped != nullptr) {
+        auto *end = m_mapped + m_mappedSize;
+        auto *rest = SplitFrames(m_mapped, end, fn);
+        if (rest != nullptr && rest != end) {
+            m_corrupt = true;
+            m_cutShort = true;
+        }
+        return;
+    }
+
+    std::size_t used = 0;
+    for (;;) {
+        auto read = Fill(used);
+        if (read == 0) {
+            break;
+        }
+        used += read;
+
+        auto *begin = BufferData();
+        auto *rest = SplitFrames(begin, begin + used, fn);
+        if (rest == nullptr) {
+            return;
+        }
+
+        // move the partial message to the front, which keeps it aligned
+        used = static_cast<std::size_t>(begin + used - rest);
+        std::memmove(begin, rest, used);
+    }
+
+    if (used > 0) {
+        m_corrupt = true;
+        m_cutShort = true;
+    }
+}
+
+template <typename Fn>
+const char *FrameReader::SplitFrames(const char *begin, const char *end, Fn &fn) {
+    while (static_cast<std::size_t>(end - begin) >= sizeof(wire::Header)) {
+        wire::Header header;
+        std::memcpy(&header, begin, sizeof(header));
+
+        if (header.length < sizeof(wire::Header) || header.length % wire::FrameAlignment != 0) {
+            m_corrupt = true;
+            return nullptr;
+        }
+        if (static_cast<std::size_t>(end - begin) < header.length) {
+            break;
+        }
+
+        m_frames++;
+        m_bytes += header.length;
+
+        // messages are aligned, so the header can be used where it lies
+        if (!fn(*reinterpret_cast<const wire::Header *>(begin))) {
+            return nullptr;
+        }
+        begin += header.length;
+    }
+    return begin;
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__FRAME_READER_H
@@ -0,0 +1,165 @@
+#ifndef MATCHING_ENGINE__JOURNAL_H
+#define MATCHING_ENGINE__JOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "binary_parser.h"
+#include "messages.h"
+#include "symbol_registry.h"
+
+namespace gemini {
+
+// when the journal makes entries durable with fdatasync, from safest to fastest
+namespace FsyncPolicyEnum {
+enum Type {
+    Unknown,
+    // every entry is written and synced before the message is matched
+    Always = 'A',
+    // group commit: entries are written and synced together once a batch is
+    // full or its oldest entry has waited batchInterval, on the calling thread,
+    // which must call CommitIfDue while it has nothing to append
+    Batched = 'B',
+    // entries are written in batches and a background thread writes whatever
+    // is left and syncs it every batchInterval, the calling thread never waits
+    // for the disk
+    Deferred = 'D',
+    // entries are written in batches as for Batched and left to the kernel
+    Never = 'N',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::Always:
+            return "ALWAYS";
+        case Type::Batched:
+            return "BATCHED";
+        case Type::Deferred:
+            return "DEFERRED";
+        case Type::Never:
+            return "NEVER";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+}
+
+inline Type FromString(const std::string &str) {
+    if (str == "ALWAYS") {
+        return Type::Always;
+    } else if (str == "BATCHED") {
+        return Type::Batched;
+    } else if (str == "DEFERRED") {
+        return Type::Deferred;
+    } else if (str == "NEVER") {
+        return Type::Never;
+    }
+    return Type::Unknown;
+}
+}  // namespace FsyncPolicyEnum
+
+struct JournalConfig {
+    FsyncPolicyEnum::Type fsyncPolicy = FsyncPolicyEnum::Batched;
+
+    // entries buffered before they are written (and synced, if Batched)
+    std::size_t batchMessages = 256;
+
+    // the longest an entry is buffered, and how often Deferred syncs
+    std::chrono::microseconds batchInterval{1000};
+};
+
+// write-ahead journal of the inbound messages an engine has sequenced
+//
+// Each message is appended with its sequence number as a wire::JournalEntry,
+// preceded by the definitions of its symbols the first time they are used, so
+// the journal is binary input that BinaryParser reads back along with the
+// sequence numbers (see binary_parser.h). Only Always makes each entry durable
+// before its message is matched, the other policies buffer entries in the
+// process and trade how much of the tail a crash can lose for latency as
+// described in FsyncPolicyEnum.
+//
+// Failures are sticky: once a write or sync fails nothing more is written and
+// Failed() says so, it is up to the caller what to do about it.
+class Journal {
+   public:
+    // the descriptor should be opened for appending, it is not closed
+    Journal(int fd, const SymbolRegistry &symbols, const JournalConfig &config = JournalConfig{});
+
+    // commits whatever is left and stops the sync thread
+    ~Journal();
+
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    // returns false once the journal has failed
+    bool Append(const MessageHeader &msg, unsigned long sequenceNumber);
+
+    // writes the buffered entries and syncs everything written so far, unless
+    // the policy is Never
+    bool Commit();
+
+    // when the calling thread must next call CommitIfDue, nullopt if nothing
+    // is buffered or it is up to the sync thread
+    std::optional<std::chrono::steady_clock::time_point> CommitDeadline() const;
+
+    // commits if the oldest buffered entry has waited batchInterval, so entries
+    // do not wait for the next message to be appended before they are written
+    bool CommitIfDue();
+
+    bool Failed() const noexcept;
+
+    const JournalConfig &Config() const noexcept;
+
+    unsigned long Entries() const noexcept;
+    unsigned long BytesWritten() const noexcept;
+    unsigned long Syncs() const noexcept;
+
+   private:
+    // hands the buffered entries to the descriptor
+    bool Write();
+
+    bool Sync();
+
+    // runs on the sync thread when the policy is Deferred
+    void SyncPeriodically();
+
+    // the buffer is shared with the sync thread if there is one
+    std::unique_lock<std::mutex> LockBuffer();
+
+    int m_fd;
+
+    JournalConfig m_config;
+
+    BinaryEncoder m_encoder;
+
+    std::string m_buffer;
+    std::size_t m_pending;
+
+    // when the oldest buffered entry was appended
+    std::chrono::steady_clock::time_point m_oldestPending;
+
+    unsigned long m_entries;
+    unsigned long m_bytesWritten;
+
+    // also touched by the sync thread
+    std::atomic<unsigned long> m_syncs;
+    std::atomic<bool> m_failed;
+
+    // guards the buffer, what is pending and the bytes written when there is
+    // a sync thread
+    std::mutex m_mutex;
+    std::condition_variable m_stopRequested;
+    bool m_stop;
+    std::thread m_syncThread;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__JOURNAL_H
@@ -0,0 +1,134 @@
+#ifndef MATCHING_ENGINE__LINE_READER_H
+#define MATCHING_ENGINE__LINE_READER_H
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace gemini {
+
+// reads newline terminated lines from a file descriptor without copying them
+//
+// A regular file is mapped into memory and lines are handed out as views into
+// the mapping. Anything else (a pipe, a terminal) is read in large chunks into
+// a buffer that is reused, so lines are only ever copied when one straddles the
+// end of a chunk. Either way no memory is allocated per line.
+class LineReader {
+   public:
+    // the descriptor must stay open for as long as the reader is used
+    explicit LineReader(int fd, std::size_t chunkSize = DefaultChunkSize);
+
+    ~LineReader();
+
+    // the mapping is released in the destructor, so the reader cannot be copied
+    LineReader(const LineReader &) = delete;
+    LineReader &operator=(const LineReader &) = delete;
+
+    bool IsMapped() const noexcept;
+
+    // streaming only: while waiting for more input, calls idle() to do
+    // whatever is due in the meantime, which returns the milliseconds until it
+    // wants calling again, or -1 to wait for input however long it takes
+    void SetIdleHandler(std::function<int()> idle);
+
+    // calls fn(std::string_view line) for each line, without its terminator,
+    // until the input ends or fn returns false. A final line without a
+    // terminator is still handed out
+    template <typename Fn>
+    void ForEachLine(Fn &&fn);
+
+    // totals for the lines handed out so far, bytes include the terminators
+    unsigned long Lines() const noexcept;
+    unsigned long Bytes() const noexcept;
+
+   private:
+    static constexpr std::size_t DefaultChunkSize = 1 << 20;
+
+    // calls fn for each complete line in [begin, end), returns the start of the
+    // trailing partial line, or nullptr if fn asked to stop
+    template <typename Fn>
+    const char *SplitLines(const char *begin, const char *end, Fn &fn);
+
+    // reads more input after the first `used` bytes of the buffer, growing it if
+    // it is full, returns the number of bytes read, 0 at the end of the input
+    std::size_t Fill(std::size_t used);
+
+    // returns once there is input to read or the idle handler has nothing due
+    void WaitForInput();
+
+    int m_fd;
+
+    // the whole file if it could be mapped, nullptr otherwise
+    const char *m_mapped;
+    std::size_t m_mappedSize;
+
+    // streaming only
+    std::vector<char> m_buffer;
+    std::function<int()> m_idle;
+
+    unsigned long m_lines;
+    unsigned long m_bytes;
+};
+
+template <typename Fn>
+void LineReader::ForEachLine(Fn &&fn) {
+    if (m_mapped != nullptr) {
+        auto *end = m_mapped + m_mappedSize;
+        auto *rest = SplitLines(m_mapped, end, fn);
+        if (rest != nullptr && rest != end) {
+            m_lines++;
+            m_bytes += static_cast<unsigned long>(end - rest);
+            fn(std::string_view(rest, static_cast<std::size_t>(end - rest)));
+        }
+        return;
+    }
+
+    std::size_t used = 0;
+    for (;;) {
+        auto read = Fill(used);
+        if (read == 0) {
+            break;
+        }
+        used += read;
+
+        auto *begin = m_buffer.data();
+        auto *rest = SplitLines(begin, begin + used, fn);
+        if (rest == nullptr) {
+            return;
+        }
+
+        // move the partial line to the front so the next read completes it
+        used = static_cast<std::size_t>(begin + used - rest);
+        std::memmove(begin, rest, used);
+    }
+
+    if (used > 0) {
+        m_lines++;
+        m_bytes += used;
+        fn(std::string_view(m_buffer.data(), used));
+    }
+}
+
+template <typename Fn>
+const char *LineReader::SplitLines(const char *begin, const char *end, Fn &fn) {
+    while (begin != end) {
+        auto *newline = static_cast<const char *>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+        if (newline == nullptr) {
+            break;
+        }
+
+        m_lines++;
+        m_bytes += static_cast<unsigned long>(newline - begin) + 1;
+        if (!fn(std::string_view(begin, static_cast<std::size_t>(newline - begin)))) {
+            return nullptr;
+        }
+        begin = newline + 1;
+    }
+    return begin;
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__LINE_READER_H
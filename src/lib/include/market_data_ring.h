@@ -0,0 +1,238 @@
+#ifndef MATCHING_ENGINE__MARKET_DATA_RING_H
+#define MATCHING_ENGINE__MARKET_DATA_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "messages.h"
+#include "spsc_queue.h"
+#include "symbol_registry.h"
+#include "trade_buffer.h"
+#include "wire_messages.h"
+
+namespace gemini {
+
+// A ring of market data messages in shared memory, written by the engine and
+// read by any number of other processes on the same host.
+//
+// Each slot of the ring is one cache line holding a wire message (see
+// wire_messages.h) and the sequence number it was published under, counting
+// from 1. The writer never waits: it overwrites the oldest slot, setting its
+// sequence number to 0 while the message is copied in, and readers check the
+// sequence number around their copy the way a seqlock is read, so a reader
+// that falls a whole ring behind finds out it was lapped instead of reading a
+// message it did not expect. Symbol ids are named in a directory next to the
+// ring, so readers that start late can still name every symbol.
+//
+// The segment is laid out as a ring::Header, then the symbol directory, then
+// the slots, all in host byte order.
+namespace ring {
+
+// "GMDRING1", written last by the writer so a half set up ring is not read
+constexpr std::uint64_t Magic = 0x31474e4952444d47;
+
+struct Header {
+    std::atomic<std::uint64_t> magic;
+    std::uint64_t capacity;  // slots, a power of two
+    std::uint64_t maxSymbols;
+
+    // the sequence number of the last message published, on a line of its own
+    alignas(CacheLineSize) std::atomic<std::uint64_t> head;
+};
+
+// room for the largest wire message after the sequence number
+constexpr std::size_t SlotWords = wire::MaxMessageSize / sizeof(std::uint64_t);
+
+struct alignas(CacheLineSize) Slot {
+    // 0 while the message is being written
+    std::atomic<std::uint64_t> sequenceNumber;
+
+    // the message as 8 byte words, read and written as relaxed atomics so a
+    // copy racing the writer is thrown away rather than being a data race
+    std::atomic<std::uint64_t> words[SlotWords];
+};
+
+// the longest symbol name the directory can hold
+constexpr std::size_t MaxSymbolName = 60;
+
+struct SymbolName {
+    // 0 until the name has been written
+    std::atomic<std::uint32_t> length;
+    char name[MaxSymbolName];
+};
+
+static_assert(sizeof(Slot) == CacheLineSize, "a slot is one cache line");
+static_assert(sizeof(SymbolName) == 64, "symbol names are 64 bytes");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free && std::atomic<std::uint32_t>::is_always_lock_free,
+              "shared memory needs lock free atomics");
+
+}  // namespace ring
+
+struct MarketDataRingConfig {
+    // messages kept before the oldest is overwritten, rounded up to a power of two
+    std::size_t capacity = 1 << 16;
+
+    // symbol ids from 0 up to this can be named in the directory
+    std::size_t maxSymbols = 1024;
+};
+
+// the size of the segment for a ring of this configuration
+std::size_t MarketDataRingSize(const MarketDataRingConfig &config) noexcept;
+
+// opens (creating it if needed) or unlinks a POSIX shared memory object, see
+// shm_open; returns the descriptor, or -1 and errno
+int OpenSharedMemory(const std::string &name, bool create) noexcept;
+bool UnlinkSharedMemory(const std::string &name) noexcept;
+
+// the single writer of a ring
+class MarketDataWriter {
+   public:
+    // sizes the descriptor for the ring, maps it and starts the ring empty;
+    // the descriptor must be open for reading and writing, it is not closed
+    explicit MarketDataWriter(int fd, const MarketDataRingConfig &config = MarketDataRingConfig{});
+
+    ~MarketDataWriter();
+
+    MarketDataWriter(const MarketDataWriter &) = delete;
+    MarketDataWriter &operator=(const MarketDataWriter &) = delete;
+
+    // false if the descriptor could not be sized or mapped, in which case
+    // nothing is published
+    bool IsMapped() const noexcept;
+
+    // names the symbol for readers, returns false if its id or its name do
+    // not fit the directory, messages about it are published all the same
+    bool DefineSymbol(SymbolId symbol, std::string_view name) noexcept;
+
+    bool IsDefined(SymbolId symbol) const noexcept;
+
+    // copies a whole wire message of at most wire::MaxMessageSize bytes into
+    // the next slot
+    void Publish(const wire::Header &msg) noexcept;
+
+    // of the last message published
+    unsigned long SequenceNumber() const noexcept;
+
+    std::size_t Capacity() const noexcept;
+
+   private:
+    ring::Header *m_header;
+    ring::SymbolName *m_symbols;
+    ring::Slot *m_slots;
+
+    std::size_t m_size;
+    std::size_t m_capacity;
+    std::size_t m_maxSymbols;
+
+    unsigned long m_sequenceNumber;
+};
+
+namespace RingReadStatusEnum {
+enum Type {
+    Unknown,
+    Ok = 'O',
+    // nothing has been published since the last message read
+    Empty = 'E',
+    // the writer overwrote messages before they were read
+    Lapped = 'L',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::Ok:
+            return "OK";
+        case Type::Empty:
+            return "EMPTY";
+        case Type::Lapped:
+            return "LAPPED";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+}
+}  // namespace RingReadStatusEnum
+
+// one reader of a ring, any number may read the same ring at once
+//
+// Reading never writes to the segment, so readers cannot slow each other or
+// the writer down beyond the cache lines they share.
+class MarketDataReader {
+   public:
+    // maps the ring a writer has set up on the descriptor, which may be read
+    // only, and starts after the last message published so far; the
+    // descriptor is not closed
+    explicit MarketDataReader(int fd);
+
+    ~MarketDataReader();
+
+    MarketDataReader(const MarketDataReader &) = delete;
+    MarketDataReader &operator=(const MarketDataReader &) = delete;
+
+    // false if the descriptor does not hold a ring that has been set up
+    bool IsMapped() const noexcept;
+
+    // takes the next message
+    //
+    // Once lapped the reader skips ahead to the next message to be published,
+    // so it is caught up again however far behind it was; Missed() counts
+    // what it skipped.
+    RingReadStatusEnum::Type Read() noexcept;
+
+    // the message last read, good until the next Read
+    const wire::Header &Message() const noexcept;
+
+    // of the message last read
+    unsigned long SequenceNumber() const noexcept;
+
+    unsigned long Missed() const noexcept;
+
+    // empty until the writer has named the symbol
+    std::string_view SymbolName(SymbolId symbol) const noexcept;
+
+   private:
+    // copies the message with this sequence number out of its slot, false if
+    // the slot holds any other
+    bool TryCopy(unsigned long sequenceNumber) noexcept;
+
+    const ring::Header *m_header;
+    const ring::SymbolName *m_symbols;
+    const ring::Slot *m_slots;
+
+    std::size_t m_size;
+    std::size_t m_capacity;
+    std::size_t m_maxSymbols;
+
+    unsigned long m_next;
+    unsigned long m_sequenceNumber;
+    unsigned long m_missed;
+
+    alignas(std::uint64_t) char m_message[ring::SlotWords * sizeof(std::uint64_t)];
+};
+
+// publishes what an engine sends to a ring: level and order updates as its
+// MarketDataSink, and trades when its Sink passes them on
+//
+// Each symbol is named in the ring before the first message about it. Copies
+// publish to the same writer, which must outlive them.
+class MarketDataPublisher {
+   public:
+    MarketDataPublisher(MarketDataWriter &writer, const SymbolRegistry &symbols);
+
+    void operator()(TradeSpan trades) const;
+    void operator()(const LevelUpdate &update) const;
+    void operator()(const OrderUpdate &update) const;
+
+   private:
+    void Define(SymbolId symbol) const;
+
+    MarketDataWriter *m_writer;
+    const SymbolRegistry *m_symbols;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__MARKET_DATA_RING_H
@@ -1,40 +1,616 @@
 #ifndef MATCHING_ENGINE__MATCHING_ENGINE_H
 #define MATCHING_ENGINE__MATCHING_ENGINE_H
 
+#include <algorithm>
+#include <cassert>
 #include <functional>
-#include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "journal.h"
 #include "messages.h"
 #include "order_book.h"
+#include "snapshot.h"
+#include "symbol_registry.h"
+#include "trade_buffer.h"
+#include "wire_messages.h"
 
 namespace gemini {
-class MatchingEngine {
+
+// hands a batch of trades to a sink, as one call if the sink takes a TradeSpan
+// and otherwise as one call per trade
+template <typename Sink>
+void SendTrades(Sink &sink, TradeSpan trades) {
+    if constexpr (std::is_invocable_v<Sink &, TradeSpan>) {
+        sink(trades);
+    } else {
+        for (auto const &trade : trades) {
+            sink(trade);
+        }
+    }
+}
+
+// Routes messages to the order book for their symbol.
+//
+// Outbound messages are passed to a sink by their concrete type, so the sink
+// must be callable with each of Trade, CancelAck, ReplaceAck and Reject. A sink
+// that is also callable with a TradeSpan is given the trades for each inbound
+// order as one batch instead. The sink is a template parameter so the output
+// path can be inlined all the way from the matching loop, see MatchingEngine
+// below for the type-erased form.
+//
+// Market data goes to a sink of its own, callable with a LevelUpdate for each
+// change to a price level of any book (see BasicOrderBook), so order entry and
+// market data can be published separately. A market data sink that is also
+// callable with an OrderUpdate is sent every change to a resting order too.
+template <typename Sink, typename MarketDataSink = NoLevelUpdates>
+class BasicMatchingEngine {
    public:
-    using SendMessageFn = std::function<void(const MessageHeader &msg)>;
+    // symbols are interned by the caller, the engine only turns ids back
+    // into text when dumping
+    BasicMatchingEngine(const SymbolRegistry &symbols, Sink sink, MarketDataSink marketData = MarketDataSink());
+
+    // the books hold on to the sink, so the engine cannot be moved
+    BasicMatchingEngine(const BasicMatchingEngine &) = delete;
+    BasicMatchingEngine &operator=(const BasicMatchingEngine &) = delete;
+
+    // selects the book implementation for a symbol, must be called before
+    // the first order on that symbol, returns false if the book already exists
+    bool ConfigureSymbol(SymbolId symbol, const OrderBookConfig &config);
 
-    MatchingEngine(SendMessageFn fn);
+    // appends every message from now on to the journal before matching it,
+    // nullptr stops journalling; the journal must outlive its use here
+    //
+    // A message the journal fails to take is rejected with
+    // RejectReasonEnum::JournalFailed instead of being matched, as is every
+    // message after it, since the journal's failures are sticky.
+    void AttachJournal(Journal *journal) noexcept;
 
+    // sequences the message after the last one seen
     void OnMessage(const MessageHeader &msg);
 
+    // for callers that sequence messages themselves, sequence numbers must
+    // increase from one message to the next
+    void OnMessage(const MessageHeader &msg, unsigned long sequenceNumber);
+
+    // as above for a message handled before a restart, which is already in the
+    // journal and whose output has already been sent: only the books are
+    // brought up to date, nothing is journalled or sent to either sink
+    void Replay(const MessageHeader &msg, unsigned long sequenceNumber);
+
+    // as above for an inbound message in its wire layout, straight from a
+    // transport without converting it first
+    //
+    // The header must start a whole message of header.length bytes, aligned as
+    // the wire layouts are. Returns false, and sequences nothing, if the
+    // message is malformed, not an inbound message, or names a symbol the
+    // registry does not have.
+    bool OnMessage(const wire::Header &msg);
+
+    // messages are handled as they arrive, so there is never anything in flight
+    void Flush() noexcept {}
+
+    // calls fn(const std::string &symbolName, const Order &) for each resting
+    // order, books in symbol name order and each book as in its ForEachOrder
+    template <typename Fn>
+    void ForEachOrder(Fn &&fn) const;
+
+    // as above for the book of one symbol, if there is one
+    template <typename Fn>
+    void ForEachOrder(SymbolId symbol, Fn &&fn) const;
+
     std::vector<std::string> Dump() const;
 
+    // what is resting at a price on one side of the book for a symbol
+    LevelTotals Level(SymbolId symbol, SideEnum::Type side, unsigned long price) const;
+
+    // cumulative depth of one side of the book for a symbol, see
+    // BasicOrderBook::QuantityThrough and BasicOrderBook::PriceToFill
+    unsigned long QuantityThrough(SymbolId symbol, SideEnum::Type side, unsigned long price) const;
+    std::optional<unsigned long> PriceToFill(SymbolId symbol, SideEnum::Type side, unsigned long quantity) const;
+
+    // the top of book for a symbol, for other threads to read while the engine
+    // runs (see BasicOrderBook::Top), nullptr if the symbol has no book yet
+    //
+    // Books are created by the thread handling the messages, so only a book
+    // that already exists, for instance from ConfigureSymbol, may be looked up
+    // from another thread, and only before messages start arriving. The
+    // pointer is good for the life of the engine.
+    const TopOfBookCache *Top(SymbolId symbol) const;
+
+    // of the last message handled
+    unsigned long SequenceNumber() const noexcept;
+
+    // writes every book and the sequence number, see snapshot.h, returns false
+    // if the snapshot could not be written
+    bool WriteSnapshot(SnapshotWriter &writer) const;
+
+    // rebuilds the books of a snapshot without matching anything and carries
+    // on from its sequence number, only before the first message or book
+    //
+    // Returns false, leaving the engine without books, if the snapshot is
+    // malformed or holds orders that could not have been resting as they are.
+    bool LoadSnapshot(SnapshotReader &reader);
+
    private:
+    // enough for most sweeps, the buffer grows to fit larger ones
+    static constexpr std::size_t InitialTradeCapacity = 1024;
+
+    // hands trades from a book on to the engine, which passes them to its sink
+    struct TradeForwarder {
+        BasicMatchingEngine *engine;
+
+        void operator()(TradeSpan trades) const { engine->Send(trades); }
+    };
+
+    // and level and order updates, which the engine passes to its market data
+    // sink; order updates only if the sink takes them, so the books only make
+    // them if they are wanted
+    struct LevelForwarder {
+        BasicMatchingEngine *engine;
+
+        template <typename Update, typename = std::enable_if_t<std::is_invocable_v<MarketDataSink &, const Update &>>>
+        void operator()(const Update &update) const {
+            engine->Publish(update);
+        }
+    };
+
+    using Book = BasicOrderBook<TradeForwarder, LevelForwarder>;
+
+    // converts the message, only reads past the header once it has checked
+    // the type and length
+    template <typename Wire, typename Message>
+    bool OnWireMessage(const wire::Header &msg);
+
     void OnNewOrder(const NewOrder &newOrder);
+    void OnCancelOrder(const CancelOrder &cancelOrder);
+    void OnReplaceOrder(const ReplaceOrder &replaceOrder);
+
+    // nullptr if no order has been seen for the symbol
+    Book *FindSymbolOrderBook(SymbolId symbol) noexcept;
+
+    // passes outbound messages on to the sink unless replaying
+    void Send(TradeSpan trades);
+    template <typename Message>
+    void Send(const Message &msg);
 
-    void HandleOrderMatched(const Trade &trade);
+    // and market data on to the market data sink
+    template <typename Update>
+    void Publish(const Update &update);
 
-    OrderBook &FindOrCreateSymbolOrderBook(const std::string &symbol);
+    void SendCancelAck(const Order &order);
 
-    SendMessageFn m_sendMessage;
+    void SendReject(MessageTypeEnum::Type messageType, SymbolId symbol, const OrderId &orderId,
+                    RejectReasonEnum::Type reason);
+
+    // rejects an inbound message as a whole
+    template <typename Message>
+    void SendReject(const Message &msg, RejectReasonEnum::Type reason);
+
+    // for a message the journal failed to take
+    void RejectUnjournalled(const MessageHeader &msg);
+
+    Book &FindOrCreateSymbolOrderBook(SymbolId symbol, const OrderBookConfig &config);
+
+    const SymbolRegistry &m_symbols;
+
+    Sink m_sink;
+
+    MarketDataSink m_marketData;
+
+    // shared by all books, only ever holds the trades of the order being matched
+    TradeBuffer m_trades;
 
     // sequence number increments on receipt of each message
     unsigned long m_sequenceNumber;
 
-    // one order book per symbol (instrument)
-    std::map<std::string, OrderBook> m_orderBooks;
+    Journal *m_journal;
+
+    // set while replaying, when nothing is sent
+    bool m_replaying;
+
+    // one order book per symbol (instrument), indexed by symbol id and
+    // created on first use
+    std::vector<std::unique_ptr<Book>> m_orderBooks;
 };
+
+// type-erased convenience form, for tests and callers that do not need the
+// output path inlined
+using MatchingEngine = BasicMatchingEngine<std::function<void(const MessageHeader &msg)>>;
+
+template <typename Sink, typename MarketDataSink>
+BasicMatchingEngine<Sink, MarketDataSink>::BasicMatchingEngine(const SymbolRegistry &symbols, Sink sink,
+                                                               MarketDataSink marketData)
+    : m_symbols(symbols),
+      m_sink(std::move(sink)),
+      m_marketData(std::move(marketData)),
+      m_trades(InitialTradeCapacity),
+      m_sequenceNumber(0),
+      m_journal(nullptr),
+      m_replaying(false) {}
+
+template <typename Sink, typename MarketDataSink>
+bool BasicMatchingEngine<Sink, MarketDataSink>::ConfigureSymbol(SymbolId symbol, const OrderBookConfig &config) {
+    if (FindSymbolOrderBook(symbol) != nullptr) {
+        return false;
+    }
+
+    FindOrCreateSymbolOrderBook(symbol, config);
+    return true;
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::AttachJournal(Journal *journal) noexcept {
+    m_journal = journal;
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::OnMessage(const MessageHeader &msg) {
+    OnMessage(msg, m_sequenceNumber + 1);
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::OnMessage(const MessageHeader &msg, unsigned long sequenceNumber) {
+    assert(sequenceNumber > m_sequenceNumber);
+    m_sequenceNumber = sequenceNumber;
+
+    // a message missing from the journal could not be recovered after a
+    // restart, so it is refused rather than matched
+    if (m_journal != nullptr && !m_journal->Append(msg, sequenceNumber)) {
+        RejectUnjournalled(msg);
+        return;
+    }
+
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            OnNewOrder(static_cast<const NewOrder &>(msg));
+            break;
+        case MessageTypeEnum::CancelOrder:
+            OnCancelOrder(static_cast<const CancelOrder &>(msg));
+            break;
+        case MessageTypeEnum::ReplaceOrder:
+            OnReplaceOrder(static_cast<const ReplaceOrder &>(msg));
+            break;
+        default:
+            assert(!"Unexpected message type");
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::RejectUnjournalled(const MessageHeader &msg) {
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            SendReject(static_cast<const NewOrder &>(msg), RejectReasonEnum::JournalFailed);
+            break;
+        case MessageTypeEnum::CancelOrder:
+            SendReject(static_cast<const CancelOrder &>(msg), RejectReasonEnum::JournalFailed);
+            break;
+        case MessageTypeEnum::ReplaceOrder:
+            SendReject(static_cast<const ReplaceOrder &>(msg), RejectReasonEnum::JournalFailed);
+            break;
+        default:
+            assert(!"Unexpected message type");
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::Replay(const MessageHeader &msg, unsigned long sequenceNumber) {
+    auto *journal = m_journal;
+    m_journal = nullptr;
+    m_replaying = true;
+
+    OnMessage(msg, sequenceNumber);
+
+    m_replaying = false;
+    m_journal = journal;
+}
+
+template <typename Sink, typename MarketDataSink>
+bool BasicMatchingEngine<Sink, MarketDataSink>::OnMessage(const wire::Header &msg) {
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            return OnWireMessage<wire::NewOrder, NewOrder>(msg);
+        case MessageTypeEnum::CancelOrder:
+            return OnWireMessage<wire::CancelOrder, CancelOrder>(msg);
+        case MessageTypeEnum::ReplaceOrder:
+            return OnWireMessage<wire::ReplaceOrder, ReplaceOrder>(msg);
+        default:
+            return false;
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+template <typename Wire, typename Message>
+bool BasicMatchingEngine<Sink, MarketDataSink>::OnWireMessage(const wire::Header &msg) {
+    if (msg.length != sizeof(Wire)) {
+        return false;
+    }
+
+    // the header is the first member of the message, so shares its address
+    Message message;
+    if (!FromWire(*reinterpret_cast<const Wire *>(&msg), message)) {
+        return false;
+    }
+
+    // FromWire cannot know the registry, an id it never handed out names no symbol
+    if (!m_symbols.Contains(message.symbol)) {
+        return false;
+    }
+
+    OnMessage(message);
+    return true;
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::OnNewOrder(const NewOrder &msg) {
+    Order order{m_sequenceNumber, msg};
+
+    auto &orderBook = FindOrCreateSymbolOrderBook(order.Symbol(), OrderBookConfig{});
+
+    // may result in trades, an order that may not rest is cancelled once matched
+    auto reason = orderBook.AddOrder(std::move(order), msg.orderType, msg.timeInForce,
+                                     [this](const Order &unfilled) { SendCancelAck(unfilled); });
+    if (reason != RejectReasonEnum::None) {
+        SendReject(MessageTypeEnum::NewOrder, msg.symbol, msg.orderId, reason);
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::OnCancelOrder(const CancelOrder &msg) {
+    // a symbol without a book has no resting orders to cancel
+    auto *orderBook = FindSymbolOrderBook(msg.symbol);
+    if (orderBook == nullptr) {
+        SendReject(MessageTypeEnum::CancelOrder, msg.symbol, msg.orderId, RejectReasonEnum::UnknownOrder);
+        return;
+    }
+
+    auto order = orderBook->CancelOrder(msg.orderId);
+    if (!order) {
+        SendReject(MessageTypeEnum::CancelOrder, msg.symbol, msg.orderId, RejectReasonEnum::UnknownOrder);
+        return;
+    }
+
+    SendCancelAck(*order);
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::OnReplaceOrder(const ReplaceOrder &msg) {
+    // a symbol without a book has no resting orders to replace
+    auto *orderBook = FindSymbolOrderBook(msg.symbol);
+    if (orderBook == nullptr) {
+        SendReject(MessageTypeEnum::ReplaceOrder, msg.symbol, msg.orderId, RejectReasonEnum::UnknownOrder);
+        return;
+    }
+
+    auto handler = [this](const Order &order) {
+        ReplaceAck ack;
+
+        ack.symbol = order.Symbol();
+        ack.orderId = order.OrderId();
+        ack.side = order.Side();
+        ack.quantity = order.Quantity();
+        ack.price = order.Price();
+
+        Send(ack);
+    };
+
+    // may result in trades if the order loses priority
+    auto reason = orderBook->ReplaceOrder(msg.orderId, msg.quantity, msg.price, m_sequenceNumber, handler);
+    if (reason != RejectReasonEnum::None) {
+        SendReject(MessageTypeEnum::ReplaceOrder, msg.symbol, msg.orderId, reason);
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::SendCancelAck(const Order &order) {
+    CancelAck ack;
+
+    ack.symbol = order.Symbol();
+    ack.orderId = order.OrderId();
+    ack.side = order.Side();
+    ack.quantity = order.Quantity();
+    ack.price = order.Price();
+
+    Send(ack);
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::SendReject(MessageTypeEnum::Type messageType, SymbolId symbol,
+                                                           const OrderId &orderId, RejectReasonEnum::Type reason) {
+    Reject reject;
+
+    reject.symbol = symbol;
+    reject.orderId = orderId;
+    reject.rejectedMessageType = messageType;
+    reject.reason = reason;
+
+    Send(reject);
+}
+
+template <typename Sink, typename MarketDataSink>
+template <typename Message>
+void BasicMatchingEngine<Sink, MarketDataSink>::SendReject(const Message &msg, RejectReasonEnum::Type reason) {
+    SendReject(msg.messageType, msg.symbol, msg.orderId, reason);
+}
+
+template <typename Sink, typename MarketDataSink>
+void BasicMatchingEngine<Sink, MarketDataSink>::Send(TradeSpan trades) {
+    if (!m_replaying) {
+        SendTrades(m_sink, trades);
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+template <typename Message>
+void BasicMatchingEngine<Sink, MarketDataSink>::Send(const Message &msg) {
+    if (!m_replaying) {
+        m_sink(msg);
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+template <typename Update>
+void BasicMatchingEngine<Sink, MarketDataSink>::Publish(const Update &update) {
+    if (!m_replaying) {
+        m_marketData(update);
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+template <typename Fn>
+void BasicMatchingEngine<Sink, MarketDataSink>::ForEachOrder(Fn &&fn) const {
+    // books are visited in symbol name order
+    std::vector<SymbolId> symbols;
+    for (SymbolId symbol = 0; symbol < m_orderBooks.size(); ++symbol) {
+        if (m_orderBooks[symbol]) {
+            symbols.push_back(symbol);
+        }
+    }
+    std::sort(symbols.begin(), symbols.end(),
+              [this](SymbolId lhs, SymbolId rhs) { return m_symbols.Name(lhs) < m_symbols.Name(rhs); });
+
+    for (auto symbol : symbols) {
+        ForEachOrder(symbol, fn);
+    }
+}
+
+template <typename Sink, typename MarketDataSink>
+template <typename Fn>
+void BasicMatchingEngine<Sink, MarketDataSink>::ForEachOrder(SymbolId symbol, Fn &&fn) const {
+    if (symbol >= m_orderBooks.size() || !m_orderBooks[symbol]) {
+        return;
+    }
+
+    auto const &symbolName = m_symbols.Name(symbol);
+    m_orderBooks[symbol]->ForEachOrder([&](const Order &order) { fn(symbolName, order); });
+}
+
+template <typename Sink, typename MarketDataSink>
+std::vector<std::string> BasicMatchingEngine<Sink, MarketDataSink>::Dump() const {
+    std::vector<std::string> result;
+
+    ForEachOrder(
+        [&](const std::string &symbolName, const Order &order) { result.push_back(order.ToString(symbolName)); });
+
+    return result;
+}
+
+template <typename Sink, typename MarketDataSink>
+LevelTotals BasicMatchingEngine<Sink, MarketDataSink>::Level(SymbolId symbol, SideEnum::Type side,
+                                                             unsigned long price) const {
+    if (symbol >= m_orderBooks.size() || !m_orderBooks[symbol]) {
+        return {};
+    }
+    return m_orderBooks[symbol]->Level(side, price);
+}
+
+template <typename Sink, typename MarketDataSink>
+const TopOfBookCache *BasicMatchingEngine<Sink, MarketDataSink>::Top(SymbolId symbol) const {
+    if (symbol >= m_orderBooks.size() || !m_orderBooks[symbol]) {
+        return nullptr;
+    }
+    return &m_orderBooks[symbol]->Top();
+}
+
+template <typename Sink, typename MarketDataSink>
+unsigned long BasicMatchingEngine<Sink, MarketDataSink>::QuantityThrough(SymbolId symbol, SideEnum::Type side,
+                                                                         unsigned long price) const {
+    if (symbol >= m_orderBooks.size() || !m_orderBooks[symbol]) {
+        return 0;
+    }
+    return m_orderBooks[symbol]->QuantityThrough(side, price);
+}
+
+template <typename Sink, typename MarketDataSink>
+std::optional<unsigned long> BasicMatchingEngine<Sink, MarketDataSink>::PriceToFill(SymbolId symbol,
+                                                                                    SideEnum::Type side,
+                                                                                    unsigned long quantity) const {
+    if (symbol >= m_orderBooks.size() || !m_orderBooks[symbol]) {
+        return std::nullopt;
+    }
+    return m_orderBooks[symbol]->PriceToFill(side, quantity);
+}
+
+template <typename Sink, typename MarketDataSink>
+unsigned long BasicMatchingEngine<Sink, MarketDataSink>::SequenceNumber() const noexcept {
+    return m_sequenceNumber;
+}
+
+template <typename Sink, typename MarketDataSink>
+bool BasicMatchingEngine<Sink, MarketDataSink>::WriteSnapshot(SnapshotWriter &writer) const {
+    std::size_t numBooks = 0;
+    for (auto const &orderBook : m_orderBooks) {
+        if (orderBook) {
+            numBooks++;
+        }
+    }
+
+    writer.WriteHeader(m_sequenceNumber, numBooks);
+    for (SymbolId symbol = 0; symbol < m_orderBooks.size(); ++symbol) {
+        if (m_orderBooks[symbol] && !writer.WriteBook(symbol, *m_orderBooks[symbol])) {
+            return false;
+        }
+    }
+
+    return writer.Flush();
+}
+
+template <typename Sink, typename MarketDataSink>
+bool BasicMatchingEngine<Sink, MarketDataSink>::LoadSnapshot(SnapshotReader &reader) {
+    assert(m_sequenceNumber == 0 && m_orderBooks.empty());
+
+    Book *orderBook = nullptr;
+
+    auto onBook = [&](SymbolId symbol, OrderBookConfig config, std::size_t numOrders) {
+        if (FindSymbolOrderBook(symbol) != nullptr) {
+            return false;
+        }
+
+        // every order is allocated up front, so the pool never grows while loading
+        config.pool.initialCapacity = std::max(config.pool.initialCapacity, numOrders);
+        orderBook = &FindOrCreateSymbolOrderBook(symbol, config);
+        return true;
+    };
+    auto onOrder = [&](Order order) { return orderBook->RestoreOrder(std::move(order)); };
+
+    if (!reader.Read(onBook, onOrder)) {
+        m_orderBooks.clear();
+        return false;
+    }
+
+    m_sequenceNumber = reader.SequenceNumber();
+    return true;
+}
+
+template <typename Sink, typename MarketDataSink>
+typename BasicMatchingEngine<Sink, MarketDataSink>::Book *
+BasicMatchingEngine<Sink, MarketDataSink>::FindSymbolOrderBook(SymbolId symbol) noexcept {
+    if (symbol >= m_orderBooks.size()) {
+        return nullptr;
+    }
+    return m_orderBooks[symbol].get();
+}
+
+template <typename Sink, typename MarketDataSink>
+typename BasicMatchingEngine<Sink, MarketDataSink>::Book &
+BasicMatchingEngine<Sink, MarketDataSink>::FindOrCreateSymbolOrderBook(SymbolId symbol, const OrderBookConfig &config) {
+    // the registry is deliberately not consulted here, symbols are only turned
+    // into names when dumping so they may be interned by another thread meanwhile
+    if (symbol >= m_orderBooks.size()) {
+        m_orderBooks.resize(symbol + 1);
+    }
+
+    auto &orderBook = m_orderBooks[symbol];
+    if (!orderBook) {
+        orderBook = std::make_unique<Book>(symbol, config, m_trades, TradeForwarder{this}, LevelForwarder{this});
+    }
+
+    return *orderBook;
+}
+
 }  // namespace gemini
 
 #endif  // MATCHING_ENGINE__MATCHING_ENGINE_H
@@ -4,21 +4,58 @@
 #include <string>
 
 #include "fields.h"
+#include "order_id.h"
 
 namespace gemini {
 namespace MessageTypeEnum {
 enum Type {
     Unknown,
     NewOrder = 'N',
+    CancelOrder = 'C',
+    ReplaceOrder = 'M',
     Trade = 'X',
+    CancelAck = 'A',
+    ReplaceAck = 'K',
+    Reject = 'R',
+    SymbolDefinition = 'S',
+    JournalEntry = 'J',
+    Snapshot = 'H',
+    BookSnapshot = 'B',
+    RestingOrder = 'O',
+    LevelUpdate = 'L',
+    OrderUpdate = 'U',
 };
 
 constexpr const char *ToString(Type type) {
     switch (type) {
         case Type::NewOrder:
             return "NewOrder";
+        case Type::CancelOrder:
+            return "CancelOrder";
+        case Type::ReplaceOrder:
+            return "ReplaceOrder";
         case Type::Trade:
             return "Trade";
+        case Type::CancelAck:
+            return "CancelAck";
+        case Type::ReplaceAck:
+            return "ReplaceAck";
+        case Type::Reject:
+            return "Reject";
+        case Type::SymbolDefinition:
+            return "SymbolDefinition";
+        case Type::JournalEntry:
+            return "JournalEntry";
+        case Type::Snapshot:
+            return "Snapshot";
+        case Type::BookSnapshot:
+            return "BookSnapshot";
+        case Type::RestingOrder:
+            return "RestingOrder";
+        case Type::LevelUpdate:
+            return "LevelUpdate";
+        case Type::OrderUpdate:
+            return "OrderUpdate";
         case Type::Unknown:
             [[fallthrough]];
         default:
@@ -29,31 +66,149 @@ constexpr const char *ToString(Type type) {
 inline Type FromString(const std::string &str) {
     if (str == "NewOrder") {
         return Type::NewOrder;
+    } else if (str == "CancelOrder") {
+        return Type::CancelOrder;
+    } else if (str == "ReplaceOrder") {
+        return Type::ReplaceOrder;
     } else if (str == "Trade") {
         return Type::Trade;
+    } else if (str == "CancelAck") {
+        return Type::CancelAck;
+    } else if (str == "ReplaceAck") {
+        return Type::ReplaceAck;
+    } else if (str == "Reject") {
+        return Type::Reject;
+    } else if (str == "SymbolDefinition") {
+        return Type::SymbolDefinition;
+    } else if (str == "JournalEntry") {
+        return Type::JournalEntry;
+    } else if (str == "Snapshot") {
+        return Type::Snapshot;
+    } else if (str == "BookSnapshot") {
+        return Type::BookSnapshot;
+    } else if (str == "RestingOrder") {
+        return Type::RestingOrder;
+    } else if (str == "LevelUpdate") {
+        return Type::LevelUpdate;
+    } else if (str == "OrderUpdate") {
+        return Type::OrderUpdate;
     }
     return Type::Unknown;
 }
 }  // namespace MessageTypeEnum
 
+namespace RejectReasonEnum {
+enum Type {
+    None,
+    UnknownOrder = 'U',
+    DuplicateOrderId = 'D',
+    PriceNotHeld = 'P',
+    BookFull = 'F',
+    InvalidQuantity = 'Q',
+    // a fill or kill order for more than is resting at its price or better
+    InsufficientQuantity = 'I',
+    // the message could not be written to the journal, so it was not matched
+    JournalFailed = 'J',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::None:
+            return "NONE";
+        case Type::UnknownOrder:
+            return "UNKNOWN_ORDER";
+        case Type::DuplicateOrderId:
+            return "DUPLICATE_ORDER_ID";
+        case Type::PriceNotHeld:
+            return "PRICE_NOT_HELD";
+        case Type::BookFull:
+            return "BOOK_FULL";
+        case Type::InvalidQuantity:
+            return "INVALID_QUANTITY";
+        case Type::InsufficientQuantity:
+            return "INSUFFICIENT_QUANTITY";
+        case Type::JournalFailed:
+            return "JOURNAL_FAILED";
+        default:
+            return "<UNKNOWN>";
+    }
+}
+}  // namespace RejectReasonEnum
+
+// what happened to a resting order, see OrderUpdate
+namespace OrderUpdateTypeEnum {
+enum Type {
+    Unknown,
+    // the order now rests with quantity at its price
+    Add = 'A',
+    // quantity of the order traded, it leaves the book if that was all of it
+    Fill = 'F',
+    // an amendment took quantity off the order, which keeps its place
+    Reduce = 'R',
+    // the order left the book without trading what was left of it, quantity
+    Delete = 'D',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::Add:
+            return "ADD";
+        case Type::Fill:
+            return "FILL";
+        case Type::Reduce:
+            return "REDUCE";
+        case Type::Delete:
+            return "DELETE";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+}
+}  // namespace OrderUpdateTypeEnum
+
 struct MessageHeader {
     MessageTypeEnum::Type messageType = MessageTypeEnum::Unknown;
 };
 
+// price is ignored for a market order
 struct NewOrder : MessageHeader {
-    std::string orderId;
-    std::string symbol;
+    OrderId orderId;
+    SymbolId symbol;
     SideEnum::Type side;
     unsigned long quantity;
     unsigned long price;
+    OrderTypeEnum::Type orderType = OrderTypeEnum::Limit;
+    TimeInForceEnum::Type timeInForce = TimeInForceEnum::GoodTillCancel;
 
     NewOrder() : MessageHeader{MessageTypeEnum::NewOrder} {}
 };
 
+struct CancelOrder : MessageHeader {
+    OrderId orderId;
+    SymbolId symbol;
+
+    CancelOrder() : MessageHeader{MessageTypeEnum::CancelOrder} {}
+};
+
+// amends the quantity and price of a resting order, the side cannot change
+//
+// quantity is the new open quantity. Reducing it at the same price keeps the
+// order's place in the queue, any other change loses priority as if the order
+// had been cancelled and entered again.
+struct ReplaceOrder : MessageHeader {
+    OrderId orderId;
+    SymbolId symbol;
+    unsigned long quantity;
+    unsigned long price;
+
+    ReplaceOrder() : MessageHeader{MessageTypeEnum::ReplaceOrder} {}
+};
+
 struct Trade : MessageHeader {
-    std::string symbol;
-    std::string orderId;
-    std::string contraOrderId;
+    SymbolId symbol;
+    OrderId orderId;
+    OrderId contraOrderId;
     unsigned long quantity;
     unsigned long price;
 
@@ -65,6 +220,70 @@ struct Trade : MessageHeader {
     }
 };
 
+// the resting order has been removed, or a new order that may not rest has
+// been matched as far as it can be; quantity is what was left of it
+struct CancelAck : MessageHeader {
+    SymbolId symbol;
+    OrderId orderId;
+    SideEnum::Type side;
+    unsigned long quantity;
+    unsigned long price;
+
+    CancelAck() : MessageHeader{MessageTypeEnum::CancelAck} {}
+};
+
+// the resting order has been amended, sent before any trades it causes
+struct ReplaceAck : MessageHeader {
+    SymbolId symbol;
+    OrderId orderId;
+    SideEnum::Type side;
+    unsigned long quantity;
+    unsigned long price;
+
+    ReplaceAck() : MessageHeader{MessageTypeEnum::ReplaceAck} {}
+};
+
+// an inbound message was not applied, the book is unchanged
+struct Reject : MessageHeader {
+    SymbolId symbol;
+    OrderId orderId;
+    MessageTypeEnum::Type rejectedMessageType;
+    RejectReasonEnum::Type reason;
+
+    Reject() : MessageHeader{MessageTypeEnum::Reject} {}
+};
+
+// market data: what is now resting at one price on one side of a book, sent
+// whenever that changes; quantity and numOrders are zero once the level is empty
+struct LevelUpdate : MessageHeader {
+    SymbolId symbol;
+    SideEnum::Type side;
+    unsigned long price;
+    unsigned long quantity;
+    unsigned long numOrders;
+
+    LevelUpdate() : MessageHeader{MessageTypeEnum::LevelUpdate} {}
+};
+
+// market data: one change to one resting order, sent for every order that
+// rests, trades, is amended down or leaves a book, so the books can be
+// rebuilt order by order (see BookBuilder)
+//
+// Orders are keyed by the sequence number they rest under, which is unique
+// across books; an amendment that loses priority is sent as a delete of the
+// order under its old sequence number and an add under the new one.
+struct OrderUpdate : MessageHeader {
+    OrderUpdateTypeEnum::Type updateType = OrderUpdateTypeEnum::Unknown;
+    SymbolId symbol;
+    unsigned long sequenceNumber;
+    OrderId orderId;
+    SideEnum::Type side;
+    unsigned long price;
+    unsigned long quantity;
+
+    OrderUpdate() : MessageHeader{MessageTypeEnum::OrderUpdate} {}
+};
+
 }  // namespace gemini
 
 #endif
@@ -1,6 +1,10 @@
 #ifndef MATCHING_ENGINE__ORDER_H
 #define MATCHING_ENGINE__ORDER_H
 
+#include <cstddef>
+#include <string>
+#include <string_view>
+
 #include "messages.h"
 
 namespace gemini {
@@ -16,21 +20,33 @@ class Order {
     Order &operator=(Order &&) = default;
 
     unsigned long SequenceNumber() const noexcept;
-    const std::string &OrderId() const noexcept;
-    const std::string &Symbol() const noexcept;
+    const gemini::OrderId &OrderId() const noexcept;
+    SymbolId Symbol() const noexcept;
     SideEnum::Type Side() const noexcept;
     unsigned long Price() const noexcept;
     unsigned long Quantity() const noexcept;
 
-    // only quantity may be changed, and then only by decreasing due to match
+    // quantity decreases due to match or an amendment that keeps priority
     void DecreaseQuantity(unsigned long value) noexcept;
 
-    std::string ToString() const;
+    // an amendment that loses priority, the order takes the sequence number
+    // of the replace message
+    void Replace(unsigned long sequenceNumber, unsigned long quantity, unsigned long price) noexcept;
+
+    // dump lines are a fixed size: the text is cut short to leave room for a
+    // terminating NUL and the rest of the line is NUL padded
+    static constexpr std::size_t DumpLineSize = 64;
+
+    // writes exactly DumpLineSize bytes, the output writer copies them as they are
+    void FormatDumpLine(std::string_view symbolName, char *line) const noexcept;
+
+    // symbol ids are only turned back into text at the output edge
+    std::string ToString(const std::string &symbolName) const;
 
    private:
     unsigned long m_sequenceNumber;
-    std::string m_orderId;
-    std::string m_symbol;
+    gemini::OrderId m_orderId;
+    SymbolId m_symbol;
     SideEnum::Type m_side;
     unsigned long m_price;
     unsigned long m_quantity;
@@ -1,63 +1,808 @@
 #ifndef MATCHING_ENGINE__ORDER_BOOK_H
 #define MATCHING_ENGINE__ORDER_BOOK_H
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
 #include <functional>
-#include <list>
-#include <map>
+#include <optional>
+#include <string>
+#include <type_traits>
 #include <vector>
 
+#include "book_side.h"
 #include "messages.h"
 #include "order.h"
-#include "price_level.h"
+#include "order_id_index.h"
+#include "order_pool.h"
+#include "top_of_book.h"
+#include "trade_buffer.h"
 
 namespace gemini {
 
-class OrderBook {
+struct OrderBookConfig {
+    BookTypeEnum::Type bookType = BookTypeEnum::Map;
+
+    // ladder only, prices must be on a tick boundary in the range
+    // [basePrice, basePrice + tickSize * numLevels)
+    unsigned long basePrice = 0;
+    unsigned long tickSize = 1;
+    unsigned long numLevels = 0;
+
+    // storage for resting orders
+    OrderPoolConfig pool;
+};
+
+// the default level listener, for books nobody takes market data from
+struct NoLevelUpdates {
+    void operator()(const LevelUpdate &) const noexcept {}
+};
+
+// An order book for a single symbol.
+//
+// The trades generated by each inbound order are collected in a trade buffer
+// and reported to a listener as one batch, any type callable as
+// listener(TradeSpan). The listener is a template parameter so the call can be
+// inlined into the matching path, see OrderBook below for the type-erased form.
+//
+// Each price level keeps the total quantity and number of orders resting on
+// it, and every change to them is reported to the level listener, callable as
+// levelListener(const LevelUpdate &), so market data can be published without
+// ever walking the book. A match reports each level it trades through once, as
+// it leaves it, before the trades are reported.
+//
+// A level listener that is also callable as levelListener(const OrderUpdate &)
+// is told of every change to a resting order as well, each just before the
+// level update it causes, so the book can be rebuilt order by order; for any
+// other listener the calls are compiled out.
+//
+// The best bid and offer and the last trade are kept in a TopOfBookCache,
+// brought up to date at the end of every call that changes the book, which
+// other threads may read at any time (see Top).
+template <typename Listener, typename LevelListener = NoLevelUpdates>
+class BasicOrderBook {
    public:
-    using OrderMatchedFn = std::function<void(const Trade &)>;
+    BasicOrderBook(SymbolId symbol, Listener listener);
+    BasicOrderBook(SymbolId symbol, const OrderBookConfig &config, Listener listener);
 
-    OrderBook(std::string symbol, OrderMatchedFn fn);
+    // trades are written into a buffer owned by the caller, which may be shared
+    // by several books as long as they are only used from one thread
+    BasicOrderBook(SymbolId symbol, const OrderBookConfig &config, TradeBuffer &trades, Listener listener,
+                   LevelListener levelListener = LevelListener());
 
-    // may result in matches, will call the callback for each match
-    void AddOrder(Order order);
+    ~BasicOrderBook();
 
-    // no cancel message, so no need for a CancelOrder
+    // resting orders point into the pool, so the book cannot be moved
+    BasicOrderBook(const BasicOrderBook &) = delete;
+    BasicOrderBook &operator=(const BasicOrderBook &) = delete;
 
-    std::vector<std::string> Dump() const;
+    // may result in matches, will call the listener once with all of them
+    //
+    // returns the reason, without matching, if the order's price cannot be held
+    // by this book, its id is already resting or there is no room left in the
+    // order pool, otherwise RejectReasonEnum::None
+    RejectReasonEnum::Type AddOrder(Order order);
 
-   private:
-    std::string m_symbol;
+    // as above for an order of any type and time in force
+    //
+    // Market orders trade at any price, and neither they nor immediate or
+    // cancel orders ever rest: whatever is left of them once matched is passed
+    // to unfilled(const Order &) instead. A fill or kill order is only matched
+    // if enough is resting at its price or better to fill all of it, which is
+    // found from the level totals without touching any order, and is otherwise
+    // rejected with RejectReasonEnum::InsufficientQuantity. Orders that do not
+    // rest are matched where they are, without a node from the pool.
+    template <typename UnfilledFn>
+    RejectReasonEnum::Type AddOrder(Order order, OrderTypeEnum::Type orderType, TimeInForceEnum::Type timeInForce,
+                                    UnfilledFn &&unfilled);
 
-    OrderMatchedFn m_orderMatched;
+    // removes the resting order with this id and returns it as it was on the
+    // book, std::nullopt if there is none
+    std::optional<Order> CancelOrder(const OrderId &orderId);
 
-    // primary index is by price time
+    // amends the resting order with this id, see ReplaceOrder in messages.h
     //
-    // std::multimap has the requirement that subsequent insertions
-    // at the same key are sorted in insertion order, so no need to
-    // track the time manually since order modifications are not supported
-    using PriceLevelIndex = std::multimap<PriceLevel, Order>;
-    using OrderIterator = PriceLevelIndex::iterator;
+    // once the amendment is accepted replaced(const Order &) is called with the
+    // amended order, before any matches caused by the new price. Returns the
+    // reason the book is left unchanged, otherwise RejectReasonEnum::None
+    template <typename ReplacedFn>
+    RejectReasonEnum::Type ReplaceOrder(const OrderId &orderId, unsigned long quantity, unsigned long price,
+                                        unsigned long sequenceNumber, ReplacedFn &&replaced);
 
-    using SequenceNumberIndex = std::map<unsigned long, OrderIterator>;
+    // rests an order as it was on a book before, without matching it, for
+    // rebuilding a book from a snapshot
+    //
+    // Orders must come in sequence number order on each side, which is also
+    // their order within each price level, so the book ends up in exactly the
+    // price-time priority it was saved in. Returns false, leaving the book
+    // unchanged, if the order could not have been resting here: its price is
+    // not held, it would cross the other side, it is out of sequence, its id is
+    // already resting or there is no room left in the order pool. Nothing is
+    // reported to the level listener, the book is only put back as it was.
+    bool RestoreOrder(Order order);
 
-    struct Indexes {
-        PriceLevelIndex &byPriceLevel;
-        SequenceNumberIndex &bySequenceNumber;
-    };
+    // returns the resting order with this id, nullptr if there is none
+    const Order *FindOrder(const OrderId &orderId) const noexcept;
+
+    std::size_t NumOrders() const noexcept;
+
+    // what is resting at a price on one side
+    LevelTotals Level(SideEnum::Type side, unsigned long price) const;
+
+    // the total quantity resting on one side at price or better
+    //
+    // This and PriceToFill are O(log levels) on a ladder book, which keeps a
+    // running total over its levels, and walk the price levels (never the
+    // orders) on a map book.
+    unsigned long QuantityThrough(SideEnum::Type side, unsigned long price) const;
+
+    // the worst price an order taking quantity from one side would trade at,
+    // std::nullopt if less than that is resting
+    std::optional<unsigned long> PriceToFill(SideEnum::Type side, unsigned long quantity) const;
+
+    // calls fn(const Order &) for each resting order, asks before bids and each
+    // side in sequence number order
+    template <typename Fn>
+    void ForEachOrder(Fn &&fn) const;
+
+    std::vector<std::string> Dump(const std::string &symbolName) const;
+
+    const OrderPool &Pool() const noexcept;
+
+    const OrderBookConfig &Config() const noexcept;
+
+    // the only part of the book that is safe to read from another thread while
+    // the book is in use, the reference is good for the life of the book
+    const TopOfBookCache &Top() const noexcept;
+
+   private:
+    SymbolId m_symbol;
+
+    OrderBookConfig m_config;
+
+    Listener m_orderMatched;
+
+    LevelListener m_levelChanged;
+
+    // only used if the caller did not provide a trade buffer
+    TradeBuffer m_ownTrades;
+
+    TradeBuffer &m_trades;
+
+    bool CanHold(unsigned long price) const noexcept;
+
+    // matches a node that is not on the book, resting whatever is left
+    void MatchOrder(OrderNode *node);
+
+    // the side of the inbound order is known once here, so every price
+    // comparison below is resolved at compile time
+    template <typename SameSide, typename ContraSide>
+    void MatchOrder(OrderNode *node, SameSide &sameSide, ContraSide &contraSide);
+
+    // matches an order that will not rest, see AddOrder
+    template <typename ContraSide>
+    RejectReasonEnum::Type MatchImmediate(Order &order, OrderTypeEnum::Type orderType,
+                                          TimeInForceEnum::Type timeInForce, ContraSide &contraSide);
+
+    // trades the order against resting orders at limitPrice or better and
+    // reports the trades, if any
+    template <typename ContraSide>
+    void Match(Order &inboundOrder, unsigned long limitPrice, ContraSide &contraSide);
+
+    // appends to m_trades
+    template <typename ContraSide>
+    void GenerateTrades(Order &inboundOrder, unsigned long limitPrice, ContraSide &contraSide);
 
-    Indexes GetIndexesForSide(SideEnum::Type side) noexcept;
+    template <typename SameSide, typename ContraSide>
+    bool RestoreOrder(Order order, SameSide &sameSide, ContraSide &contraSide);
 
-    bool OrdersMatch(const Order &inboundOrder, const Order &restingOrder);
-    std::vector<Trade> GenerateTrades(Order &inboundOrder);
+    // unlinks a resting order from its side, the node is left to the caller
+    void RemoveOrder(OrderNode *node);
 
-    // primary (owned) storage for orders
-    PriceLevelIndex m_bids;
-    PriceLevelIndex m_asks;
+    // of a resting order, which keeps its place in the queue
+    void DecreaseQuantity(OrderNode *node, unsigned long quantity);
 
-    // other indexes reference the primary storage
-    SequenceNumberIndex m_bidsBySequenceNumber;
-    SequenceNumberIndex m_asksBySequenceNumber;
+    void PublishLevel(SideEnum::Type side, unsigned long price, const LevelTotals &totals);
+
+    // quantity is what the update says it is, see OrderUpdateTypeEnum
+    void PublishOrder(OrderUpdateTypeEnum::Type updateType, const Order &order, unsigned long quantity);
+
+    // publishes the top of book if it is not as last published
+    void UpdateTopOfBook();
+
+    template <typename Bids, typename Asks>
+    void UpdateTopOfBook(Bids &bids, Asks &asks);
+
+    void ReleaseOrders(const SequenceList &orders) noexcept;
+
+    // primary (owned) storage for orders, the sides only link the nodes
+    OrderPool m_pool;
+
+    // resting orders by client order id
+    OrderIdIndex m_byOrderId;
+
+    // only the pair of sides selected by m_config.bookType is used
+    MapBookSide<SideEnum::Buy> m_bids;
+    MapBookSide<SideEnum::Sell> m_asks;
+
+    LadderBookSide<SideEnum::Buy> m_bidLadder;
+    LadderBookSide<SideEnum::Sell> m_askLadder;
+
+    // of the last trade, for the top of book
+    unsigned long m_lastTradePrice;
+    unsigned long m_lastTradeQuantity;
+
+    // as last published to m_topOfBook, only touched by the matching thread
+    TopOfBook m_top;
+
+    // on a line of its own so readers polling it do not share the one the
+    // matching thread writes everything else to
+    TopOfBookCache m_topOfBook;
 };
+
+// type-erased convenience form, for callers that do not need the matching path inlined
+using OrderBook = BasicOrderBook<std::function<void(TradeSpan)>>;
+
+template <typename Listener, typename LevelListener>
+BasicOrderBook<Listener, LevelListener>::BasicOrderBook(SymbolId symbol, Listener listener)
+    : BasicOrderBook(symbol, OrderBookConfig{}, std::move(listener)) {}
+
+template <typename Listener, typename LevelListener>
+BasicOrderBook<Listener, LevelListener>::BasicOrderBook(SymbolId symbol, const OrderBookConfig &config,
+                                                        Listener listener)
+    : BasicOrderBook(symbol, config, m_ownTrades, std::move(listener)) {}
+
+template <typename Listener, typename LevelListener>
+BasicOrderBook<Listener, LevelListener>::BasicOrderBook(SymbolId symbol, const OrderBookConfig &config,
+                                                        TradeBuffer &trades, Listener listener,
+                                                        LevelListener levelListener)
+    : m_symbol(symbol),
+      m_config(config),
+      m_orderMatched(std::move(listener)),
+      m_levelChanged(std::move(levelListener)),
+      m_trades(trades),
+      m_pool(config.pool),
+      m_byOrderId(config.pool.initialCapacity),
+      m_bidLadder(config.basePrice, config.tickSize, config.bookType == BookTypeEnum::Ladder ? config.numLevels : 0),
+      m_askLadder(config.basePrice, config.tickSize, config.bookType == BookTypeEnum::Ladder ? config.numLevels : 0),
+      m_lastTradePrice(0),
+      m_lastTradeQuantity(0) {}
+
+template <typename Listener, typename LevelListener>
+BasicOrderBook<Listener, LevelListener>::~BasicOrderBook() {
+    ReleaseOrders(m_bids.BySequenceNumber());
+    ReleaseOrders(m_asks.BySequenceNumber());
+    ReleaseOrders(m_bidLadder.BySequenceNumber());
+    ReleaseOrders(m_askLadder.BySequenceNumber());
+}
+
+template <typename Listener, typename LevelListener>
+RejectReasonEnum::Type BasicOrderBook<Listener, LevelListener>::AddOrder(Order order) {
+    if (!CanHold(order.Price())) {
+        return RejectReasonEnum::PriceNotHeld;
+    }
+    if (m_byOrderId.Find(order.OrderId()) != nullptr) {
+        return RejectReasonEnum::DuplicateOrderId;
+    }
+
+    // the inbound order is matched from the node it will rest in, so a full
+    // pool is found out before any trades are generated
+    auto *node = m_pool.Allocate(std::move(order));
+    if (node == nullptr) {
+        return RejectReasonEnum::BookFull;
+    }
+
+    MatchOrder(node);
+    UpdateTopOfBook();
+
+    return RejectReasonEnum::None;
+}
+
+template <typename Listener, typename LevelListener>
+template <typename UnfilledFn>
+RejectReasonEnum::Type BasicOrderBook<Listener, LevelListener>::AddOrder(Order order, OrderTypeEnum::Type orderType,
+                                                                         TimeInForceEnum::Type timeInForce,
+                                                                         UnfilledFn &&unfilled) {
+    assert(orderType != OrderTypeEnum::Unknown && timeInForce != TimeInForceEnum::Unknown);
+
+    if (orderType == OrderTypeEnum::Limit && timeInForce == TimeInForceEnum::GoodTillCancel) {
+        return AddOrder(std::move(order));
+    }
+
+    // a market order has no price to hold
+    if (orderType == OrderTypeEnum::Limit && !CanHold(order.Price())) {
+        return RejectReasonEnum::PriceNotHeld;
+    }
+    if (m_byOrderId.Find(order.OrderId()) != nullptr) {
+        return RejectReasonEnum::DuplicateOrderId;
+    }
+
+    RejectReasonEnum::Type reason;
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        if (order.Side() == SideEnum::Buy) {
+            reason = MatchImmediate(order, orderType, timeInForce, m_askLadder);
+        } else {
+            reason = MatchImmediate(order, orderType, timeInForce, m_bidLadder);
+        }
+    } else {
+        if (order.Side() == SideEnum::Buy) {
+            reason = MatchImmediate(order, orderType, timeInForce, m_asks);
+        } else {
+            reason = MatchImmediate(order, orderType, timeInForce, m_bids);
+        }
+    }
+
+    if (reason != RejectReasonEnum::None) {
+        return reason;
+    }
+
+    UpdateTopOfBook();
+    if (order.Quantity() > 0) {
+        unfilled(static_cast<const Order &>(order));
+    }
+    return RejectReasonEnum::None;
+}
+
+template <typename Listener, typename LevelListener>
+std::optional<Order> BasicOrderBook<Listener, LevelListener>::CancelOrder(const OrderId &orderId) {
+    auto *node = m_byOrderId.Find(orderId);
+    if (node == nullptr) {
+        return std::nullopt;
+    }
+
+    RemoveOrder(node);
+    m_byOrderId.Erase(orderId);
+    UpdateTopOfBook();
+
+    std::optional<Order> result{std::move(node->order)};
+    m_pool.Free(node);
+
+    return result;
+}
+
+template <typename Listener, typename LevelListener>
+template <typename ReplacedFn>
+RejectReasonEnum::Type BasicOrderBook<Listener, LevelListener>::ReplaceOrder(const OrderId &orderId,
+                                                                             unsigned long quantity,
+                                                                             unsigned long price,
+                                                                             unsigned long sequenceNumber,
+                                                                             ReplacedFn &&replaced) {
+    auto *node = m_byOrderId.Find(orderId);
+    if (node == nullptr) {
+        return RejectReasonEnum::UnknownOrder;
+    }
+    if (quantity == 0) {
+        return RejectReasonEnum::InvalidQuantity;
+    }
+    if (!CanHold(price)) {
+        return RejectReasonEnum::PriceNotHeld;
+    }
+
+    auto &order = node->order;
+
+    // less quantity at the same price is amended in place, keeping its queue
+    // position, and the same quantity changes nothing anyone else can see
+    if (price == order.Price() && quantity <= order.Quantity()) {
+        if (quantity < order.Quantity()) {
+            DecreaseQuantity(node, order.Quantity() - quantity);
+            UpdateTopOfBook();
+        }
+        replaced(order);
+        return RejectReasonEnum::None;
+    }
+
+    // anything else goes to the back of the queue at its new price, the node is
+    // reused so the amendment cannot fail after the order has left the book
+    RemoveOrder(node);
+    m_byOrderId.Erase(orderId);
+
+    order.Replace(sequenceNumber, quantity, price);
+    replaced(order);
+
+    MatchOrder(node);
+    UpdateTopOfBook();
+
+    return RejectReasonEnum::None;
+}
+
+template <typename Listener, typename LevelListener>
+bool BasicOrderBook<Listener, LevelListener>::RestoreOrder(Order order) {
+    if (!CanHold(order.Price()) || order.Quantity() == 0 || m_byOrderId.Find(order.OrderId()) != nullptr) {
+        return false;
+    }
+
+    bool restored;
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        if (order.Side() == SideEnum::Buy) {
+            restored = RestoreOrder(std::move(order), m_bidLadder, m_askLadder);
+        } else {
+            restored = RestoreOrder(std::move(order), m_askLadder, m_bidLadder);
+        }
+    } else {
+        if (order.Side() == SideEnum::Buy) {
+            restored = RestoreOrder(std::move(order), m_bids, m_asks);
+        } else {
+            restored = RestoreOrder(std::move(order), m_asks, m_bids);
+        }
+    }
+
+    if (restored) {
+        UpdateTopOfBook();
+    }
+    return restored;
+}
+
+template <typename Listener, typename LevelListener>
+template <typename SameSide, typename ContraSide>
+bool BasicOrderBook<Listener, LevelListener>::RestoreOrder(Order order, SameSide &sameSide, ContraSide &contraSide) {
+    using Traits = SideTraits<ContraSide::Side>;
+
+    // an order the other side could match would not have been left resting
+    auto *best = contraSide.Best();
+    if (best != nullptr && Traits::IsAtOrBetter(best->order.Price(), order.Price())) {
+        return false;
+    }
+
+    // each level is a subsequence of the side's sequence list, so appending in
+    // sequence order keeps both in order
+    auto *last = sameSide.BySequenceNumber().Back();
+    if (last != nullptr && last->order.SequenceNumber() >= order.SequenceNumber()) {
+        return false;
+    }
+
+    auto *node = m_pool.Allocate(std::move(order));
+    if (node == nullptr) {
+        return false;
+    }
+
+    sameSide.Insert(node);
+    m_byOrderId.Insert(node->order.OrderId(), node);
+    return true;
+}
+
+template <typename Listener, typename LevelListener>
+template <typename Fn>
+void BasicOrderBook<Listener, LevelListener>::ForEachOrder(Fn &&fn) const {
+    auto visitSide = [&](const SequenceList &orders) {
+        for (auto *node = orders.Front(); node != nullptr; node = SequenceList::Next(node)) {
+            fn(static_cast<const Order &>(node->order));
+        }
+    };
+
+    // visit orders in sequence order, asks before bids
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        visitSide(m_askLadder.BySequenceNumber());
+        visitSide(m_bidLadder.BySequenceNumber());
+    } else {
+        visitSide(m_asks.BySequenceNumber());
+        visitSide(m_bids.BySequenceNumber());
+    }
+}
+
+template <typename Listener, typename LevelListener>
+std::vector<std::string> BasicOrderBook<Listener, LevelListener>::Dump(const std::string &symbolName) const {
+    std::vector<std::string> result;
+
+    ForEachOrder([&](const Order &order) { result.push_back(order.ToString(symbolName)); });
+
+    return result;
+}
+
+template <typename Listener, typename LevelListener>
+const Order *BasicOrderBook<Listener, LevelListener>::FindOrder(const OrderId &orderId) const noexcept {
+    auto *node = m_byOrderId.Find(orderId);
+    if (node == nullptr) {
+        return nullptr;
+    }
+    return &node->order;
+}
+
+template <typename Listener, typename LevelListener>
+std::size_t BasicOrderBook<Listener, LevelListener>::NumOrders() const noexcept {
+    return m_byOrderId.Size();
+}
+
+template <typename Listener, typename LevelListener>
+LevelTotals BasicOrderBook<Listener, LevelListener>::Level(SideEnum::Type side, unsigned long price) const {
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        return side == SideEnum::Buy ? m_bidLadder.Totals(price) : m_askLadder.Totals(price);
+    }
+    return side == SideEnum::Buy ? m_bids.Totals(price) : m_asks.Totals(price);
+}
+
+template <typename Listener, typename LevelListener>
+unsigned long BasicOrderBook<Listener, LevelListener>::QuantityThrough(SideEnum::Type side, unsigned long price) const {
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        return side == SideEnum::Buy ? m_bidLadder.QuantityThrough(price) : m_askLadder.QuantityThrough(price);
+    }
+    return side == SideEnum::Buy ? m_bids.QuantityThrough(price) : m_asks.QuantityThrough(price);
+}
+
+template <typename Listener, typename LevelListener>
+std::optional<unsigned long> BasicOrderBook<Listener, LevelListener>::PriceToFill(SideEnum::Type side,
+                                                                                  unsigned long quantity) const {
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        return side == SideEnum::Buy ? m_bidLadder.PriceToFill(quantity) : m_askLadder.PriceToFill(quantity);
+    }
+    return side == SideEnum::Buy ? m_bids.PriceToFill(quantity) : m_asks.PriceToFill(quantity);
+}
+
+template <typename Listener, typename LevelListener>
+const OrderPool &BasicOrderBook<Listener, LevelListener>::Pool() const noexcept {
+    return m_pool;
+}
+
+template <typename Listener, typename LevelListener>
+const OrderBookConfig &BasicOrderBook<Listener, LevelListener>::Config() const noexcept {
+    return m_config;
+}
+
+template <typename Listener, typename LevelListener>
+const TopOfBookCache &BasicOrderBook<Listener, LevelListener>::Top() const noexcept {
+    return m_topOfBook;
+}
+
+template <typename Listener, typename LevelListener>
+bool BasicOrderBook<Listener, LevelListener>::CanHold(unsigned long price) const noexcept {
+    // both ladders cover the same prices
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        return m_bidLadder.CanHold(price);
+    }
+    return true;
+}
+
+template <typename Listener, typename LevelListener>
+void BasicOrderBook<Listener, LevelListener>::MatchOrder(OrderNode *node) {
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        if (node->order.Side() == SideEnum::Buy) {
+            MatchOrder(node, m_bidLadder, m_askLadder);
+        } else {
+            MatchOrder(node, m_askLadder, m_bidLadder);
+        }
+        return;
+    }
+
+    if (node->order.Side() == SideEnum::Buy) {
+        MatchOrder(node, m_bids, m_asks);
+    } else {
+        MatchOrder(node, m_asks, m_bids);
+    }
+}
+
+template <typename Listener, typename LevelListener>
+template <typename SameSide, typename ContraSide>
+void BasicOrderBook<Listener, LevelListener>::MatchOrder(OrderNode *node, SameSide &sameSide, ContraSide &contraSide) {
+    static_assert(ContraSide::Side == SideTraits<SameSide::Side>::Contra, "sides must be opposite");
+
+    Match(node->order, node->order.Price(), contraSide);
+
+    // if still quantity left, rest the order
+    if (node->order.Quantity() > 0) {
+        PublishOrder(OrderUpdateTypeEnum::Add, node->order, node->order.Quantity());
+        PublishLevel(SameSide::Side, node->order.Price(), sameSide.Insert(node));
+        m_byOrderId.Insert(node->order.OrderId(), node);
+    } else {
+        m_pool.Free(node);
+    }
+}
+
+template <typename Listener, typename LevelListener>
+template <typename ContraSide>
+RejectReasonEnum::Type BasicOrderBook<Listener, LevelListener>::MatchImmediate(Order &order,
+                                                                               OrderTypeEnum::Type orderType,
+                                                                               TimeInForceEnum::Type timeInForce,
+                                                                               ContraSide &contraSide) {
+    using Traits = SideTraits<SideTraits<ContraSide::Side>::Contra>;
+
+    auto limitPrice = orderType == OrderTypeEnum::Market ? Traits::MarketPrice : order.Price();
+
+    // nothing is matched unless all of it can be, so there is never a sweep
+    // to undo
+    if (timeInForce == TimeInForceEnum::FillOrKill && order.Quantity() > 0) {
+        auto fillPrice = contraSide.PriceToFill(order.Quantity());
+        if (!fillPrice || !SideTraits<ContraSide::Side>::IsAtOrBetter(*fillPrice, limitPrice)) {
+            return RejectReasonEnum::InsufficientQuantity;
+        }
+    }
+
+    Match(order, limitPrice, contraSide);
+    return RejectReasonEnum::None;
+}
+
+template <typename Listener, typename LevelListener>
+template <typename ContraSide>
+void BasicOrderBook<Listener, LevelListener>::Match(Order &inboundOrder, unsigned long limitPrice,
+                                                    ContraSide &contraSide) {
+    // generate matches
+    m_trades.Clear();
+    GenerateTrades(inboundOrder, limitPrice, contraSide);
+
+    // report the trades
+    if (!m_trades.Empty()) {
+        m_orderMatched(m_trades.View());
+    }
+}
+
+template <typename Listener, typename LevelListener>
+template <typename ContraSide>
+void BasicOrderBook<Listener, LevelListener>::GenerateTrades(Order &inboundOrder, unsigned long limitPrice,
+                                                             ContraSide &contraSide) {
+    using Traits = SideTraits<ContraSide::Side>;
+
+    // run until we hit an order that doesn't match, resting orders match while
+    // their price is at or better than the limit price from their own side
+    auto *restingNode = contraSide.Best();
+    while (restingNode != nullptr && Traits::IsAtOrBetter(restingNode->order.Price(), limitPrice)) {
+        auto *restingOrder = &restingNode->order;
+
+        // calculate traded quantity
+        auto tradeQuantity = std::min(inboundOrder.Quantity(), restingOrder->Quantity());
+        auto tradePrice = restingOrder->Price();
+
+        auto &trade = m_trades.Append();
+
+        trade.symbol = m_symbol;
+        trade.orderId = inboundOrder.OrderId();
+        trade.contraOrderId = restingOrder->OrderId();
+        trade.quantity = tradeQuantity;
+        trade.price = tradePrice;
+
+        m_lastTradePrice = tradePrice;
+        m_lastTradeQuantity = tradeQuantity;
+
+        PublishOrder(OrderUpdateTypeEnum::Fill, *restingOrder, tradeQuantity);
+
+        // adjust quantity on each order, unlinking the resting order and
+        // recycling its node if fully filled, the next best order is only
+        // looked up afterwards so there is nothing to preserve
+        inboundOrder.DecreaseQuantity(tradeQuantity);
+        if (tradeQuantity == restingOrder->Quantity()) {
+            m_byOrderId.Erase(restingOrder->OrderId());
+            m_pool.Free(contraSide.PopBest());
+        } else {
+            contraSide.DecreaseBest(tradeQuantity);
+        }
+
+        restingNode = contraSide.Best();
+
+        // each level is reported once, as the order leaves it or runs out
+        auto levelLeft = restingNode == nullptr || restingNode->order.Price() != tradePrice;
+        if (levelLeft || inboundOrder.Quantity() == 0) {
+            PublishLevel(ContraSide::Side, tradePrice, levelLeft ? LevelTotals{} : contraSide.BestTotals());
+        }
+
+        // break if no more quantity on inbound order
+        if (inboundOrder.Quantity() == 0) {
+            break;
+        }
+    }
+}
+
+template <typename Listener, typename LevelListener>
+void BasicOrderBook<Listener, LevelListener>::RemoveOrder(OrderNode *node) {
+    auto side = node->order.Side();
+    PublishOrder(OrderUpdateTypeEnum::Delete, node->order, node->order.Quantity());
+
+    LevelTotals totals;
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        if (side == SideEnum::Buy) {
+            totals = m_bidLadder.Remove(node);
+        } else {
+            totals = m_askLadder.Remove(node);
+        }
+    } else {
+        if (side == SideEnum::Buy) {
+            totals = m_bids.Remove(node);
+        } else {
+            totals = m_asks.Remove(node);
+        }
+    }
+
+    PublishLevel(side, node->order.Price(), totals);
+}
+
+template <typename Listener, typename LevelListener>
+void BasicOrderBook<Listener, LevelListener>::DecreaseQuantity(OrderNode *node, unsigned long quantity) {
+    auto side = node->order.Side();
+    PublishOrder(OrderUpdateTypeEnum::Reduce, node->order, quantity);
+
+    LevelTotals totals;
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        if (side == SideEnum::Buy) {
+            totals = m_bidLadder.DecreaseQuantity(node, quantity);
+        } else {
+            totals = m_askLadder.DecreaseQuantity(node, quantity);
+        }
+    } else {
+        if (side == SideEnum::Buy) {
+            totals = m_bids.DecreaseQuantity(node, quantity);
+        } else {
+            totals = m_asks.DecreaseQuantity(node, quantity);
+        }
+    }
+
+    PublishLevel(side, node->order.Price(), totals);
+}
+
+template <typename Listener, typename LevelListener>
+void BasicOrderBook<Listener, LevelListener>::PublishLevel(SideEnum::Type side, unsigned long price,
+                                                          const LevelTotals &totals) {
+    LevelUpdate update;
+
+    update.symbol = m_symbol;
+    update.side = side;
+    update.price = price;
+    update.quantity = totals.quantity;
+    update.numOrders = totals.numOrders;
+
+    m_levelChanged(update);
+}
+
+template <typename Listener, typename LevelListener>
+void BasicOrderBook<Listener, LevelListener>::PublishOrder(OrderUpdateTypeEnum::Type updateType, const Order &order,
+                                                          unsigned long quantity) {
+    if constexpr (std::is_invocable_v<LevelListener &, const OrderUpdate &>) {
+        OrderUpdate update;
+
+        update.updateType = updateType;
+        update.symbol = m_symbol;
+        update.sequenceNumber = order.SequenceNumber();
+        update.orderId = order.OrderId();
+        update.side = order.Side();
+        update.price = order.Price();
+        update.quantity = quantity;
+
+        m_levelChanged(update);
+    }
+}
+
+template <typename Listener, typename LevelListener>
+void BasicOrderBook<Listener, LevelListener>::UpdateTopOfBook() {
+    if (m_config.bookType == BookTypeEnum::Ladder) {
+        UpdateTopOfBook(m_bidLadder, m_askLadder);
+    } else {
+        UpdateTopOfBook(m_bids, m_asks);
+    }
+}
+
+template <typename Listener, typename LevelListener>
+template <typename Bids, typename Asks>
+void BasicOrderBook<Listener, LevelListener>::UpdateTopOfBook(Bids &bids, Asks &asks) {
+    TopOfBook top;
+
+    if (auto *bid = bids.Best()) {
+        top.bidPrice = bid->order.Price();
+        top.bidQuantity = bids.BestTotals().quantity;
+    }
+    if (auto *ask = asks.Best()) {
+        top.askPrice = ask->order.Price();
+        top.askQuantity = asks.BestTotals().quantity;
+    }
+    top.lastTradePrice = m_lastTradePrice;
+    top.lastTradeQuantity = m_lastTradeQuantity;
+
+    // most changes to a book are away from the top, which readers need not
+    // hear about
+    top.version = m_top.version;
+    if (top == m_top) {
+        return;
+    }
+
+    top.version++;
+    m_top = top;
+    m_topOfBook.Publish(top);
+}
+
+template <typename Listener, typename LevelListener>
+void BasicOrderBook<Listener, LevelListener>::ReleaseOrders(const SequenceList &orders) noexcept {
+    auto *node = orders.Front();
+    while (node != nullptr) {
+        auto *next = SequenceList::Next(node);
+        m_pool.Free(node);
+        node = next;
+    }
+}
+
 }  // namespace gemini
 
 #endif  // MATCHING_ENGINE__ORDER_BOOK_H
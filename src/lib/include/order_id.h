@@ -0,0 +1,68 @@
+#ifndef MATCHING_ENGINE__ORDER_ID_H
+#define MATCHING_ENGINE__ORDER_ID_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace gemini {
+
+// client order id stored inline, so copying one never touches the heap
+//
+// Ids hold up to 15 characters. The unused bytes are always zero and the last
+// byte holds the length, which lets comparison and hashing work on the whole
+// 16 bytes as two machine words.
+class OrderId {
+   public:
+    static constexpr std::size_t Capacity = 15;
+
+    OrderId() noexcept : m_bytes{} {}
+
+    // the id must fit, see Fits
+    explicit OrderId(std::string_view str) noexcept : m_bytes{} {
+        assert(Fits(str));
+        auto size = str.size() < Capacity ? str.size() : Capacity;
+        std::memcpy(m_bytes, str.data(), size);
+        m_bytes[Capacity] = static_cast<char>(size);
+    }
+
+    static constexpr bool Fits(std::string_view str) noexcept { return str.size() <= Capacity; }
+
+    std::size_t Size() const noexcept { return static_cast<unsigned char>(m_bytes[Capacity]); }
+    bool Empty() const noexcept { return Size() == 0; }
+
+    const char *Data() const noexcept { return m_bytes; }
+    std::string_view View() const noexcept { return {m_bytes, Size()}; }
+
+    std::uint64_t Hash() const noexcept {
+        std::uint64_t lo;
+        std::uint64_t hi;
+        std::memcpy(&lo, m_bytes, sizeof(lo));
+        std::memcpy(&hi, m_bytes + sizeof(lo), sizeof(hi));
+
+        // combine, then the murmur3 finalizer so every input bit reaches the low bits
+        auto h = lo ^ (hi * 0x9E3779B97F4A7C15ull);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    inline bool operator==(const OrderId &rhs) const noexcept {
+        return std::memcmp(m_bytes, rhs.m_bytes, sizeof(m_bytes)) == 0;
+    }
+    inline bool operator!=(const OrderId &rhs) const noexcept { return !(*this == rhs); }
+
+   private:
+    char m_bytes[Capacity + 1];
+};
+
+static_assert(sizeof(OrderId) == 16, "OrderId must stay two words wide");
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__ORDER_ID_H
@@ -0,0 +1,50 @@
+#ifndef MATCHING_ENGINE__ORDER_ID_INDEX_H
+#define MATCHING_ENGINE__ORDER_ID_INDEX_H
+
+#include <cstddef>
+#include <vector>
+
+#include "order_id.h"
+#include "order_pool.h"
+
+namespace gemini {
+
+// open-addressing hash index from client order id to resting order node
+//
+// Linear probing over a power of two table kept at most half full. Erasing
+// shifts the following entries back instead of leaving tombstones, so lookups
+// never degrade as orders come and go.
+class OrderIdIndex {
+   public:
+    // sized so expectedSize entries fit without rehashing
+    explicit OrderIdIndex(std::size_t expectedSize);
+
+    // returns nullptr if the id is not in the index
+    OrderNode *Find(const OrderId &orderId) const noexcept;
+
+    // returns false if the id is already in the index
+    bool Insert(const OrderId &orderId, OrderNode *node);
+
+    // returns false if the id is not in the index
+    bool Erase(const OrderId &orderId) noexcept;
+
+    std::size_t Size() const noexcept;
+
+   private:
+    struct Slot {
+        OrderId orderId;
+        OrderNode *node = nullptr;  // nullptr when the slot is empty
+    };
+
+    std::size_t HomeSlot(const OrderId &orderId) const noexcept;
+    std::size_t FindSlot(const OrderId &orderId) const noexcept;
+    void Rehash(std::size_t capacity);
+
+    std::vector<Slot> m_slots;
+    std::size_t m_mask;
+    std::size_t m_size;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__ORDER_ID_INDEX_H
@@ -0,0 +1,65 @@
+#ifndef MATCHING_ENGINE__ORDER_LIST_H
+#define MATCHING_ENGINE__ORDER_LIST_H
+
+#include "order_pool.h"
+
+namespace gemini {
+
+// intrusive doubly-linked list of order nodes threaded through the given links
+//
+// The list never owns the nodes, so pushing and removing are O(1) and never
+// allocate. A node may be on several lists at once as long as each list uses a
+// different pair of links.
+template <OrderNode *OrderNode::*PrevLink, OrderNode *OrderNode::*NextLink>
+class OrderList {
+   public:
+    bool Empty() const noexcept { return m_head == nullptr; }
+
+    OrderNode *Front() const noexcept { return m_head; }
+    OrderNode *Back() const noexcept { return m_tail; }
+
+    static OrderNode *Next(const OrderNode *node) noexcept { return node->*NextLink; }
+
+    void PushBack(OrderNode *node) noexcept {
+        node->*PrevLink = m_tail;
+        node->*NextLink = nullptr;
+
+        if (m_tail != nullptr) {
+            m_tail->*NextLink = node;
+        } else {
+            m_head = node;
+        }
+        m_tail = node;
+    }
+
+    void Remove(OrderNode *node) noexcept {
+        if (node->*PrevLink != nullptr) {
+            node->*PrevLink->*NextLink = node->*NextLink;
+        } else {
+            m_head = node->*NextLink;
+        }
+
+        if (node->*NextLink != nullptr) {
+            node->*NextLink->*PrevLink = node->*PrevLink;
+        } else {
+            m_tail = node->*PrevLink;
+        }
+
+        node->*PrevLink = nullptr;
+        node->*NextLink = nullptr;
+    }
+
+   private:
+    OrderNode *m_head = nullptr;
+    OrderNode *m_tail = nullptr;
+};
+
+// time priority within a price level
+using LevelQueue = OrderList<&OrderNode::prev, &OrderNode::next>;
+
+// sequence number order across a side of the book
+using SequenceList = OrderList<&OrderNode::seqPrev, &OrderNode::seqNext>;
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__ORDER_LIST_H
@@ -0,0 +1,79 @@
+#ifndef MATCHING_ENGINE__ORDER_POOL_H
+#define MATCHING_ENGINE__ORDER_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "order.h"
+
+namespace gemini {
+
+// a resting order along with the intrusive links for the lists it is on
+struct OrderNode {
+    Order order;
+
+    // FIFO of orders at the same price level
+    OrderNode *prev = nullptr;
+    OrderNode *next = nullptr;
+
+    // orders on the same side of the book by sequence number
+    OrderNode *seqPrev = nullptr;
+    OrderNode *seqNext = nullptr;
+
+    explicit OrderNode(Order o) : order(std::move(o)) {}
+};
+
+struct OrderPoolConfig {
+    // number of nodes allocated up front
+    std::size_t initialCapacity = 1024;
+
+    // number of nodes added each time the pool runs out, 0 to never grow
+    std::size_t growBy = 1024;
+};
+
+// slab allocator for order nodes
+//
+// Nodes are carved out of large chunks and recycled through a free list, so
+// once the pool has grown to the working set no order touches malloc. Chunks
+// are only released when the pool is destroyed.
+class OrderPool {
+   public:
+    explicit OrderPool(const OrderPoolConfig &config);
+
+    // nodes are never moved once handed out
+    OrderPool(const OrderPool &) = delete;
+    OrderPool &operator=(const OrderPool &) = delete;
+
+    // returns nullptr if the pool is empty and cannot grow
+    OrderNode *Allocate(Order order);
+
+    void Free(OrderNode *node) noexcept;
+
+    std::size_t Capacity() const noexcept;
+    std::size_t InUse() const noexcept;
+
+    // largest number of nodes that have been in use at once
+    std::size_t HighWaterMark() const noexcept;
+
+   private:
+    union Slot {
+        Slot *nextFree;
+        alignas(OrderNode) unsigned char storage[sizeof(OrderNode)];
+    };
+
+    void Grow(std::size_t count);
+
+    OrderPoolConfig m_config;
+
+    std::vector<std::unique_ptr<Slot[]>> m_chunks;
+    Slot *m_freeList;
+
+    std::size_t m_capacity;
+    std::size_t m_inUse;
+    std::size_t m_highWaterMark;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__ORDER_POOL_H
@@ -0,0 +1,107 @@
+#ifndef MATCHING_ENGINE__OUTPUT_WRITER_H
+#define MATCHING_ENGINE__OUTPUT_WRITER_H
+
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include "messages.h"
+#include "order.h"
+
+namespace gemini {
+
+// formats outbound messages and dump lines straight into a reusable buffer
+//
+// Numbers are formatted with std::to_chars and the buffer is handed to the
+// descriptor with a single write(2) once it is full, when Flush is called and
+// when the writer is destroyed. The text is the same as the application has
+// always printed, see the Input Format in README.md.
+class OutputWriter {
+   public:
+    explicit OutputWriter(int fd, std::size_t capacity = DefaultCapacity);
+
+    // flushes whatever is left
+    ~OutputWriter();
+
+    OutputWriter(const OutputWriter &) = delete;
+    OutputWriter &operator=(const OutputWriter &) = delete;
+
+    void WriteTrade(std::string_view symbolName, const Trade &trade);
+    void WriteCancelAck(std::string_view symbolName, const CancelAck &ack);
+    void WriteReplaceAck(std::string_view symbolName, const ReplaceAck &ack);
+    void WriteReject(std::string_view symbolName, const Reject &reject);
+
+    // a dump line, Order::DumpLineSize bytes followed by a newline
+    void WriteOrder(std::string_view symbolName, const Order &order);
+
+    void Append(std::string_view text);
+    void Append(char c);
+    void AppendUnsigned(unsigned long value);
+
+    // hands everything buffered so far to the descriptor, returns false if the
+    // write failed, in which case the buffered output is dropped
+    bool Flush();
+
+    // bytes handed to the descriptor so far
+    unsigned long BytesWritten() const noexcept;
+
+   private:
+    static constexpr std::size_t DefaultCapacity = 1 << 20;
+
+    // the widest unsigned long in base 10
+    static constexpr std::size_t MaxDigits = 20;
+
+    // never smaller than a dump line, which is written in one piece
+    static constexpr std::size_t MinCapacity = Order::DumpLineSize + 1;
+
+    // makes room for size more bytes, flushing if they do not fit
+    void Reserve(std::size_t size);
+
+    // returns false if the descriptor did not take all of it
+    bool WriteAll(const char *data, std::size_t size);
+
+    int m_fd;
+
+    std::vector<char> m_buffer;
+    std::size_t m_used;
+
+    unsigned long m_bytesWritten;
+};
+
+inline void OutputWriter::Reserve(std::size_t size) {
+    if (m_buffer.size() - m_used < size) {
+        Flush();
+    }
+}
+
+inline void OutputWriter::Append(std::string_view text) {
+    Reserve(text.size());
+
+    // only text larger than the whole buffer is written through unbuffered
+    if (text.size() > m_buffer.size()) {
+        WriteAll(text.data(), text.size());
+        return;
+    }
+
+    std::memcpy(m_buffer.data() + m_used, text.data(), text.size());
+    m_used += text.size();
+}
+
+inline void OutputWriter::Append(char c) {
+    Reserve(1);
+    m_buffer[m_used++] = c;
+}
+
+inline void OutputWriter::AppendUnsigned(unsigned long value) {
+    Reserve(MaxDigits);
+
+    auto *begin = m_buffer.data() + m_used;
+    auto result = std::to_chars(begin, begin + MaxDigits, value);
+    m_used += static_cast<std::size_t>(result.ptr - begin);
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__OUTPUT_WRITER_H
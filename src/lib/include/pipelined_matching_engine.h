@@ -0,0 +1,438 @@
+#ifndef MATCHING_ENGINE__PIPELINED_MATCHING_ENGINE_H
+#define MATCHING_ENGINE__PIPELINED_MATCHING_ENGINE_H
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "cpu_affinity.h"
+#include "matching_engine.h"
+#include "messages.h"
+#include "spsc_queue.h"
+#include "symbol_registry.h"
+#include "trade_buffer.h"
+
+namespace gemini {
+
+// how busy one stage of a pipeline has been
+struct StageCounters {
+    using Duration = std::chrono::steady_clock::duration;
+
+    // records the stage has handled
+    unsigned long items = 0;
+
+    // times the stage had to wait for its neighbour, and for how long in total
+    unsigned long waits = 0;
+    Duration waited{};
+
+    // from the start of the stage to the last record it handled
+    Duration elapsed{};
+
+    // items per second of the time spent not waiting, what the stage could
+    // sustain on its own
+    double Rate() const noexcept {
+        auto busy = std::chrono::duration<double>(elapsed - waited).count();
+        return busy > 0 ? static_cast<double>(items) / busy : 0.0;
+    }
+};
+
+// each stage writes its own counters, so they are kept on separate lines
+struct PipelineStats {
+    alignas(CacheLineSize) StageCounters input;     // the thread calling OnMessage
+    alignas(CacheLineSize) StageCounters matching;  // messages through the engine
+    alignas(CacheLineSize) StageCounters output;    // outbound messages through the sink
+};
+
+struct PipelineConfig {
+    // pins the matching and output threads to these cpus, see PinCurrentThread
+    bool pinThreads = false;
+    unsigned matchingCpu = 1;
+    unsigned outputCpu = 2;
+
+    // records each queue between stages can hold
+    std::size_t queueCapacity = 4096;
+};
+
+// Matches on one thread and hands the output to the sink on another.
+//
+// The thread calling OnMessage (typically parsing input) passes each message
+// through a bounded single-producer/single-consumer queue to the matching
+// thread, which runs a BasicMatchingEngine and passes its output through a
+// second queue to the output thread, which calls the sink. The three stages
+// overlap, so the slowest of them sets the pace rather than their sum.
+//
+// The sink is called on the output thread with the name of the symbol and the
+// message, for each of Trade, CancelAck, ReplaceAck and Reject, in the same
+// order BasicMatchingEngine would produce them. The registry must keep each
+// name where it is once interned (SymbolRegistry never moves them), as the
+// other threads read names through pointers handed along with the messages.
+template <typename Sink>
+class PipelinedMatchingEngine {
+   public:
+    // the registry must only be changed from the thread calling OnMessage
+    PipelinedMatchingEngine(const SymbolRegistry &symbols, Sink sink, const PipelineConfig &config = {});
+
+    // passes on the output of every message so far, then stops both threads
+    ~PipelinedMatchingEngine();
+
+    PipelinedMatchingEngine(const PipelinedMatchingEngine &) = delete;
+    PipelinedMatchingEngine &operator=(const PipelinedMatchingEngine &) = delete;
+
+    // as BasicMatchingEngine, but only before the first message
+    bool ConfigureSymbol(SymbolId symbol, const OrderBookConfig &config);
+
+    // queues the message for matching, messages are handed over in batches so
+    // this may return before the matching thread has seen it
+    void OnMessage(const MessageHeader &msg);
+
+    // waits until the sink has been given the output of every message so far
+    //
+    // Once this returns the other threads are idle until the next message, so
+    // anything the sink writes to may be used from the calling thread.
+    void Flush();
+
+    // as BasicMatchingEngine, flushing first
+    template <typename Fn>
+    void ForEachOrder(Fn &&fn);
+
+    std::vector<std::string> Dump();
+
+    // counters for each stage, up to date as of the last Flush
+    const PipelineStats &Stats() const noexcept;
+
+   private:
+    using Clock = std::chrono::steady_clock;
+
+    // inbound messages handed to the matching thread in one go
+    static constexpr std::size_t InputBatch = 16;
+
+    // records a stage handles before freeing their slots
+    static constexpr std::size_t PopBatchSize = 64;
+
+    // tells the next stage to stop, it is the last record it will see
+    struct Stop {};
+
+    // every message up to this one has been through the stage
+    struct Checkpoint {
+        unsigned long sequenceNumber;
+    };
+
+    struct InboundRecord {
+        unsigned long sequenceNumber = 0;
+        const std::string *symbolName = nullptr;
+        std::variant<Stop, NewOrder, CancelOrder, ReplaceOrder> message;
+    };
+
+    using OutboundMessage = std::variant<Stop, Checkpoint, Trade, CancelAck, ReplaceAck, Reject>;
+
+    struct OutboundRecord {
+        const std::string *symbolName = nullptr;
+        OutboundMessage message;
+    };
+
+    // idle stages sleep until there is work
+    using InboundQueue = SpscQueue<InboundRecord, FutexWait>;
+    using OutboundQueue = SpscQueue<OutboundRecord, FutexWait>;
+
+    // stages a record, counting the time spent waiting if the queue is full
+    template <typename Queue, typename Record>
+    static void StageCounted(Queue &queue, const Record &record, StageCounters &counters);
+
+    // runs on the matching thread, stages the output of the message being
+    // matched so it is published along with the next checkpoint
+    struct MatchingSink {
+        PipelinedMatchingEngine *self;
+
+        void Stage(const OutboundMessage &message) const;
+
+        void operator()(TradeSpan trades) const {
+            for (auto const &trade : trades) {
+                Stage(trade);
+            }
+        }
+        void operator()(const CancelAck &ack) const { Stage(ack); }
+        void operator()(const ReplaceAck &ack) const { Stage(ack); }
+        void operator()(const Reject &reject) const { Stage(reject); }
+    };
+
+    static SymbolId SymbolOf(const MessageHeader &msg) noexcept;
+
+    // the matching and output threads, each handles records until told to stop
+    void RunMatching();
+    void RunOutput();
+
+    // passes an outbound message to the sink, or sets stopped
+    void Output(const OutboundRecord &record, bool &stopped);
+
+    const SymbolRegistry &m_symbols;
+
+    PipelineConfig m_config;
+
+    // only touched by the output thread while it runs
+    Sink m_sink;
+
+    InboundQueue m_inbound;
+    OutboundQueue m_outbound;
+
+    // only touched by the matching thread once a message has been sent
+    BasicMatchingEngine<MatchingSink> m_engine;
+
+    // the name of the symbol of the message being matched
+    const std::string *m_matchingSymbolName;
+
+    // sequence number of the last message sent, and of the last message the
+    // sink has had all the output of
+    unsigned long m_sequenceNumber;
+    alignas(CacheLineSize) std::atomic<unsigned long> m_outputSequenceNumber;
+
+    // each written by its own stage, read once the pipeline is flushed
+    PipelineStats m_stats;
+    Clock::time_point m_start;
+
+    std::thread m_matchingThread;
+    std::thread m_outputThread;
+};
+
+template <typename Sink>
+PipelinedMatchingEngine<Sink>::PipelinedMatchingEngine(const SymbolRegistry &symbols, Sink sink,
+                                                       const PipelineConfig &config)
+    : m_symbols(symbols),
+      m_config(config),
+      m_sink(std::move(sink)),
+      m_inbound(config.queueCapacity),
+      m_outbound(config.queueCapacity),
+      m_engine(symbols, MatchingSink{this}),
+      m_matchingSymbolName(nullptr),
+      m_sequenceNumber(0),
+      m_outputSequenceNumber(0),
+      m_start(Clock::now()) {
+    m_matchingThread = std::thread([this] { RunMatching(); });
+    m_outputThread = std::thread([this] { RunOutput(); });
+}
+
+template <typename Sink>
+PipelinedMatchingEngine<Sink>::~PipelinedMatchingEngine() {
+    Flush();
+
+    // the matching thread passes the stop on to the output thread
+    m_inbound.Push(InboundRecord{});
+    m_matchingThread.join();
+    m_outputThread.join();
+}
+
+template <typename Sink>
+bool PipelinedMatchingEngine<Sink>::ConfigureSymbol(SymbolId symbol, const OrderBookConfig &config) {
+    // the matching thread has not touched its engine yet, and will only do so
+    // after seeing a message pushed after this
+    assert(m_sequenceNumber == 0);
+
+    return m_engine.ConfigureSymbol(symbol, config);
+}
+
+template <typename Sink>
+void PipelinedMatchingEngine<Sink>::OnMessage(const MessageHeader &msg) {
+    InboundRecord record;
+
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            record.message = static_cast<const NewOrder &>(msg);
+            break;
+        case MessageTypeEnum::CancelOrder:
+            record.message = static_cast<const CancelOrder &>(msg);
+            break;
+        case MessageTypeEnum::ReplaceOrder:
+            record.message = static_cast<const ReplaceOrder &>(msg);
+            break;
+        default:
+            assert(!"Unexpected message type");
+            return;
+    }
+
+    // only sequenced once accepted, Flush waits for the output of every
+    // sequence number to come through
+    record.sequenceNumber = ++m_sequenceNumber;
+    record.symbolName = &m_symbols.Name(SymbolOf(msg));
+
+    StageCounted(m_inbound, record, m_stats.input);
+    m_stats.input.items++;
+
+    if (m_sequenceNumber % InputBatch == 0) {
+        m_inbound.Publish();
+    }
+}
+
+template <typename Sink>
+void PipelinedMatchingEngine<Sink>::Flush() {
+    m_inbound.Publish();
+
+    while (m_outputSequenceNumber.load(std::memory_order_acquire) != m_sequenceNumber) {
+        std::this_thread::yield();
+    }
+
+    m_stats.input.elapsed = Clock::now() - m_start;
+}
+
+template <typename Sink>
+template <typename Fn>
+void PipelinedMatchingEngine<Sink>::ForEachOrder(Fn &&fn) {
+    // once flushed the matching thread is idle, and everything it did happened
+    // before the output we have waited for
+    Flush();
+
+    m_engine.ForEachOrder(fn);
+}
+
+template <typename Sink>
+std::vector<std::string> PipelinedMatchingEngine<Sink>::Dump() {
+    Flush();
+
+    return m_engine.Dump();
+}
+
+template <typename Sink>
+const PipelineStats &PipelinedMatchingEngine<Sink>::Stats() const noexcept {
+    return m_stats;
+}
+
+template <typename Sink>
+template <typename Queue, typename Record>
+void PipelinedMatchingEngine<Sink>::StageCounted(Queue &queue, const Record &record, StageCounters &counters) {
+    if (queue.TryStage(record)) {
+        return;
+    }
+
+    auto start = Clock::now();
+    queue.Stage(record);
+    counters.waits++;
+    counters.waited += Clock::now() - start;
+}
+
+template <typename Sink>
+void PipelinedMatchingEngine<Sink>::MatchingSink::Stage(const OutboundMessage &message) const {
+    StageCounted(self->m_outbound, OutboundRecord{self->m_matchingSymbolName, message}, self->m_stats.matching);
+}
+
+template <typename Sink>
+SymbolId PipelinedMatchingEngine<Sink>::SymbolOf(const MessageHeader &msg) noexcept {
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            return static_cast<const NewOrder &>(msg).symbol;
+        case MessageTypeEnum::CancelOrder:
+            return static_cast<const CancelOrder &>(msg).symbol;
+        case MessageTypeEnum::ReplaceOrder:
+            return static_cast<const ReplaceOrder &>(msg).symbol;
+        default:
+            assert(!"Unexpected message type");
+            return 0;
+    }
+}
+
+template <typename Sink>
+void PipelinedMatchingEngine<Sink>::RunMatching() {
+    if (m_config.pinThreads) {
+        PinCurrentThread(m_config.matchingCpu);
+    }
+
+    auto &counters = m_stats.matching;
+    auto start = Clock::now();
+
+    bool stopped = false;
+    unsigned long lastSequenceNumber = 0;
+
+    auto handle = [&](const InboundRecord &record) {
+        m_matchingSymbolName = record.symbolName;
+
+        if (auto *newOrder = std::get_if<NewOrder>(&record.message)) {
+            m_engine.OnMessage(*newOrder, record.sequenceNumber);
+        } else if (auto *cancelOrder = std::get_if<CancelOrder>(&record.message)) {
+            m_engine.OnMessage(*cancelOrder, record.sequenceNumber);
+        } else if (auto *replaceOrder = std::get_if<ReplaceOrder>(&record.message)) {
+            m_engine.OnMessage(*replaceOrder, record.sequenceNumber);
+        } else {
+            stopped = true;
+            return;
+        }
+
+        counters.items++;
+        lastSequenceNumber = record.sequenceNumber;
+    };
+
+    while (!stopped) {
+        if (m_inbound.PopBatch(handle, PopBatchSize) == 0) {
+            auto waitStart = Clock::now();
+            m_inbound.WaitForRecords();
+            counters.waits++;
+            counters.waited += Clock::now() - waitStart;
+            continue;
+        }
+
+        // the counters must be written before the checkpoint makes them visible
+        counters.elapsed = Clock::now() - start;
+        StageCounted(m_outbound, OutboundRecord{nullptr, Checkpoint{lastSequenceNumber}}, counters);
+        m_outbound.Publish();
+    }
+
+    m_outbound.Push(OutboundRecord{});
+}
+
+template <typename Sink>
+void PipelinedMatchingEngine<Sink>::RunOutput() {
+    if (m_config.pinThreads) {
+        PinCurrentThread(m_config.outputCpu);
+    }
+
+    auto &counters = m_stats.output;
+    auto start = Clock::now();
+
+    bool stopped = false;
+
+    auto handle = [&](const OutboundRecord &record) {
+        if (auto *checkpoint = std::get_if<Checkpoint>(&record.message)) {
+            counters.elapsed = Clock::now() - start;
+            m_outputSequenceNumber.store(checkpoint->sequenceNumber, std::memory_order_release);
+            return;
+        }
+
+        Output(record, stopped);
+    };
+
+    while (!stopped) {
+        if (m_outbound.PopBatch(handle, PopBatchSize) == 0) {
+            auto waitStart = Clock::now();
+            m_outbound.WaitForRecords();
+            counters.waits++;
+            counters.waited += Clock::now() - waitStart;
+        }
+    }
+}
+
+template <typename Sink>
+void PipelinedMatchingEngine<Sink>::Output(const OutboundRecord &record, bool &stopped) {
+    if (std::holds_alternative<Stop>(record.message)) {
+        stopped = true;
+        return;
+    }
+
+    auto const &symbolName = *record.symbolName;
+
+    if (auto *trade = std::get_if<Trade>(&record.message)) {
+        m_sink(symbolName, *trade);
+    } else if (auto *cancelAck = std::get_if<CancelAck>(&record.message)) {
+        m_sink(symbolName, *cancelAck);
+    } else if (auto *replaceAck = std::get_if<ReplaceAck>(&record.message)) {
+        m_sink(symbolName, *replaceAck);
+    } else if (auto *reject = std::get_if<Reject>(&record.message)) {
+        m_sink(symbolName, *reject);
+    }
+
+    m_stats.output.items++;
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__PIPELINED_MATCHING_ENGINE_H
@@ -3,22 +3,55 @@
 
 #include <cassert>
 
-#include "fields.h"
+#include "order_list.h"
 
 namespace gemini {
-struct PriceLevel {
-    unsigned long price;
-    SideEnum::Type side;
+
+// what is resting at one price on one side of a book
+struct LevelTotals {
+    unsigned long quantity = 0;
+    unsigned long numOrders = 0;
 };
 
-constexpr bool operator<(const PriceLevel &lhs, const PriceLevel &rhs) noexcept {
-    assert(lhs.side == rhs.side);
-    if (lhs.side == SideEnum::Buy) {
-        return lhs.price > rhs.price;
-    } else {
-        return lhs.price < rhs.price;
+// the orders resting at one price in time priority, along with their totals
+//
+// The totals are kept up to date as orders come and go, so depth can be read
+// from a level without walking its orders. The quantity of an order on a level
+// must only be reduced through the level (see DecreaseQuantity).
+class PriceLevel {
+   public:
+    bool Empty() const noexcept { return m_orders.Empty(); }
+
+    OrderNode *Front() const noexcept { return m_orders.Front(); }
+
+    const LevelTotals &Totals() const noexcept { return m_totals; }
+
+    void PushBack(OrderNode *node) noexcept {
+        m_orders.PushBack(node);
+        m_totals.quantity += node->order.Quantity();
+        m_totals.numOrders++;
+    }
+
+    void Remove(OrderNode *node) noexcept {
+        assert(m_totals.numOrders > 0 && m_totals.quantity >= node->order.Quantity());
+
+        m_orders.Remove(node);
+        m_totals.quantity -= node->order.Quantity();
+        m_totals.numOrders--;
+    }
+
+    // of an order on this level, which keeps its place in the queue
+    void DecreaseQuantity(OrderNode *node, unsigned long quantity) noexcept {
+        assert(m_totals.quantity >= quantity);
+
+        node->order.DecreaseQuantity(quantity);
+        m_totals.quantity -= quantity;
     }
-}
+
+   private:
+    LevelQueue m_orders;
+    LevelTotals m_totals;
+};
 
 }  // namespace gemini
 
@@ -0,0 +1,128 @@
+#ifndef MATCHING_ENGINE__RECOVERY_H
+#define MATCHING_ENGINE__RECOVERY_H
+
+#include "binary_parser.h"
+#include "frame_reader.h"
+#include "snapshot.h"
+#include "symbol_registry.h"
+#include "text_parser.h"
+
+namespace gemini {
+
+namespace RecoveryStatusEnum {
+enum Type {
+    Unknown,
+    Ok = 'O',
+    // the snapshot is malformed, incomplete or holds orders that could not
+    // have been resting as they are
+    BadSnapshot = 'S',
+    // the journal holds something other than journal entries, or a corrupt
+    // length anywhere but in an entry cut short at its end
+    BadJournal = 'J',
+    // the journal skips over messages after the snapshot
+    MissingMessages = 'M',
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::Ok:
+            return "OK";
+        case Type::BadSnapshot:
+            return "BAD_SNAPSHOT";
+        case Type::BadJournal:
+            return "BAD_JOURNAL";
+        case Type::MissingMessages:
+            return "MISSING_MESSAGES";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+}
+}  // namespace RecoveryStatusEnum
+
+struct RecoveryResult {
+    RecoveryStatusEnum::Type status = RecoveryStatusEnum::Unknown;
+
+    // where the snapshot left off, 0 without one
+    unsigned long snapshotSequenceNumber = 0;
+
+    // journal entries after the snapshot
+    unsigned long replayed = 0;
+
+    // the length of the whole entries at the start of the journal; a crash
+    // part way through writing an entry leaves the rest of it after these,
+    // which must be cut off before appending
+    unsigned long journalBytes = 0;
+    bool journalCutShort = false;
+};
+
+// rebuilds an engine that has seen no messages after a restart
+//
+// The books are loaded from the snapshot, then every journal entry after the
+// snapshot's sequence number is replayed (see BasicMatchingEngine::Replay)
+// without output, since that was sent before the restart. Either descriptor
+// may be -1 for no snapshot or no journal. On anything but
+// RecoveryStatusEnum::Ok the engine is left part way and should not be used.
+template <typename Engine>
+RecoveryResult Recover(Engine &engine, SymbolRegistry &symbols, int snapshotFd, int journalFd) {
+    RecoveryResult result;
+
+    if (snapshotFd >= 0) {
+        SnapshotReader reader(snapshotFd, symbols);
+        if (!engine.LoadSnapshot(reader)) {
+            result.status = RecoveryStatusEnum::BadSnapshot;
+            return result;
+        }
+        result.snapshotSequenceNumber = engine.SequenceNumber();
+    }
+
+    result.status = RecoveryStatusEnum::Ok;
+    if (journalFd < 0) {
+        return result;
+    }
+
+    FrameReader reader(journalFd);
+    BinaryParser parser(symbols);
+
+    reader.ForEachFrame([&](const wire::Header &frame) {
+        auto status = parser.Parse(frame);
+        if (status == ParseStatusEnum::Definition) {
+            return true;
+        }
+        if (status != ParseStatusEnum::Ok || parser.SequenceNumber() == 0) {
+            result.status = RecoveryStatusEnum::BadJournal;
+            return false;
+        }
+
+        // the snapshot already covers the entries up to its sequence number
+        auto sequenceNumber = parser.SequenceNumber();
+        if (sequenceNumber <= engine.SequenceNumber()) {
+            return true;
+        }
+        if (sequenceNumber != engine.SequenceNumber() + 1) {
+            result.status = RecoveryStatusEnum::MissingMessages;
+            return false;
+        }
+
+        engine.Replay(parser.Message(), sequenceNumber);
+        result.replayed++;
+        return true;
+    });
+
+    // the journal is written front to back, so a crash can only have cut its
+    // last entry short; anything else wrong with it is corruption, and the
+    // entries past it must not be thrown away as if they were that last entry
+    if (result.status == RecoveryStatusEnum::Ok && reader.Corrupt() && !reader.CutShort()) {
+        result.status = RecoveryStatusEnum::BadJournal;
+        return result;
+    }
+
+    result.journalBytes = reader.Bytes();
+    result.journalCutShort = reader.CutShort();
+    return result;
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__RECOVERY_H
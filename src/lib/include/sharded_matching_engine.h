@@ -0,0 +1,334 @@
+#ifndef MATCHING_ENGINE__SHARDED_MATCHING_ENGINE_H
+#define MATCHING_ENGINE__SHARDED_MATCHING_ENGINE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "matching_engine.h"
+#include "messages.h"
+#include "spsc_queue.h"
+#include "symbol_registry.h"
+#include "trade_buffer.h"
+
+namespace gemini {
+
+// Matches symbols in parallel, one worker thread per shard.
+//
+// Each symbol belongs to one shard (symbol id modulo the number of shards) and
+// each shard runs its own BasicMatchingEngine over its own books on its own
+// thread. The thread calling OnMessage sequences each message, routes it to its
+// shard through a single-producer/single-consumer queue, and merges the output
+// coming back from the shards in sequence number order before passing it to
+// the sink. The sink therefore sees exactly what BasicMatchingEngine would
+// give it, in the same order, and is only ever called from that thread.
+template <typename Sink>
+class ShardedMatchingEngine {
+   public:
+    // the registry must only be changed from the thread calling OnMessage
+    ShardedMatchingEngine(const SymbolRegistry &symbols, std::size_t numShards, Sink sink);
+
+    // sends the output of every message in flight to the sink, then stops the shards
+    ~ShardedMatchingEngine();
+
+    ShardedMatchingEngine(const ShardedMatchingEngine &) = delete;
+    ShardedMatchingEngine &operator=(const ShardedMatchingEngine &) = delete;
+
+    // as BasicMatchingEngine, but only before the first message
+    bool ConfigureSymbol(SymbolId symbol, const OrderBookConfig &config);
+
+    // hands the message to its shard, then passes on whatever output is ready
+    // without waiting for the rest
+    void OnMessage(const MessageHeader &msg);
+
+    // waits until the output of every message so far has been passed to the sink
+    void Flush();
+
+    // as BasicMatchingEngine, waiting for the messages in flight first
+    template <typename Fn>
+    void ForEachOrder(Fn &&fn);
+
+    std::vector<std::string> Dump();
+
+    std::size_t NumShards() const noexcept;
+
+   private:
+    static constexpr std::size_t InboundCapacity = 4096;
+    static constexpr std::size_t OutboundCapacity = 16384;
+
+    // inbound records a shard handles before freeing their slots
+    static constexpr std::size_t InboundBatch = 64;
+
+    // an inbound message by value, monostate tells the shard to stop
+    struct InboundRecord {
+        unsigned long sequenceNumber = 0;
+        std::variant<std::monostate, NewOrder, CancelOrder, ReplaceOrder> message;
+    };
+
+    // an outbound message by value, monostate marks the end of the output for
+    // one inbound message
+    using OutboundRecord = std::variant<std::monostate, Trade, CancelAck, ReplaceAck, Reject>;
+
+    // idle shards sleep until there is work, the output is polled by the
+    // thread calling OnMessage between messages
+    using InboundQueue = SpscQueue<InboundRecord, FutexWait>;
+    using OutboundQueue = SpscQueue<OutboundRecord, BusyPollWait>;
+
+    // runs on the shard's thread, waits for room rather than dropping output
+    //
+    // The output of a message is staged and only published once it is all
+    // there (or the queue fills up), so the merging thread sees it in one go.
+    struct ShardSink {
+        OutboundQueue *outbound;
+
+        void operator()(TradeSpan trades) const {
+            for (auto const &trade : trades) {
+                outbound->Stage(trade);
+            }
+        }
+        void operator()(const CancelAck &ack) const { outbound->Stage(ack); }
+        void operator()(const ReplaceAck &ack) const { outbound->Stage(ack); }
+        void operator()(const Reject &reject) const { outbound->Stage(reject); }
+    };
+
+    struct Shard {
+        explicit Shard(const SymbolRegistry &symbols)
+            : inbound(InboundCapacity), outbound(OutboundCapacity), engine(symbols, ShardSink{&outbound}) {}
+
+        InboundQueue inbound;
+        OutboundQueue outbound;
+
+        // only touched by the shard's thread once it is running
+        BasicMatchingEngine<ShardSink> engine;
+
+        std::thread thread;
+    };
+
+    static SymbolId SymbolOf(const MessageHeader &msg) noexcept;
+
+    std::size_t ShardOf(SymbolId symbol) const noexcept;
+
+    // the shard's thread, handles messages until told to stop
+    static void Run(Shard &shard);
+
+    // passes on the output of finished messages in sequence order, returns as
+    // soon as the output of the oldest message in flight is not ready
+    void Drain();
+
+    const SymbolRegistry &m_symbols;
+
+    Sink m_sink;
+
+    unsigned long m_sequenceNumber;
+
+    std::vector<std::unique_ptr<Shard>> m_shards;
+
+    // the shard of each message whose output has not all been passed on yet,
+    // oldest first
+    std::deque<std::size_t> m_inFlight;
+
+    // the trades of the oldest message in flight seen so far, handed to the
+    // sink as one batch like BasicMatchingEngine does
+    TradeBuffer m_trades;
+};
+
+template <typename Sink>
+ShardedMatchingEngine<Sink>::ShardedMatchingEngine(const SymbolRegistry &symbols, std::size_t numShards, Sink sink)
+    : m_symbols(symbols), m_sink(std::move(sink)), m_sequenceNumber(0), m_trades(OutboundCapacity) {
+    assert(numShards > 0);
+
+    for (std::size_t i = 0; i < numShards; ++i) {
+        m_shards.push_back(std::make_unique<Shard>(symbols));
+    }
+    for (auto &shard : m_shards) {
+        shard->thread = std::thread(Run, std::ref(*shard));
+    }
+}
+
+template <typename Sink>
+ShardedMatchingEngine<Sink>::~ShardedMatchingEngine() {
+    Flush();
+
+    for (auto &shard : m_shards) {
+        shard->inbound.Push(InboundRecord{});
+    }
+    for (auto &shard : m_shards) {
+        shard->thread.join();
+    }
+}
+
+template <typename Sink>
+bool ShardedMatchingEngine<Sink>::ConfigureSymbol(SymbolId symbol, const OrderBookConfig &config) {
+    // the shard's thread has not touched its engine yet, and will only do so
+    // after seeing a message pushed after this
+    assert(m_sequenceNumber == 0);
+
+    return m_shards[ShardOf(symbol)]->engine.ConfigureSymbol(symbol, config);
+}
+
+template <typename Sink>
+void ShardedMatchingEngine<Sink>::OnMessage(const MessageHeader &msg) {
+    InboundRecord record;
+
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            record.message = static_cast<const NewOrder &>(msg);
+            break;
+        case MessageTypeEnum::CancelOrder:
+            record.message = static_cast<const CancelOrder &>(msg);
+            break;
+        case MessageTypeEnum::ReplaceOrder:
+            record.message = static_cast<const ReplaceOrder &>(msg);
+            break;
+        default:
+            assert(!"Unexpected message type");
+            return;
+    }
+
+    // only a message that reaches a shard is sequenced, so no sequence number
+    // goes missing from the output
+    record.sequenceNumber = ++m_sequenceNumber;
+    auto index = ShardOf(SymbolOf(msg));
+
+    // keep merging while the shard is full, it may be waiting on us for room
+    // to write its output
+    while (!m_shards[index]->inbound.TryPush(record)) {
+        Drain();
+        std::this_thread::yield();
+    }
+    m_inFlight.push_back(index);
+
+    Drain();
+}
+
+template <typename Sink>
+void ShardedMatchingEngine<Sink>::Flush() {
+    Drain();
+    while (!m_inFlight.empty()) {
+        m_shards[m_inFlight.front()]->outbound.WaitForRecords();
+        Drain();
+    }
+}
+
+template <typename Sink>
+template <typename Fn>
+void ShardedMatchingEngine<Sink>::ForEachOrder(Fn &&fn) {
+    // once flushed the shards are idle, and everything they did happened before
+    // they published the output we have just read
+    Flush();
+
+    std::vector<SymbolId> symbols;
+    for (SymbolId symbol = 0; symbol < m_symbols.Size(); ++symbol) {
+        symbols.push_back(symbol);
+    }
+    std::sort(symbols.begin(), symbols.end(),
+              [this](SymbolId lhs, SymbolId rhs) { return m_symbols.Name(lhs) < m_symbols.Name(rhs); });
+
+    for (auto symbol : symbols) {
+        m_shards[ShardOf(symbol)]->engine.ForEachOrder(symbol, fn);
+    }
+}
+
+template <typename Sink>
+std::vector<std::string> ShardedMatchingEngine<Sink>::Dump() {
+    std::vector<std::string> result;
+
+    ForEachOrder(
+        [&](const std::string &symbolName, const Order &order) { result.push_back(order.ToString(symbolName)); });
+
+    return result;
+}
+
+template <typename Sink>
+std::size_t ShardedMatchingEngine<Sink>::NumShards() const noexcept {
+    return m_shards.size();
+}
+
+template <typename Sink>
+SymbolId ShardedMatchingEngine<Sink>::SymbolOf(const MessageHeader &msg) noexcept {
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder:
+            return static_cast<const NewOrder &>(msg).symbol;
+        case MessageTypeEnum::CancelOrder:
+            return static_cast<const CancelOrder &>(msg).symbol;
+        case MessageTypeEnum::ReplaceOrder:
+            return static_cast<const ReplaceOrder &>(msg).symbol;
+        default:
+            assert(!"Unexpected message type");
+            return 0;
+    }
+}
+
+template <typename Sink>
+std::size_t ShardedMatchingEngine<Sink>::ShardOf(SymbolId symbol) const noexcept {
+    return symbol % m_shards.size();
+}
+
+template <typename Sink>
+void ShardedMatchingEngine<Sink>::Run(Shard &shard) {
+    bool stopped = false;
+
+    auto handle = [&](const InboundRecord &record) {
+        if (auto *newOrder = std::get_if<NewOrder>(&record.message)) {
+            shard.engine.OnMessage(*newOrder, record.sequenceNumber);
+        } else if (auto *cancelOrder = std::get_if<CancelOrder>(&record.message)) {
+            shard.engine.OnMessage(*cancelOrder, record.sequenceNumber);
+        } else if (auto *replaceOrder = std::get_if<ReplaceOrder>(&record.message)) {
+            shard.engine.OnMessage(*replaceOrder, record.sequenceNumber);
+        } else {
+            // nothing is ever pushed after the stop record
+            stopped = true;
+            return;
+        }
+
+        // publishes the output of the message along with its end marker
+        shard.outbound.Push(std::monostate{});
+    };
+
+    while (!stopped) {
+        shard.inbound.WaitForRecords();
+        shard.inbound.PopBatch(handle, InboundBatch);
+    }
+}
+
+template <typename Sink>
+void ShardedMatchingEngine<Sink>::Drain() {
+    OutboundRecord record;
+
+    while (!m_inFlight.empty()) {
+        if (!m_shards[m_inFlight.front()]->outbound.TryPop(record)) {
+            return;
+        }
+
+        if (auto *trade = std::get_if<Trade>(&record)) {
+            m_trades.Append() = *trade;
+            continue;
+        }
+
+        // anything else ends the run of trades for this message
+        if (!m_trades.Empty()) {
+            SendTrades(m_sink, m_trades.View());
+            m_trades.Clear();
+        }
+
+        if (auto *cancelAck = std::get_if<CancelAck>(&record)) {
+            m_sink(*cancelAck);
+        } else if (auto *replaceAck = std::get_if<ReplaceAck>(&record)) {
+            m_sink(*replaceAck);
+        } else if (auto *reject = std::get_if<Reject>(&record)) {
+            m_sink(*reject);
+        } else {
+            m_inFlight.pop_front();
+        }
+    }
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__SHARDED_MATCHING_ENGINE_H
@@ -0,0 +1,46 @@
+#ifndef MATCHING_ENGINE__SIDE_TRAITS_H
+#define MATCHING_ENGINE__SIDE_TRAITS_H
+
+#include <functional>
+#include <limits>
+
+#include "fields.h"
+
+namespace gemini {
+
+// price ordering for one side of the book, resolved at compile time so the
+// matching loop never branches on side
+template <SideEnum::Type Side>
+struct SideTraits;
+
+template <>
+struct SideTraits<SideEnum::Buy> {
+    static constexpr SideEnum::Type Contra = SideEnum::Sell;
+
+    // best (highest) bid first
+    using PriceCompare = std::greater<unsigned long>;
+
+    // true if price lhs has the same or higher priority than rhs
+    static constexpr bool IsAtOrBetter(unsigned long lhs, unsigned long rhs) noexcept { return lhs >= rhs; }
+
+    // a limit that every price on the other side is at or better than, for market orders
+    static constexpr unsigned long MarketPrice = std::numeric_limits<unsigned long>::max();
+};
+
+template <>
+struct SideTraits<SideEnum::Sell> {
+    static constexpr SideEnum::Type Contra = SideEnum::Buy;
+
+    // best (lowest) ask first
+    using PriceCompare = std::less<unsigned long>;
+
+    // true if price lhs has the same or higher priority than rhs
+    static constexpr bool IsAtOrBetter(unsigned long lhs, unsigned long rhs) noexcept { return lhs <= rhs; }
+
+    // a limit that every price on the other side is at or better than, for market orders
+    static constexpr unsigned long MarketPrice = 0;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__SIDE_TRAITS_H
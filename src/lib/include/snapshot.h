@@ -0,0 +1,161 @@
+#ifndef MATCHING_ENGINE__SNAPSHOT_H
+#define MATCHING_ENGINE__SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "binary_parser.h"
+#include "frame_reader.h"
+#include "messages.h"
+#include "order.h"
+#include "order_book.h"
+#include "output_writer.h"
+#include "symbol_registry.h"
+#include "wire_messages.h"
+
+namespace gemini {
+
+// A snapshot holds the resting orders of every book and the sequence number of
+// the last message they reflect, so the books can be rebuilt without
+// replaying the history that led to them.
+//
+// It is a stream of wire messages (see wire_messages.h): a wire::Snapshot, then
+// for each book the definition of its symbol, a wire::BookSnapshot with its
+// configuration and a wire::RestingOrder for each of its orders, asks then
+// bids and each side in sequence number order. That is also the order of the
+// orders within each price level, so resting them one after the other with
+// BasicOrderBook::RestoreOrder gives back exactly the same book.
+
+// writes a snapshot through a buffer, see BasicMatchingEngine::WriteSnapshot
+class SnapshotWriter {
+   public:
+    // the descriptor is not closed
+    SnapshotWriter(int fd, const SymbolRegistry &symbols);
+
+    void WriteHeader(unsigned long sequenceNumber, std::size_t numBooks);
+
+    // the book and all of its resting orders, false if the name of the symbol
+    // cannot be encoded
+    template <typename Book>
+    bool WriteBook(SymbolId symbol, const Book &book);
+
+    // hands everything written so far to the descriptor, returns false if
+    // anything failed to be written since the writer was created
+    bool Flush();
+
+   private:
+    bool WriteBookHeader(SymbolId symbol, const OrderBookConfig &config, std::size_t numOrders);
+    void WriteOrder(const Order &order);
+
+    template <typename Wire>
+    void Append(const Wire &msg);
+
+    OutputWriter m_writer;
+    BinaryEncoder m_encoder;
+
+    // bytes appended, which the writer should have written once flushed
+    unsigned long m_bytes;
+};
+
+// reads a snapshot, mapping it if it is a regular file
+//
+// The sizes a snapshot gives for its books are checked before anything is
+// allocated for them: a book may hold no more orders than the rest of the
+// file has room for, and no more than MaxBookCapacity levels or order nodes
+// up front, anything larger is taken to be corrupt.
+class SnapshotReader {
+   public:
+    // the descriptor must stay open while reading, symbols are interned in
+    // the registry as they are defined
+    SnapshotReader(int fd, SymbolRegistry &symbols);
+
+    // calls onBook(SymbolId, const OrderBookConfig &, std::size_t numOrders)
+    // as each book starts and onOrder(Order) for each of its orders, both
+    // returning false to give up
+    //
+    // Returns false if a callback gave up, or if the snapshot is malformed,
+    // incomplete or cut short, in which case whatever the callbacks were
+    // given should be thrown away.
+    template <typename OnBook, typename OnOrder>
+    bool Read(OnBook &&onBook, OnOrder &&onOrder);
+
+    // of the snapshot once it has been read
+    unsigned long SequenceNumber() const noexcept;
+
+    static constexpr unsigned long MaxBookCapacity = 1ul << 24;
+
+   private:
+    // checks the frame fits where it is in the snapshot and takes what it
+    // holds, returns its type or MessageTypeEnum::Unknown if it does not
+    MessageTypeEnum::Type ParseFrame(const wire::Header &frame);
+
+    MessageTypeEnum::Type ParseSnapshot(const wire::Header &frame);
+    MessageTypeEnum::Type ParseBookSnapshot(const wire::Header &frame);
+    MessageTypeEnum::Type ParseRestingOrder(const wire::Header &frame);
+
+    // true once every book and order the snapshot announced has been read
+    bool Complete() const noexcept;
+
+    FrameReader m_reader;
+
+    // of the whole snapshot, as large as MaxBookCapacity orders if it is not a
+    // regular file and so cannot be sized up front
+    unsigned long m_size;
+
+    // only used for the symbol definitions
+    BinaryParser m_parser;
+
+    bool m_started;
+    unsigned long m_sequenceNumber;
+    std::size_t m_numBooks;
+    std::size_t m_booksRead;
+
+    // the book being read
+    SymbolId m_symbol;
+    OrderBookConfig m_config;
+    std::size_t m_numOrders;
+    std::size_t m_ordersRead;
+
+    // the order just read, resting at this sequence number
+    NewOrder m_order;
+    unsigned long m_orderSequenceNumber;
+};
+
+template <typename Book>
+bool SnapshotWriter::WriteBook(SymbolId symbol, const Book &book) {
+    if (!WriteBookHeader(symbol, book.Config(), book.NumOrders())) {
+        return false;
+    }
+
+    book.ForEachOrder([this](const Order &order) { WriteOrder(order); });
+    return true;
+}
+
+template <typename OnBook, typename OnOrder>
+bool SnapshotReader::Read(OnBook &&onBook, OnOrder &&onOrder) {
+    auto ok = true;
+
+    m_reader.ForEachFrame([&](const wire::Header &frame) {
+        switch (ParseFrame(frame)) {
+            case MessageTypeEnum::BookSnapshot:
+                ok = onBook(m_symbol, m_config, m_numOrders);
+                break;
+            case MessageTypeEnum::RestingOrder:
+                ok = onOrder(Order(m_orderSequenceNumber, m_order));
+                break;
+            case MessageTypeEnum::Unknown:
+                ok = false;
+                break;
+            default:
+                // the header or a symbol definition
+                break;
+        }
+        return ok;
+    });
+
+    return ok && !m_reader.Corrupt() && Complete();
+}
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__SNAPSHOT_H
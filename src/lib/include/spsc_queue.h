@@ -0,0 +1,265 @@
+#ifndef MATCHING_ENGINE__SPSC_QUEUE_H
+#define MATCHING_ENGINE__SPSC_QUEUE_H
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gemini {
+
+// the queue's indices are padded to this so the two threads never share a line
+constexpr std::size_t CacheLineSize = 64;
+
+// tells the core we are spinning, lets a sibling hyperthread run
+inline void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Wait strategies decide what a thread does while the queue is full (producer)
+// or empty (consumer). Each queue holds one for each direction:
+//
+//   Wait(ready) - returns once ready() is true
+//   Notify()    - called after the other side has made progress
+//
+// BusyPollWait never sleeps, for latency critical threads that own a core.
+// It still yields now and then so an oversubscribed machine makes progress.
+class BusyPollWait {
+   public:
+    template <typename Ready>
+    void Wait(Ready &&ready) noexcept {
+        for (unsigned spins = 1; !ready(); ++spins) {
+            CpuRelax();
+            if (spins % YieldEvery == 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void Notify() noexcept {}
+
+   private:
+    static constexpr unsigned YieldEvery = 1024;
+};
+
+// FutexWait spins briefly and then sleeps in the kernel until notified, so an
+// idle thread costs nothing. Notify is a fence and a load unless someone is
+// actually asleep.
+class FutexWait {
+   public:
+    template <typename Ready>
+    void Wait(Ready &&ready) noexcept {
+        for (unsigned spins = 0; spins < SpinsBeforeSleeping; ++spins) {
+            if (ready()) {
+                return;
+            }
+            CpuRelax();
+        }
+
+        while (!ready()) {
+            // announce ourselves before looking again, so a Notify after this
+            // either sees us or its progress is seen by ready()
+            m_waiters.fetch_add(1, std::memory_order_seq_cst);
+            auto epoch = m_epoch.load(std::memory_order_acquire);
+            if (!ready()) {
+                // returns straight away if the epoch has moved on since we looked
+                syscall(SYS_futex, &m_epoch, FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+            }
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Notify() noexcept {
+        // orders the caller's publication before the check for waiters
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) != 0) {
+            m_epoch.fetch_add(1, std::memory_order_release);
+            syscall(SYS_futex, &m_epoch, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+        }
+    }
+
+   private:
+    static constexpr unsigned SpinsBeforeSleeping = 4096;
+
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex needs a plain 32 bit word");
+
+    std::atomic<std::uint32_t> m_epoch{0};
+    std::atomic<std::uint32_t> m_waiters{0};
+};
+
+// bounded lock-free queue between exactly one producer thread and one consumer thread
+//
+// Records are copied by value into a ring of slots allocated up front, so they
+// should be small, fixed size types. The producer only ever writes the tail and
+// the consumer only ever writes the head; each keeps a private copy of the other
+// side's index and only reloads it when the ring looks full (or empty), so in
+// the steady state neither thread touches the other's cache line.
+//
+// Both sides can batch: the producer may Stage several records and make them
+// visible with one Publish, the consumer may PopBatch several records and
+// release their slots with one store.
+template <typename T, typename WaitStrategy = BusyPollWait>
+class SpscQueue {
+   public:
+    static_assert(std::is_copy_assignable_v<T>, "records are copied in and out of the slots");
+
+    // capacity is rounded up to a power of two
+    explicit SpscQueue(std::size_t capacity) : m_slots(RoundUp(capacity)), m_mask(m_slots.size() - 1) {}
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    // producer only
+
+    // stages and publishes one record, returns false if the queue is full
+    bool TryPush(const T &value) {
+        if (!TryStage(value)) {
+            return false;
+        }
+        Publish();
+        return true;
+    }
+
+    // as TryPush, waiting for room if the queue is full
+    void Push(const T &value) {
+        Stage(value);
+        Publish();
+    }
+
+    // copies the record into the next slot without making it visible to the
+    // consumer, returns false if the queue is full
+    bool TryStage(const T &value) {
+        if (m_staged - m_cachedHead == m_slots.size()) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (m_staged - m_cachedHead == m_slots.size()) {
+                return false;
+            }
+        }
+
+        m_slots[m_staged & m_mask] = value;
+        m_staged++;
+        return true;
+    }
+
+    // as TryStage, publishing what is already staged and waiting if the queue is full
+    void Stage(const T &value) {
+        while (!TryStage(value)) {
+            Publish();
+            m_notFull.Wait([this] { return m_staged - m_head.load(std::memory_order_acquire) < m_slots.size(); });
+        }
+    }
+
+    // makes every staged record visible to the consumer with a single store
+    void Publish() {
+        if (m_staged == m_tail.load(std::memory_order_relaxed)) {
+            return;
+        }
+        m_tail.store(m_staged, std::memory_order_release);
+        m_notEmpty.Notify();
+    }
+
+    // consumer only
+
+    // returns false if the queue is empty
+    bool TryPop(T &value) {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false;
+            }
+        }
+
+        value = m_slots[head & m_mask];
+        m_head.store(head + 1, std::memory_order_release);
+        m_notFull.Notify();
+        return true;
+    }
+
+    // as TryPop, waiting for a record if the queue is empty
+    void Pop(T &value) {
+        while (!TryPop(value)) {
+            m_notEmpty.Wait([this] {
+                return m_head.load(std::memory_order_relaxed) != m_tail.load(std::memory_order_acquire);
+            });
+        }
+    }
+
+    // calls fn(const T &) for up to maxCount published records and then frees
+    // their slots with a single store, returns the number of records
+    template <typename Fn>
+    std::size_t PopBatch(Fn &&fn, std::size_t maxCount) {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+
+        auto count = m_cachedTail - head;
+        if (count > maxCount) {
+            count = maxCount;
+        }
+        if (count == 0) {
+            return 0;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            fn(static_cast<const T &>(m_slots[(head + i) & m_mask]));
+        }
+
+        m_head.store(head + count, std::memory_order_release);
+        m_notFull.Notify();
+        return count;
+    }
+
+    // waits until there is at least one record to pop
+    void WaitForRecords() {
+        m_notEmpty.Wait(
+            [this] { return m_head.load(std::memory_order_relaxed) != m_tail.load(std::memory_order_acquire); });
+    }
+
+    std::size_t Capacity() const noexcept { return m_slots.size(); }
+
+   private:
+    static std::size_t RoundUp(std::size_t capacity) {
+        std::size_t result = 1;
+        while (result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // read only once constructed, shared by both threads
+    std::vector<T> m_slots;
+    std::size_t m_mask;
+
+    // The indices only ever increase, slot = index & m_mask.
+
+    // producer's line: published tail, next slot to stage and the last head seen
+    alignas(CacheLineSize) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_staged = 0;
+    std::size_t m_cachedHead = 0;
+
+    // consumer's line: head and the last tail seen
+    alignas(CacheLineSize) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail = 0;
+
+    // the consumer waits for records, the producer waits for room
+    alignas(CacheLineSize) WaitStrategy m_notEmpty;
+    alignas(CacheLineSize) WaitStrategy m_notFull;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__SPSC_QUEUE_H
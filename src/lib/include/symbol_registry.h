@@ -0,0 +1,38 @@
+#ifndef MATCHING_ENGINE__SYMBOL_REGISTRY_H
+#define MATCHING_ENGINE__SYMBOL_REGISTRY_H
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "fields.h"
+
+namespace gemini {
+
+// interns instrument symbols into dense ids
+//
+// Symbols are looked up once at the input edge; everything past that point
+// carries the SymbolId and only the output edge turns it back into text. Ids
+// are handed out from 0 in order of first appearance.
+class SymbolRegistry {
+   public:
+    // returns the existing id if the symbol has been seen before
+    SymbolId Intern(std::string_view symbol);
+
+    bool Contains(SymbolId id) const noexcept;
+
+    const std::string &Name(SymbolId id) const;
+
+    std::size_t Size() const noexcept;
+
+   private:
+    // deque so the names never move, the lookup keys are views into them
+    std::deque<std::string> m_names;
+    std::unordered_map<std::string_view, SymbolId> m_ids;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__SYMBOL_REGISTRY_H
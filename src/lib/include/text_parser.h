@@ -0,0 +1,89 @@
+#ifndef MATCHING_ENGINE__TEXT_PARSER_H
+#define MATCHING_ENGINE__TEXT_PARSER_H
+
+#include <cstddef>
+#include <string_view>
+
+#include "messages.h"
+#include "symbol_registry.h"
+
+namespace gemini {
+
+namespace ParseStatusEnum {
+enum Type {
+    Unknown,
+    Ok = 'O',
+    Blank = 'B',
+    Malformed = 'M',
+    OrderIdTooLong = 'L',
+    Definition = 'D',  // binary input that defined a symbol rather than carrying a message
+};
+
+constexpr const char *ToString(Type type) {
+    switch (type) {
+        case Type::Ok:
+            return "OK";
+        case Type::Blank:
+            return "BLANK";
+        case Type::Malformed:
+            return "MALFORMED";
+        case Type::OrderIdTooLong:
+            return "ORDER_ID_TOO_LONG";
+        case Type::Definition:
+            return "DEFINITION";
+        case Type::Unknown:
+            [[fallthrough]];
+        default:
+            return "<UNKNOWN>";
+    }
+    return "<UNKNOWN>";
+}
+}  // namespace ParseStatusEnum
+
+// whitespace separated fields of one line, viewing into the line itself
+struct TextFields {
+    // one more than any message has, so a line with too many fields is seen
+    static constexpr std::size_t Capacity = 7;
+
+    std::string_view fields[Capacity];
+    std::size_t count = 0;
+};
+
+// breaks the line into fields without copying, stops after TextFields::Capacity
+TextFields SplitFields(std::string_view line) noexcept;
+
+// parses a base 10 unsigned number that must fill the whole field
+bool ParseUnsigned(std::string_view field, unsigned long &value) noexcept;
+
+// turns input lines into inbound messages, see the Input Format in README.md
+//
+// The parser keeps one message of each type and overwrites it on every line,
+// so parsing never allocates except to intern a symbol seen for the first time.
+class TextParser {
+   public:
+    explicit TextParser(SymbolRegistry &symbols);
+
+    // on ParseStatusEnum::Ok the message is available from Message() until the
+    // next call, any other status means the line should be skipped
+    ParseStatusEnum::Type Parse(std::string_view line);
+
+    const MessageHeader &Message() const noexcept;
+
+   private:
+    ParseStatusEnum::Type ParseNewOrder(const TextFields &fields);
+    ParseStatusEnum::Type ParseCancelOrder(const TextFields &fields);
+    ParseStatusEnum::Type ParseReplaceOrder(const TextFields &fields);
+
+    SymbolRegistry &m_symbols;
+
+    NewOrder m_newOrder;
+    CancelOrder m_cancelOrder;
+    ReplaceOrder m_replaceOrder;
+
+    // points at whichever of the above the last line filled in
+    const MessageHeader *m_message;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__TEXT_PARSER_H
@@ -0,0 +1,109 @@
+#ifndef MATCHING_ENGINE__TOP_OF_BOOK_H
+#define MATCHING_ENGINE__TOP_OF_BOOK_H
+
+#include <atomic>
+
+#include "spsc_queue.h"
+
+namespace gemini {
+
+// the best bid and offer of a book and its last trade
+struct TopOfBook {
+    // all zero while the side is empty
+    unsigned long bidPrice = 0;
+    unsigned long bidQuantity = 0;
+    unsigned long askPrice = 0;
+    unsigned long askQuantity = 0;
+
+    // all zero until the book first trades
+    unsigned long lastTradePrice = 0;
+    unsigned long lastTradeQuantity = 0;
+
+    // counts the changes to any of the above
+    unsigned long version = 0;
+
+    inline bool operator==(const TopOfBook &rhs) const {
+        return bidPrice == rhs.bidPrice && bidQuantity == rhs.bidQuantity && askPrice == rhs.askPrice &&
+               askQuantity == rhs.askQuantity && lastTradePrice == rhs.lastTradePrice &&
+               lastTradeQuantity == rhs.lastTradeQuantity && version == rhs.version;
+    }
+    inline bool operator!=(const TopOfBook &rhs) const { return !(*this == rhs); }
+};
+
+// a TopOfBook written by the matching thread and read by any number of others
+//
+// It is published through a seqlock: the writer makes the sequence odd, stores
+// the fields and makes it even again, and a reader keeps its copy of the
+// fields only if the sequence was even and unchanged around it. The writer
+// never waits for a reader and readers never write, so polling costs the
+// matching thread nothing but the line being read back from another core.
+// The fields are relaxed atomics, so a torn copy is thrown away rather than
+// being a data race. It fills exactly one cache line.
+class alignas(CacheLineSize) TopOfBookCache {
+   public:
+    // from the one writing thread only
+    void Publish(const TopOfBook &top) noexcept {
+        auto sequence = m_sequence.load(std::memory_order_relaxed);
+
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        m_bidPrice.store(top.bidPrice, std::memory_order_relaxed);
+        m_bidQuantity.store(top.bidQuantity, std::memory_order_relaxed);
+        m_askPrice.store(top.askPrice, std::memory_order_relaxed);
+        m_askQuantity.store(top.askQuantity, std::memory_order_relaxed);
+        m_lastTradePrice.store(top.lastTradePrice, std::memory_order_relaxed);
+        m_lastTradeQuantity.store(top.lastTradeQuantity, std::memory_order_relaxed);
+        m_version.store(top.version, std::memory_order_relaxed);
+
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // wait-free, returns false if the writer was part way through publishing,
+    // in which case top holds nothing useful and should be read again
+    bool TryRead(TopOfBook &top) const noexcept {
+        auto before = m_sequence.load(std::memory_order_acquire);
+        if (before % 2 != 0) {
+            return false;
+        }
+
+        top.bidPrice = m_bidPrice.load(std::memory_order_relaxed);
+        top.bidQuantity = m_bidQuantity.load(std::memory_order_relaxed);
+        top.askPrice = m_askPrice.load(std::memory_order_relaxed);
+        top.askQuantity = m_askQuantity.load(std::memory_order_relaxed);
+        top.lastTradePrice = m_lastTradePrice.load(std::memory_order_relaxed);
+        top.lastTradeQuantity = m_lastTradeQuantity.load(std::memory_order_relaxed);
+        top.version = m_version.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return m_sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // retries until it reads a consistent copy, which only takes more than one
+    // attempt if the writer publishes at the same moment
+    TopOfBook Read() const noexcept {
+        TopOfBook top;
+        while (!TryRead(top)) {
+            CpuRelax();
+        }
+        return top;
+    }
+
+   private:
+    // odd while the writer is publishing
+    std::atomic<unsigned long> m_sequence{0};
+
+    std::atomic<unsigned long> m_bidPrice{0};
+    std::atomic<unsigned long> m_bidQuantity{0};
+    std::atomic<unsigned long> m_askPrice{0};
+    std::atomic<unsigned long> m_askQuantity{0};
+    std::atomic<unsigned long> m_lastTradePrice{0};
+    std::atomic<unsigned long> m_lastTradeQuantity{0};
+    std::atomic<unsigned long> m_version{0};
+};
+
+static_assert(sizeof(TopOfBookCache) == CacheLineSize, "the top of book should fill one cache line");
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__TOP_OF_BOOK_H
@@ -0,0 +1,58 @@
+#ifndef MATCHING_ENGINE__TRADE_BUFFER_H
+#define MATCHING_ENGINE__TRADE_BUFFER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "messages.h"
+
+namespace gemini {
+
+// read-only view of a contiguous run of trades
+class TradeSpan {
+   public:
+    TradeSpan() noexcept : m_data(nullptr), m_size(0) {}
+    TradeSpan(const Trade *data, std::size_t size) noexcept : m_data(data), m_size(size) {}
+
+    const Trade *begin() const noexcept { return m_data; }
+    const Trade *end() const noexcept { return m_data + m_size; }
+
+    std::size_t Size() const noexcept { return m_size; }
+    bool Empty() const noexcept { return m_size == 0; }
+
+    const Trade &operator[](std::size_t index) const noexcept { return m_data[index]; }
+
+   private:
+    const Trade *m_data;
+    std::size_t m_size;
+};
+
+// reusable storage for the trades generated by one inbound order
+//
+// Clearing keeps the capacity, so once the buffer has grown to the largest
+// sweep seen, matching never touches the heap again.
+class TradeBuffer {
+   public:
+    TradeBuffer() = default;
+    explicit TradeBuffer(std::size_t capacity) { m_trades.reserve(capacity); }
+
+    void Clear() noexcept { m_trades.clear(); }
+
+    Trade &Append() {
+        m_trades.emplace_back();
+        return m_trades.back();
+    }
+
+    TradeSpan View() const noexcept { return {m_trades.data(), m_trades.size()}; }
+
+    std::size_t Size() const noexcept { return m_trades.size(); }
+    bool Empty() const noexcept { return m_trades.empty(); }
+    std::size_t Capacity() const noexcept { return m_trades.capacity(); }
+
+   private:
+    std::vector<Trade> m_trades;
+};
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__TRADE_BUFFER_H
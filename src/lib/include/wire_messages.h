@@ -0,0 +1,272 @@
+#ifndef MATCHING_ENGINE__WIRE_MESSAGES_H
+#define MATCHING_ENGINE__WIRE_MESSAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "messages.h"
+#include "order.h"
+#include "order_id.h"
+
+namespace gemini {
+
+// Fixed layouts of the messages for moving them between processes, through
+// files or shared memory, as plain bytes.
+//
+// Every message starts with a Header giving its type and its size in bytes,
+// which is always a multiple of FrameAlignment so messages written back to
+// back stay aligned.
+// Fields are fixed width, in host byte order (only little endian hosts are
+// supported) and laid out at their natural alignment with explicit padding, so
+// there are no gaps for the compiler to fill. Padding and reserved bytes are
+// written as zero and ignored when read. Order ids take the 16 bytes of
+// OrderId as they are: up to 15 characters, zero filled, with the length in
+// the last byte.
+namespace wire {
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "wire messages are little endian");
+
+struct Header {
+    std::uint8_t messageType;  // MessageTypeEnum::Type
+    std::uint8_t reserved;
+    std::uint16_t length;  // of the whole message, header included
+};
+
+struct NewOrder {
+    Header header;
+    std::uint32_t symbol;
+    char orderId[16];
+    std::uint64_t quantity;
+    std::uint64_t price;
+    std::uint8_t side;         // SideEnum::Type
+    std::uint8_t orderType;    // OrderTypeEnum::Type, zero reads as a limit order
+    std::uint8_t timeInForce;  // TimeInForceEnum::Type, zero reads as good till cancel
+    std::uint8_t padding[5];
+};
+
+struct CancelOrder {
+    Header header;
+    std::uint32_t symbol;
+    char orderId[16];
+};
+
+struct ReplaceOrder {
+    Header header;
+    std::uint32_t symbol;
+    char orderId[16];
+    std::uint64_t quantity;
+    std::uint64_t price;
+};
+
+struct Trade {
+    Header header;
+    std::uint32_t symbol;
+    char orderId[16];
+    char contraOrderId[16];
+    std::uint64_t quantity;
+    std::uint64_t price;
+};
+
+// the layout of CancelAck and ReplaceAck
+struct Ack {
+    Header header;
+    std::uint32_t symbol;
+    char orderId[16];
+    std::uint64_t quantity;
+    std::uint64_t price;
+    std::uint8_t side;  // SideEnum::Type
+    std::uint8_t padding[7];
+};
+
+struct Reject {
+    Header header;
+    std::uint32_t symbol;
+    char orderId[16];
+    std::uint8_t rejectedMessageType;  // MessageTypeEnum::Type
+    std::uint8_t reason;               // RejectReasonEnum::Type
+    std::uint8_t padding[6];
+};
+
+// gives the name of a symbol id used by the messages that follow, only in
+// streams of messages (such as binary input files) whose ids are their own
+//
+// Followed by nameLength bytes of name, then zeros up to the next multiple of
+// FrameAlignment, all counted in header.length.
+struct SymbolDefinition {
+    Header header;
+    std::uint32_t symbol;
+    std::uint32_t nameLength;
+    std::uint8_t padding[4];
+};
+
+// an inbound message as the engine sequenced it, in journals
+//
+// Followed by the message itself, header.length counts both.
+struct JournalEntry {
+    Header header;
+    std::uint32_t reserved;
+    std::uint64_t sequenceNumber;
+};
+
+// starts a snapshot of the books, see snapshot.h
+struct Snapshot {
+    Header header;
+    std::uint32_t numBooks;
+    std::uint64_t sequenceNumber;  // of the last message the books reflect
+};
+
+// starts a book in a snapshot, followed by its resting orders
+struct BookSnapshot {
+    Header header;
+    std::uint32_t symbol;
+    std::uint64_t basePrice;
+    std::uint64_t tickSize;
+    std::uint64_t numLevels;
+    std::uint64_t poolCapacity;
+    std::uint64_t poolGrowBy;
+    std::uint64_t numOrders;
+    std::uint8_t bookType;  // BookTypeEnum::Type
+    std::uint8_t padding[7];
+};
+
+// a resting order in a snapshot, of the book before it
+struct RestingOrder {
+    Header header;
+    std::uint8_t side;  // SideEnum::Type
+    std::uint8_t padding[3];
+    char orderId[16];
+    std::uint64_t sequenceNumber;
+    std::uint64_t quantity;
+    std::uint64_t price;
+};
+
+// the totals of one price level after a change, see LevelUpdate in messages.h
+struct LevelUpdate {
+    Header header;
+    std::uint32_t symbol;
+    std::uint64_t price;
+    std::uint64_t quantity;
+    std::uint64_t numOrders;
+    std::uint8_t side;  // SideEnum::Type
+    std::uint8_t padding[7];
+};
+
+// one change to a resting order, see OrderUpdate in messages.h
+struct OrderUpdate {
+    Header header;
+    std::uint32_t symbol;
+    std::uint64_t sequenceNumber;
+    char orderId[16];
+    std::uint64_t price;
+    std::uint64_t quantity;
+    std::uint8_t updateType;  // OrderUpdateTypeEnum::Type
+    std::uint8_t side;        // SideEnum::Type
+    std::uint8_t padding[6];
+};
+
+constexpr std::size_t FrameAlignment = 8;
+
+// the largest fixed size message
+constexpr std::size_t MaxMessageSize = sizeof(Trade);
+
+// the length of a symbol definition with a name of the given length
+constexpr std::size_t SymbolDefinitionSize(std::size_t nameLength) noexcept {
+    return (sizeof(SymbolDefinition) + nameLength + FrameAlignment - 1) / FrameAlignment * FrameAlignment;
+}
+
+// the longest name a symbol definition can carry
+constexpr std::size_t MaxSymbolNameLength = 0xFFFF / FrameAlignment * FrameAlignment - sizeof(SymbolDefinition);
+
+// what lets a message be copied around as bytes
+template <typename T>
+constexpr bool IsWireLayout = std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T> && alignof(T) <= 8;
+
+static_assert(IsWireLayout<Header> && sizeof(Header) == 4, "Header must stay packed");
+static_assert(IsWireLayout<NewOrder> && sizeof(NewOrder) == 48, "NewOrder must keep its wire layout");
+static_assert(IsWireLayout<CancelOrder> && sizeof(CancelOrder) == 24, "CancelOrder must keep its wire layout");
+static_assert(IsWireLayout<ReplaceOrder> && sizeof(ReplaceOrder) == 40, "ReplaceOrder must keep its wire layout");
+static_assert(IsWireLayout<Trade> && sizeof(Trade) == 56, "Trade must keep its wire layout");
+static_assert(IsWireLayout<Ack> && sizeof(Ack) == 48, "Ack must keep its wire layout");
+static_assert(IsWireLayout<Reject> && sizeof(Reject) == 32, "Reject must keep its wire layout");
+static_assert(IsWireLayout<SymbolDefinition> && sizeof(SymbolDefinition) == 16,
+              "SymbolDefinition must keep its wire layout");
+static_assert(IsWireLayout<JournalEntry> && sizeof(JournalEntry) == 16, "JournalEntry must keep its wire layout");
+static_assert(IsWireLayout<Snapshot> && sizeof(Snapshot) == 16, "Snapshot must keep its wire layout");
+static_assert(IsWireLayout<BookSnapshot> && sizeof(BookSnapshot) == 64, "BookSnapshot must keep its wire layout");
+static_assert(IsWireLayout<RestingOrder> && sizeof(RestingOrder) == 48, "RestingOrder must keep its wire layout");
+static_assert(IsWireLayout<LevelUpdate> && sizeof(LevelUpdate) == 40, "LevelUpdate must keep its wire layout");
+static_assert(IsWireLayout<OrderUpdate> && sizeof(OrderUpdate) == 56, "OrderUpdate must keep its wire layout");
+
+static_assert(sizeof(OrderId) == sizeof(NewOrder::orderId), "order ids are copied as they are");
+
+// the size a message of the given type must have, 0 for an unknown type or
+// one whose size varies
+constexpr std::size_t MessageSize(MessageTypeEnum::Type messageType) noexcept {
+    switch (messageType) {
+        case MessageTypeEnum::NewOrder:
+            return sizeof(NewOrder);
+        case MessageTypeEnum::CancelOrder:
+            return sizeof(CancelOrder);
+        case MessageTypeEnum::ReplaceOrder:
+            return sizeof(ReplaceOrder);
+        case MessageTypeEnum::Trade:
+            return sizeof(Trade);
+        case MessageTypeEnum::CancelAck:
+            [[fallthrough]];
+        case MessageTypeEnum::ReplaceAck:
+            return sizeof(Ack);
+        case MessageTypeEnum::Reject:
+            return sizeof(Reject);
+        case MessageTypeEnum::Snapshot:
+            return sizeof(Snapshot);
+        case MessageTypeEnum::BookSnapshot:
+            return sizeof(BookSnapshot);
+        case MessageTypeEnum::RestingOrder:
+            return sizeof(RestingOrder);
+        case MessageTypeEnum::LevelUpdate:
+            return sizeof(LevelUpdate);
+        case MessageTypeEnum::OrderUpdate:
+            return sizeof(OrderUpdate);
+        default:
+            return 0;
+    }
+}
+
+}  // namespace wire
+
+// Conversions between the wire layouts and the messages the engine works with.
+//
+// ToWire always succeeds. FromWire checks everything in a corrupt or hostile
+// message it can check on its own (type, length, enum values, order id
+// encoding) and returns false without touching the result if any of it is off.
+// Symbol ids are left to whoever owns the registry they index.
+
+wire::NewOrder ToWire(const NewOrder &msg) noexcept;
+wire::CancelOrder ToWire(const CancelOrder &msg) noexcept;
+wire::ReplaceOrder ToWire(const ReplaceOrder &msg) noexcept;
+wire::Trade ToWire(const Trade &msg) noexcept;
+wire::Ack ToWire(const CancelAck &msg) noexcept;
+wire::Ack ToWire(const ReplaceAck &msg) noexcept;
+wire::Reject ToWire(const Reject &msg) noexcept;
+wire::RestingOrder ToWire(const Order &order) noexcept;
+wire::LevelUpdate ToWire(const LevelUpdate &msg) noexcept;
+wire::OrderUpdate ToWire(const OrderUpdate &msg) noexcept;
+
+bool FromWire(const wire::NewOrder &msg, NewOrder &result) noexcept;
+bool FromWire(const wire::CancelOrder &msg, CancelOrder &result) noexcept;
+bool FromWire(const wire::ReplaceOrder &msg, ReplaceOrder &result) noexcept;
+bool FromWire(const wire::Trade &msg, Trade &result) noexcept;
+bool FromWire(const wire::Ack &msg, CancelAck &result) noexcept;
+bool FromWire(const wire::Ack &msg, ReplaceAck &result) noexcept;
+bool FromWire(const wire::Reject &msg, Reject &result) noexcept;
+bool FromWire(const wire::LevelUpdate &msg, LevelUpdate &result) noexcept;
+bool FromWire(const wire::OrderUpdate &msg, OrderUpdate &result) noexcept;
+
+// a resting order as the new order it would rest as, and the sequence number
+// it rests under; the symbol is that of its book, which is left to the caller
+bool FromWire(const wire::RestingOrder &msg, NewOrder &result, unsigned long &sequenceNumber) noexcept;
+
+}  // namespace gemini
+
+#endif  // MATCHING_ENGINE__WIRE_MESSAGES_H
@@ -0,0 +1,173 @@
+#include "journal.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+
+namespace gemini {
+
+Journal::Journal(int fd, const SymbolRegistry &symbols, const JournalConfig &config)
+    : m_fd(fd),
+      m_config(config),
+      m_encoder(symbols),
+      m_pending(0),
+      m_entries(0),
+      m_bytesWritten(0),
+      m_syncs(0),
+      m_failed(false),
+      m_stop(false) {
+    // room for a full batch of the largest entries, definitions aside
+    m_buffer.reserve(m_config.batchMessages * (sizeof(wire::JournalEntry) + wire::MaxMessageSize));
+
+    if (m_config.fsyncPolicy == FsyncPolicyEnum::Deferred) {
+        m_syncThread = std::thread(&Journal::SyncPeriodically, this);
+    }
+}
+
+Journal::~Journal() {
+    if (m_syncThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_stopRequested.notify_one();
+        m_syncThread.join();
+    }
+
+    Commit();
+}
+
+bool Journal::Append(const MessageHeader &msg, unsigned long sequenceNumber) {
+    if (Failed()) {
+        return false;
+    }
+
+    auto entry = m_encoder.Encode(msg, sequenceNumber);
+    if (entry.empty()) {
+        // nothing the engine accepts fails to encode
+        m_failed.store(true, std::memory_order_relaxed);
+        return false;
+    }
+
+    auto lock = LockBuffer();
+    m_buffer.append(entry);
+    m_entries++;
+
+    if (m_config.fsyncPolicy == FsyncPolicyEnum::Always) {
+        return Write() && Sync();
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (m_pending++ == 0) {
+        m_oldestPending = now;
+    }
+    if (m_pending < m_config.batchMessages && now - m_oldestPending < m_config.batchInterval) {
+        return true;
+    }
+
+    if (!Write()) {
+        return false;
+    }
+    return m_config.fsyncPolicy == FsyncPolicyEnum::Batched ? Sync() : true;
+}
+
+bool Journal::Commit() {
+    {
+        auto lock = LockBuffer();
+        if (!Write()) {
+            return false;
+        }
+    }
+    return m_config.fsyncPolicy == FsyncPolicyEnum::Never ? true : Sync();
+}
+
+std::optional<std::chrono::steady_clock::time_point> Journal::CommitDeadline() const {
+    // what is pending is only ours to look at without a sync thread
+    if (m_syncThread.joinable() || m_pending == 0) {
+        return std::nullopt;
+    }
+    return m_oldestPending + m_config.batchInterval;
+}
+
+bool Journal::CommitIfDue() {
+    auto deadline = CommitDeadline();
+    if (!deadline || std::chrono::steady_clock::now() < *deadline) {
+        return !Failed();
+    }
+    return Commit();
+}
+
+bool Journal::Failed() const noexcept { return m_failed.load(std::memory_order_relaxed); }
+
+const JournalConfig &Journal::Config() const noexcept { return m_config; }
+
+unsigned long Journal::Entries() const noexcept { return m_entries; }
+
+unsigned long Journal::BytesWritten() const noexcept { return m_bytesWritten; }
+
+unsigned long Journal::Syncs() const noexcept { return m_syncs.load(std::memory_order_relaxed); }
+
+bool Journal::Write() {
+    if (Failed()) {
+        return false;
+    }
+
+    const char *data = m_buffer.data();
+    auto size = m_buffer.size();
+    while (size > 0) {
+        auto result = write(m_fd, data, size);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            m_failed.store(true, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto written = static_cast<std::size_t>(result);
+        data += written;
+        size -= written;
+        m_bytesWritten += written;
+    }
+
+    m_buffer.clear();
+    m_pending = 0;
+    return true;
+}
+
+bool Journal::Sync() {
+    if (Failed()) {
+        return false;
+    }
+
+    if (fdatasync(m_fd) != 0) {
+        m_failed.store(true, std::memory_order_relaxed);
+        return false;
+    }
+    m_syncs.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void Journal::SyncPeriodically() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopRequested.wait_for(lock, m_config.batchInterval, [this] { return m_stop; })) {
+        // writes what the calling thread has buffered, so no entry waits on
+        // the next append for longer than batchInterval
+        Write();
+
+        // the calling thread may append and write while this syncs, anything
+        // the sync misses is picked up next time
+        lock.unlock();
+        Sync();
+        lock.lock();
+    }
+}
+
+std::unique_lock<std::mutex> Journal::LockBuffer() {
+    if (m_syncThread.joinable()) {
+        return std::unique_lock<std::mutex>(m_mutex);
+    }
+    return std::unique_lock<std::mutex>();
+}
+
+}  // namespace gemini
@@ -0,0 +1,87 @@
+#include "line_reader.h"
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <utility>
+
+namespace gemini {
+
+LineReader::LineReader(int fd, std::size_t chunkSize)
+    : m_fd(fd), m_mapped(nullptr), m_mappedSize(0), m_lines(0), m_bytes(0) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        auto size = static_cast<std::size_t>(info.st_size);
+        auto *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            // lines are only ever read front to back
+            madvise(mapped, size, MADV_SEQUENTIAL);
+
+            m_mapped = static_cast<const char *>(mapped);
+            m_mappedSize = size;
+            return;
+        }
+    }
+
+    // not a regular file or it could not be mapped, fall back to streaming
+    m_buffer.resize(chunkSize);
+}
+
+LineReader::~LineReader() {
+    if (m_mapped != nullptr) {
+        munmap(const_cast<char *>(m_mapped), m_mappedSize);
+    }
+}
+
+bool LineReader::IsMapped() const noexcept { return m_mapped != nullptr; }
+
+void LineReader::SetIdleHandler(std::function<int()> idle) { m_idle = std::move(idle); }
+
+unsigned long LineReader::Lines() const noexcept { return m_lines; }
+
+unsigned long LineReader::Bytes() const noexcept { return m_bytes; }
+
+std::size_t LineReader::Fill(std::size_t used) {
+    // a single line longer than the buffer, make room for the rest of it
+    if (used == m_buffer.size()) {
+        m_buffer.resize(m_buffer.size() * 2);
+    }
+
+    WaitForInput();
+
+    for (;;) {
+        auto result = read(m_fd, m_buffer.data() + used, m_buffer.size() - used);
+        if (result >= 0) {
+            return static_cast<std::size_t>(result);
+        }
+        if (errno != EINTR) {
+            // treat a failed read as the end of the input
+            return 0;
+        }
+    }
+}
+
+void LineReader::WaitForInput() {
+    if (!m_idle) {
+        return;
+    }
+
+    pollfd input{m_fd, POLLIN, 0};
+    for (;;) {
+        auto timeout = m_idle();
+        if (timeout < 0) {
+            return;
+        }
+
+        // readable, at its end or failed, the read that follows finds out which
+        auto ready = poll(&input, 1, timeout);
+        if (ready > 0 || (ready < 0 && errno != EINTR)) {
+            return;
+        }
+    }
+}
+
+}  // namespace gemini
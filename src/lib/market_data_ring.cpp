@@ -0,0 +1,283 @@
+#include "market_data_ring.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace gemini {
+
+namespace {
+
+std::size_t RoundUp(std::size_t capacity) noexcept {
+    std::size_t result = 1;
+    while (result < capacity) {
+        result *= 2;
+    }
+    return result;
+}
+
+std::size_t SymbolsOffset() noexcept { return sizeof(ring::Header); }
+
+std::size_t SlotsOffset(std::size_t maxSymbols) noexcept {
+    return SymbolsOffset() + maxSymbols * sizeof(ring::SymbolName);
+}
+
+}  // namespace
+
+std::size_t MarketDataRingSize(const MarketDataRingConfig &config) noexcept {
+    return SlotsOffset(config.maxSymbols) + RoundUp(config.capacity) * sizeof(ring::Slot);
+}
+
+int OpenSharedMemory(const std::string &name, bool create) noexcept {
+    return shm_open(name.c_str(), create ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+}
+
+bool UnlinkSharedMemory(const std::string &name) noexcept { return shm_unlink(name.c_str()) == 0; }
+
+MarketDataWriter::MarketDataWriter(int fd, const MarketDataRingConfig &config)
+    : m_header(nullptr),
+      m_symbols(nullptr),
+      m_slots(nullptr),
+      m_size(0),
+      m_capacity(RoundUp(config.capacity)),
+      m_maxSymbols(config.maxSymbols),
+      m_sequenceNumber(0) {
+    MarketDataRingConfig rounded = config;
+    rounded.capacity = m_capacity;
+    auto size = MarketDataRingSize(rounded);
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        return;
+    }
+    auto *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        return;
+    }
+
+    auto *bytes = static_cast<char *>(mapped);
+    m_header = reinterpret_cast<ring::Header *>(bytes);
+    m_symbols = reinterpret_cast<ring::SymbolName *>(bytes + SymbolsOffset());
+    m_slots = reinterpret_cast<ring::Slot *>(bytes + SlotsOffset(m_maxSymbols));
+    m_size = size;
+
+    // whatever a previous writer left is cleared before the ring is announced,
+    // readers still mapping it from then have to open it again
+    m_header->magic.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memset(bytes + sizeof(m_header->magic), 0, size - sizeof(m_header->magic));
+
+    m_header->capacity = m_capacity;
+    m_header->maxSymbols = m_maxSymbols;
+    m_header->magic.store(ring::Magic, std::memory_order_release);
+}
+
+MarketDataWriter::~MarketDataWriter() {
+    if (m_header != nullptr) {
+        munmap(m_header, m_size);
+    }
+}
+
+bool MarketDataWriter::IsMapped() const noexcept { return m_header != nullptr; }
+
+bool MarketDataWriter::DefineSymbol(SymbolId symbol, std::string_view name) noexcept {
+    if (!IsMapped() || symbol >= m_maxSymbols || name.empty() || name.size() > ring::MaxSymbolName) {
+        return false;
+    }
+
+    // names never change, so a symbol is only ever written once
+    auto &entry = m_symbols[symbol];
+    if (entry.length.load(std::memory_order_relaxed) == 0) {
+        std::memcpy(entry.name, name.data(), name.size());
+        entry.length.store(static_cast<std::uint32_t>(name.size()), std::memory_order_release);
+    }
+    return true;
+}
+
+bool MarketDataWriter::IsDefined(SymbolId symbol) const noexcept {
+    return IsMapped() && symbol < m_maxSymbols && m_symbols[symbol].length.load(std::memory_order_relaxed) != 0;
+}
+
+void MarketDataWriter::Publish(const wire::Header &msg) noexcept {
+    if (!IsMapped()) {
+        return;
+    }
+
+    std::uint64_t words[ring::SlotWords] = {};
+    std::size_t length = msg.length < sizeof(words) ? msg.length : sizeof(words);
+    std::memcpy(words, &msg, length);
+
+    auto sequenceNumber = ++m_sequenceNumber;
+    auto &slot = m_slots[(sequenceNumber - 1) & (m_capacity - 1)];
+
+    slot.sequenceNumber.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for (std::size_t i = 0; i < ring::SlotWords; ++i) {
+        slot.words[i].store(words[i], std::memory_order_relaxed);
+    }
+
+    slot.sequenceNumber.store(sequenceNumber, std::memory_order_release);
+    m_header->head.store(sequenceNumber, std::memory_order_release);
+}
+
+unsigned long MarketDataWriter::SequenceNumber() const noexcept { return m_sequenceNumber; }
+
+std::size_t MarketDataWriter::Capacity() const noexcept { return m_capacity; }
+
+MarketDataReader::MarketDataReader(int fd)
+    : m_header(nullptr),
+      m_symbols(nullptr),
+      m_slots(nullptr),
+      m_size(0),
+      m_capacity(0),
+      m_maxSymbols(0),
+      m_next(1),
+      m_sequenceNumber(0),
+      m_missed(0),
+      m_message{} {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(ring::Header)) {
+        return;
+    }
+
+    auto size = static_cast<std::size_t>(info.st_size);
+    auto *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        return;
+    }
+
+    // the layout is only to be trusted once the writer has announced it, and
+    // only if it has not started over since, clearing the announcement first
+    auto *bytes = static_cast<const char *>(mapped);
+    auto *header = reinterpret_cast<const ring::Header *>(bytes);
+    MarketDataRingConfig config;
+    auto announced = header->magic.load(std::memory_order_acquire) == ring::Magic;
+    if (announced) {
+        config.capacity = header->capacity;
+        config.maxSymbols = header->maxSymbols;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        announced = header->magic.load(std::memory_order_relaxed) == ring::Magic;
+    }
+    if (!announced || config.capacity == 0 || RoundUp(config.capacity) != config.capacity ||
+        MarketDataRingSize(config) > size) {
+        munmap(mapped, size);
+        return;
+    }
+
+    m_header = header;
+    m_symbols = reinterpret_cast<const ring::SymbolName *>(bytes + SymbolsOffset());
+    m_slots = reinterpret_cast<const ring::Slot *>(bytes + SlotsOffset(config.maxSymbols));
+    m_size = size;
+    m_capacity = config.capacity;
+    m_maxSymbols = config.maxSymbols;
+    m_next = m_header->head.load(std::memory_order_acquire) + 1;
+}
+
+MarketDataReader::~MarketDataReader() {
+    if (m_header != nullptr) {
+        munmap(const_cast<ring::Header *>(m_header), m_size);
+    }
+}
+
+bool MarketDataReader::IsMapped() const noexcept { return m_header != nullptr; }
+
+RingReadStatusEnum::Type MarketDataReader::Read() noexcept {
+    if (!IsMapped()) {
+        return RingReadStatusEnum::Empty;
+    }
+    if (TryCopy(m_next)) {
+        return RingReadStatusEnum::Ok;
+    }
+
+    auto head = m_header->head.load(std::memory_order_acquire);
+    if (head < m_next) {
+        return RingReadStatusEnum::Empty;
+    }
+
+    // the message went into its slot before head moved past it, so if it is
+    // not there now it has been overwritten
+    if (TryCopy(m_next)) {
+        return RingReadStatusEnum::Ok;
+    }
+
+    m_missed += head + 1 - m_next;
+    m_next = head + 1;
+    return RingReadStatusEnum::Lapped;
+}
+
+bool MarketDataReader::TryCopy(unsigned long sequenceNumber) noexcept {
+    auto const &slot = m_slots[(sequenceNumber - 1) & (m_capacity - 1)];
+    if (slot.sequenceNumber.load(std::memory_order_acquire) != sequenceNumber) {
+        return false;
+    }
+
+    std::uint64_t words[ring::SlotWords];
+    for (std::size_t i = 0; i < ring::SlotWords; ++i) {
+        words[i] = slot.words[i].load(std::memory_order_relaxed);
+    }
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequenceNumber.load(std::memory_order_relaxed) != sequenceNumber) {
+        return false;
+    }
+
+    std::memcpy(m_message, words, sizeof(m_message));
+    m_sequenceNumber = sequenceNumber;
+    m_next = sequenceNumber + 1;
+    return true;
+}
+
+const wire::Header &MarketDataReader::Message() const noexcept {
+    return *reinterpret_cast<const wire::Header *>(m_message);
+}
+
+unsigned long MarketDataReader::SequenceNumber() const noexcept { return m_sequenceNumber; }
+
+unsigned long MarketDataReader::Missed() const noexcept { return m_missed; }
+
+std::string_view MarketDataReader::SymbolName(SymbolId symbol) const noexcept {
+    if (!IsMapped() || symbol >= m_maxSymbols) {
+        return {};
+    }
+
+    auto const &entry = m_symbols[symbol];
+    auto length = entry.length.load(std::memory_order_acquire);
+    if (length > ring::MaxSymbolName) {
+        return {};
+    }
+    return std::string_view(entry.name, length);
+}
+
+MarketDataPublisher::MarketDataPublisher(MarketDataWriter &writer, const SymbolRegistry &symbols)
+    : m_writer(&writer), m_symbols(&symbols) {}
+
+void MarketDataPublisher::operator()(TradeSpan trades) const {
+    for (auto const &trade : trades) {
+        Define(trade.symbol);
+        auto msg = ToWire(trade);
+        m_writer->Publish(msg.header);
+    }
+}
+
+void MarketDataPublisher::operator()(const LevelUpdate &update) const {
+    Define(update.symbol);
+    auto msg = ToWire(update);
+    m_writer->Publish(msg.header);
+}
+
+void MarketDataPublisher::operator()(const OrderUpdate &update) const {
+    Define(update.symbol);
+    auto msg = ToWire(update);
+    m_writer->Publish(msg.header);
+}
+
+void MarketDataPublisher::Define(SymbolId symbol) const {
+    if (!m_writer->IsDefined(symbol)) {
+        m_writer->DefineSymbol(symbol, m_symbols->Name(symbol));
+    }
+}
+
+}  // namespace gemini
@@ -1,5 +1,9 @@
 #include "order.h"
 
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
 namespace gemini {
 Order::Order(unsigned long sequenceNumber, const NewOrder &newOrder)
     : m_sequenceNumber(sequenceNumber),
@@ -11,9 +15,9 @@ Order::Order(unsigned long sequenceNumber, const NewOrder &newOrder)
 
 unsigned long Order::SequenceNumber() const noexcept { return m_sequenceNumber; }
 
-const std::string &Order::OrderId() const noexcept { return m_orderId; }
+const OrderId &Order::OrderId() const noexcept { return m_orderId; }
 
-const std::string &Order::Symbol() const noexcept { return m_symbol; }
+SymbolId Order::Symbol() const noexcept { return m_symbol; }
 
 SideEnum::Type Order::Side() const noexcept { return m_side; }
 
@@ -23,13 +27,46 @@ unsigned long Order::Quantity() const noexcept { return m_quantity; }
 
 void Order::DecreaseQuantity(unsigned long value) noexcept { m_quantity -= value; }
 
-std::string Order::ToString() const {
-    // 64 character string should be long enough
+void Order::Replace(unsigned long sequenceNumber, unsigned long quantity, unsigned long price) noexcept {
+    m_sequenceNumber = sequenceNumber;
+    m_quantity = quantity;
+    m_price = price;
+}
+
+void Order::FormatDumpLine(std::string_view symbolName, char *line) const noexcept {
+    std::memset(line, 0, DumpLineSize);
+
+    // room is left for the terminating NUL, as snprintf would
+    auto *out = line;
+    auto *end = line + DumpLineSize - 1;
+
+    auto put = [&](std::string_view text) {
+        auto count = std::min(text.size(), static_cast<std::size_t>(end - out));
+        std::memcpy(out, text.data(), count);
+        out += count;
+    };
+    auto putUnsigned = [&](unsigned long value) {
+        char digits[20];
+        auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        put(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+    };
+
+    put(m_orderId.View());
+    put(" ");
+    put(SideEnum::ToString(m_side));
+    put(" ");
+    put(symbolName);
+    put(" ");
+    putUnsigned(m_quantity);
+    put(" ");
+    putUnsigned(m_price);
+}
+
+std::string Order::ToString(const std::string &symbolName) const {
     std::string result;
-    result.resize(64);
+    result.resize(DumpLineSize);
 
-    snprintf(result.data(), result.size(), "%s %s %s %lu %lu", m_orderId.c_str(), SideEnum::ToString(m_side),
-             m_symbol.c_str(), m_quantity, m_price);
+    FormatDumpLine(symbolName, result.data());
 
     return result;
 }
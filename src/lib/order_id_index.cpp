@@ -0,0 +1,85 @@
+#include "order_id_index.h"
+
+namespace gemini {
+
+namespace {
+std::size_t CapacityFor(std::size_t expectedSize) {
+    std::size_t capacity = 16;
+    while (capacity < expectedSize * 2) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+}  // namespace
+
+OrderIdIndex::OrderIdIndex(std::size_t expectedSize) : m_mask(0), m_size(0) { Rehash(CapacityFor(expectedSize)); }
+
+OrderNode *OrderIdIndex::Find(const OrderId &orderId) const noexcept { return m_slots[FindSlot(orderId)].node; }
+
+bool OrderIdIndex::Insert(const OrderId &orderId, OrderNode *node) {
+    if ((m_size + 1) * 2 > m_slots.size()) {
+        Rehash(m_slots.size() * 2);
+    }
+
+    auto &slot = m_slots[FindSlot(orderId)];
+    if (slot.node != nullptr) {
+        return false;
+    }
+
+    slot.orderId = orderId;
+    slot.node = node;
+    m_size++;
+
+    return true;
+}
+
+bool OrderIdIndex::Erase(const OrderId &orderId) noexcept {
+    auto hole = FindSlot(orderId);
+    if (m_slots[hole].node == nullptr) {
+        return false;
+    }
+
+    // shift back any entry that probed past the hole, stopping at the first
+    // empty slot since nothing beyond it can have probed through here
+    for (auto next = (hole + 1) & m_mask; m_slots[next].node != nullptr; next = (next + 1) & m_mask) {
+        auto home = HomeSlot(m_slots[next].orderId);
+
+        // distance travelled by the entry vs distance from its home to the hole
+        if (((next - home) & m_mask) >= ((next - hole) & m_mask)) {
+            m_slots[hole] = m_slots[next];
+            hole = next;
+        }
+    }
+
+    m_slots[hole] = Slot{};
+    m_size--;
+
+    return true;
+}
+
+std::size_t OrderIdIndex::Size() const noexcept { return m_size; }
+
+std::size_t OrderIdIndex::HomeSlot(const OrderId &orderId) const noexcept { return orderId.Hash() & m_mask; }
+
+std::size_t OrderIdIndex::FindSlot(const OrderId &orderId) const noexcept {
+    // the table is never full, so the probe always ends
+    auto index = HomeSlot(orderId);
+    while (m_slots[index].node != nullptr && m_slots[index].orderId != orderId) {
+        index = (index + 1) & m_mask;
+    }
+    return index;
+}
+
+void OrderIdIndex::Rehash(std::size_t capacity) {
+    std::vector<Slot> slots(capacity);
+    std::swap(slots, m_slots);
+    m_mask = capacity - 1;
+
+    for (auto const &slot : slots) {
+        if (slot.node != nullptr) {
+            m_slots[FindSlot(slot.orderId)] = slot;
+        }
+    }
+}
+
+}  // namespace gemini
@@ -0,0 +1,66 @@
+#include "order_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace gemini {
+
+OrderPool::OrderPool(const OrderPoolConfig &config)
+    : m_config(config), m_freeList(nullptr), m_capacity(0), m_inUse(0), m_highWaterMark(0) {
+    Grow(m_config.initialCapacity);
+}
+
+OrderNode *OrderPool::Allocate(Order order) {
+    if (m_freeList == nullptr) {
+        if (m_config.growBy == 0) {
+            return nullptr;
+        }
+        Grow(m_config.growBy);
+    }
+
+    auto *slot = m_freeList;
+    m_freeList = slot->nextFree;
+
+    m_inUse++;
+    m_highWaterMark = std::max(m_highWaterMark, m_inUse);
+
+    return new (slot->storage) OrderNode(std::move(order));
+}
+
+void OrderPool::Free(OrderNode *node) noexcept {
+    assert(m_inUse > 0);
+
+    node->~OrderNode();
+
+    auto *slot = reinterpret_cast<Slot *>(node);
+    slot->nextFree = m_freeList;
+    m_freeList = slot;
+
+    m_inUse--;
+}
+
+std::size_t OrderPool::Capacity() const noexcept { return m_capacity; }
+
+std::size_t OrderPool::InUse() const noexcept { return m_inUse; }
+
+std::size_t OrderPool::HighWaterMark() const noexcept { return m_highWaterMark; }
+
+void OrderPool::Grow(std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+
+    std::unique_ptr<Slot[]> chunk{new Slot[count]};
+
+    // thread back to front so nodes are handed out in address order
+    for (std::size_t i = count; i > 0; --i) {
+        chunk[i - 1].nextFree = m_freeList;
+        m_freeList = &chunk[i - 1];
+    }
+
+    m_chunks.push_back(std::move(chunk));
+    m_capacity += count;
+}
+
+}  // namespace gemini
@@ -0,0 +1,97 @@
+#include "output_writer.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+
+namespace gemini {
+
+OutputWriter::OutputWriter(int fd, std::size_t capacity)
+    : m_fd(fd), m_buffer(std::max(capacity, MinCapacity)), m_used(0), m_bytesWritten(0) {}
+
+OutputWriter::~OutputWriter() { Flush(); }
+
+void OutputWriter::WriteTrade(std::string_view symbolName, const Trade &trade) {
+    Append("TRADE ");
+    Append(symbolName);
+    Append(' ');
+    Append(trade.orderId.View());
+    Append(' ');
+    Append(trade.contraOrderId.View());
+    Append(' ');
+    AppendUnsigned(trade.quantity);
+    Append(' ');
+    AppendUnsigned(trade.price);
+    Append('\n');
+}
+
+void OutputWriter::WriteCancelAck(std::string_view symbolName, const CancelAck &ack) {
+    Append("CANCELED ");
+    Append(symbolName);
+    Append(' ');
+    Append(ack.orderId.View());
+    Append(' ');
+    AppendUnsigned(ack.quantity);
+    Append(' ');
+    AppendUnsigned(ack.price);
+    Append('\n');
+}
+
+void OutputWriter::WriteReplaceAck(std::string_view symbolName, const ReplaceAck &ack) {
+    Append("REPLACED ");
+    Append(symbolName);
+    Append(' ');
+    Append(ack.orderId.View());
+    Append(' ');
+    AppendUnsigned(ack.quantity);
+    Append(' ');
+    AppendUnsigned(ack.price);
+    Append('\n');
+}
+
+void OutputWriter::WriteReject(std::string_view symbolName, const Reject &reject) {
+    Append("REJECTED ");
+    Append(symbolName);
+    Append(' ');
+    Append(reject.orderId.View());
+    Append(' ');
+    Append(RejectReasonEnum::ToString(reject.reason));
+    Append('\n');
+}
+
+void OutputWriter::WriteOrder(std::string_view symbolName, const Order &order) {
+    Reserve(Order::DumpLineSize + 1);
+
+    order.FormatDumpLine(symbolName, m_buffer.data() + m_used);
+    m_used += Order::DumpLineSize;
+    m_buffer[m_used++] = '\n';
+}
+
+bool OutputWriter::Flush() {
+    auto ok = WriteAll(m_buffer.data(), m_used);
+    m_used = 0;
+    return ok;
+}
+
+unsigned long OutputWriter::BytesWritten() const noexcept { return m_bytesWritten; }
+
+bool OutputWriter::WriteAll(const char *data, std::size_t size) {
+    while (size > 0) {
+        auto result = write(m_fd, data, size);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        auto written = static_cast<std::size_t>(result);
+        data += written;
+        size -= written;
+        m_bytesWritten += written;
+    }
+    return true;
+}
+
+}  // namespace gemini
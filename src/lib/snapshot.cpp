@@ -0,0 +1,168 @@
+#include "snapshot.h"
+
+#include <sys/stat.h>
+
+namespace gemini {
+
+SnapshotWriter::SnapshotWriter(int fd, const SymbolRegistry &symbols) : m_writer(fd), m_encoder(symbols), m_bytes(0) {}
+
+void SnapshotWriter::WriteHeader(unsigned long sequenceNumber, std::size_t numBooks) {
+    wire::Snapshot header{};
+    header.header.messageType = MessageTypeEnum::Snapshot;
+    header.header.length = sizeof(header);
+    header.numBooks = static_cast<std::uint32_t>(numBooks);
+    header.sequenceNumber = sequenceNumber;
+
+    Append(header);
+}
+
+bool SnapshotWriter::Flush() { return m_writer.Flush() && m_writer.BytesWritten() == m_bytes; }
+
+bool SnapshotWriter::WriteBookHeader(SymbolId symbol, const OrderBookConfig &config, std::size_t numOrders) {
+    std::string_view definitions;
+    if (!m_encoder.EncodeDefinitions(symbol, definitions)) {
+        return false;
+    }
+    m_writer.Append(definitions);
+    m_bytes += definitions.size();
+
+    wire::BookSnapshot book{};
+    book.header.messageType = MessageTypeEnum::BookSnapshot;
+    book.header.length = sizeof(book);
+    book.symbol = symbol;
+    book.basePrice = config.basePrice;
+    book.tickSize = config.tickSize;
+    book.numLevels = config.numLevels;
+    book.poolCapacity = config.pool.initialCapacity;
+    book.poolGrowBy = config.pool.growBy;
+    book.numOrders = numOrders;
+    book.bookType = static_cast<std::uint8_t>(config.bookType);
+
+    Append(book);
+    return true;
+}
+
+void SnapshotWriter::WriteOrder(const Order &order) { Append(ToWire(order)); }
+
+template <typename Wire>
+void SnapshotWriter::Append(const Wire &msg) {
+    m_writer.Append(std::string_view(reinterpret_cast<const char *>(&msg), sizeof(msg)));
+    m_bytes += sizeof(msg);
+}
+
+SnapshotReader::SnapshotReader(int fd, SymbolRegistry &symbols)
+    : m_reader(fd),
+      m_size(MaxBookCapacity * sizeof(wire::RestingOrder)),
+      m_parser(symbols),
+      m_started(false),
+      m_sequenceNumber(0),
+      m_numBooks(0),
+      m_booksRead(0),
+      m_symbol(0),
+      m_numOrders(0),
+      m_ordersRead(0),
+      m_orderSequenceNumber(0) {
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        m_size = static_cast<unsigned long>(info.st_size);
+    }
+}
+
+unsigned long SnapshotReader::SequenceNumber() const noexcept { return m_sequenceNumber; }
+
+MessageTypeEnum::Type SnapshotReader::ParseFrame(const wire::Header &frame) {
+    // the header comes first and only once
+    if (!m_started) {
+        return frame.messageType == MessageTypeEnum::Snapshot ? ParseSnapshot(frame) : MessageTypeEnum::Unknown;
+    }
+
+    switch (frame.messageType) {
+        case MessageTypeEnum::SymbolDefinition:
+            return m_parser.Parse(frame) == ParseStatusEnum::Definition ? MessageTypeEnum::SymbolDefinition
+                                                                         : MessageTypeEnum::Unknown;
+        case MessageTypeEnum::BookSnapshot:
+            return ParseBookSnapshot(frame);
+        case MessageTypeEnum::RestingOrder:
+            return ParseRestingOrder(frame);
+        default:
+            return MessageTypeEnum::Unknown;
+    }
+}
+
+MessageTypeEnum::Type SnapshotReader::ParseSnapshot(const wire::Header &frame) {
+    if (frame.length != sizeof(wire::Snapshot)) {
+        return MessageTypeEnum::Unknown;
+    }
+
+    // the header is the first member of the message, so shares its address
+    auto const &header = *reinterpret_cast<const wire::Snapshot *>(&frame);
+
+    m_started = true;
+    m_sequenceNumber = header.sequenceNumber;
+    m_numBooks = header.numBooks;
+    return MessageTypeEnum::Snapshot;
+}
+
+MessageTypeEnum::Type SnapshotReader::ParseBookSnapshot(const wire::Header &frame) {
+    if (frame.length != sizeof(wire::BookSnapshot) || m_booksRead == m_numBooks || m_ordersRead != m_numOrders) {
+        return MessageTypeEnum::Unknown;
+    }
+
+    auto const &book = *reinterpret_cast<const wire::BookSnapshot *>(&frame);
+    if (!m_parser.FindSymbol(book.symbol, m_symbol)) {
+        return MessageTypeEnum::Unknown;
+    }
+
+    // the orders must follow, and nothing is allocated for more than fits
+    auto bytesLeft = m_size > m_reader.Bytes() ? m_size - m_reader.Bytes() : 0;
+    if (book.numOrders > bytesLeft / sizeof(wire::RestingOrder) || book.numLevels > MaxBookCapacity ||
+        book.poolCapacity > MaxBookCapacity || book.poolGrowBy > MaxBookCapacity) {
+        return MessageTypeEnum::Unknown;
+    }
+
+    switch (book.bookType) {
+        case BookTypeEnum::Map:
+            break;
+        case BookTypeEnum::Ladder:
+            if (book.tickSize == 0) {
+                return MessageTypeEnum::Unknown;
+            }
+            break;
+        default:
+            return MessageTypeEnum::Unknown;
+    }
+
+    m_config = OrderBookConfig{};
+    m_config.bookType = static_cast<BookTypeEnum::Type>(book.bookType);
+    m_config.basePrice = book.basePrice;
+    m_config.tickSize = book.tickSize;
+    m_config.numLevels = book.numLevels;
+    m_config.pool.initialCapacity = book.poolCapacity;
+    m_config.pool.growBy = book.poolGrowBy;
+
+    m_numOrders = book.numOrders;
+    m_ordersRead = 0;
+    m_booksRead++;
+    return MessageTypeEnum::BookSnapshot;
+}
+
+MessageTypeEnum::Type SnapshotReader::ParseRestingOrder(const wire::Header &frame) {
+    if (frame.length != sizeof(wire::RestingOrder) || m_booksRead == 0 || m_ordersRead == m_numOrders) {
+        return MessageTypeEnum::Unknown;
+    }
+
+    auto const &order = *reinterpret_cast<const wire::RestingOrder *>(&frame);
+    if (!FromWire(order, m_order, m_orderSequenceNumber) || m_orderSequenceNumber > m_sequenceNumber) {
+        return MessageTypeEnum::Unknown;
+    }
+
+    m_order.symbol = m_symbol;
+    m_ordersRead++;
+    return MessageTypeEnum::RestingOrder;
+}
+
+bool SnapshotReader::Complete() const noexcept {
+    return m_started && m_booksRead == m_numBooks && m_ordersRead == m_numOrders;
+}
+
+}  // namespace gemini
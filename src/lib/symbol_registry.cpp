@@ -0,0 +1,29 @@
+#include "symbol_registry.h"
+
+#include <cassert>
+
+namespace gemini {
+
+SymbolId SymbolRegistry::Intern(std::string_view symbol) {
+    auto it = m_ids.find(symbol);
+    if (it != m_ids.end()) {
+        return it->second;
+    }
+
+    auto id = static_cast<SymbolId>(m_names.size());
+    auto const &name = m_names.emplace_back(symbol);
+    m_ids.emplace(name, id);
+
+    return id;
+}
+
+bool SymbolRegistry::Contains(SymbolId id) const noexcept { return id < m_names.size(); }
+
+const std::string &SymbolRegistry::Name(SymbolId id) const {
+    assert(Contains(id));
+    return m_names[id];
+}
+
+std::size_t SymbolRegistry::Size() const noexcept { return m_names.size(); }
+
+}  // namespace gemini
@@ -0,0 +1,158 @@
+#include "text_parser.h"
+
+#include <cassert>
+#include <charconv>
+
+namespace gemini {
+
+namespace {
+
+// new orders are written as "<orderId> <side> <symbol> <quantity> <price> [<timeInForce>]",
+// with MARKET for the price of a market order
+enum NewOrderFieldIndex {
+    NewOrderId = 0,
+    NewOrderSide = 1,
+    NewOrderSymbol = 2,
+    NewOrderQuantity = 3,
+    NewOrderPrice = 4,
+    NewOrderTimeInForce = 5,
+};
+
+// cancels are written as "<orderId> CANCEL <symbol>"
+enum CancelOrderFieldIndex {
+    CancelOrderId = 0,
+    CancelAction = 1,
+    CancelSymbol = 2,
+};
+
+// replaces are written as "<orderId> REPLACE <symbol> <quantity> <price>"
+enum ReplaceOrderFieldIndex {
+    ReplaceOrderId = 0,
+    ReplaceAction = 1,
+    ReplaceSymbol = 2,
+    ReplaceQuantity = 3,
+    ReplacePrice = 4,
+};
+
+constexpr bool IsSpace(char c) noexcept {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+}  // namespace
+
+TextFields SplitFields(std::string_view line) noexcept {
+    TextFields result;
+
+    std::size_t pos = 0;
+    while (result.count < TextFields::Capacity) {
+        while (pos < line.size() && IsSpace(line[pos])) {
+            pos++;
+        }
+        if (pos == line.size()) {
+            break;
+        }
+
+        auto start = pos;
+        while (pos < line.size() && !IsSpace(line[pos])) {
+            pos++;
+        }
+        result.fields[result.count++] = line.substr(start, pos - start);
+    }
+
+    return result;
+}
+
+bool ParseUnsigned(std::string_view field, unsigned long &value) noexcept {
+    auto *end = field.data() + field.size();
+    auto [ptr, ec] = std::from_chars(field.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+TextParser::TextParser(SymbolRegistry &symbols) : m_symbols(symbols), m_message(nullptr) {}
+
+ParseStatusEnum::Type TextParser::Parse(std::string_view line) {
+    auto fields = SplitFields(line);
+    if (fields.count == 0) {
+        return ParseStatusEnum::Blank;
+    }
+
+    auto isCancel = fields.count == 3 && fields.fields[CancelAction] == "CANCEL";
+    if (fields.count != 5 && fields.count != 6 && !isCancel) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    // every message starts with the order id
+    if (!OrderId::Fits(fields.fields[0])) {
+        return ParseStatusEnum::OrderIdTooLong;
+    }
+
+    if (isCancel) {
+        return ParseCancelOrder(fields);
+    }
+    if (fields.fields[ReplaceAction] == "REPLACE") {
+        return fields.count == 5 ? ParseReplaceOrder(fields) : ParseStatusEnum::Malformed;
+    }
+    return ParseNewOrder(fields);
+}
+
+const MessageHeader &TextParser::Message() const noexcept {
+    assert(m_message != nullptr);
+    return *m_message;
+}
+
+ParseStatusEnum::Type TextParser::ParseNewOrder(const TextFields &fields) {
+    m_newOrder.side = SideEnum::FromString(fields.fields[NewOrderSide]);
+    if (m_newOrder.side == SideEnum::Unknown) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    if (!ParseUnsigned(fields.fields[NewOrderQuantity], m_newOrder.quantity)) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    if (fields.fields[NewOrderPrice] == "MARKET") {
+        m_newOrder.orderType = OrderTypeEnum::Market;
+        m_newOrder.price = 0;
+    } else if (ParseUnsigned(fields.fields[NewOrderPrice], m_newOrder.price)) {
+        m_newOrder.orderType = OrderTypeEnum::Limit;
+    } else {
+        return ParseStatusEnum::Malformed;
+    }
+
+    m_newOrder.timeInForce = TimeInForceEnum::GoodTillCancel;
+    if (fields.count == 6) {
+        m_newOrder.timeInForce = TimeInForceEnum::FromString(fields.fields[NewOrderTimeInForce]);
+        if (m_newOrder.timeInForce == TimeInForceEnum::Unknown) {
+            return ParseStatusEnum::Malformed;
+        }
+    }
+
+    m_newOrder.orderId = OrderId(fields.fields[NewOrderId]);
+    m_newOrder.symbol = m_symbols.Intern(fields.fields[NewOrderSymbol]);
+
+    m_message = &m_newOrder;
+    return ParseStatusEnum::Ok;
+}
+
+ParseStatusEnum::Type TextParser::ParseCancelOrder(const TextFields &fields) {
+    m_cancelOrder.orderId = OrderId(fields.fields[CancelOrderId]);
+    m_cancelOrder.symbol = m_symbols.Intern(fields.fields[CancelSymbol]);
+
+    m_message = &m_cancelOrder;
+    return ParseStatusEnum::Ok;
+}
+
+ParseStatusEnum::Type TextParser::ParseReplaceOrder(const TextFields &fields) {
+    if (!ParseUnsigned(fields.fields[ReplaceQuantity], m_replaceOrder.quantity) ||
+        !ParseUnsigned(fields.fields[ReplacePrice], m_replaceOrder.price)) {
+        return ParseStatusEnum::Malformed;
+    }
+
+    m_replaceOrder.orderId = OrderId(fields.fields[ReplaceOrderId]);
+    m_replaceOrder.symbol = m_symbols.Intern(fields.fields[ReplaceSymbol]);
+
+    m_message = &m_replaceOrder;
+    return ParseStatusEnum::Ok;
+}
+
+}  // namespace gemini
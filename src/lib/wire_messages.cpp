@@ -0,0 +1,342 @@
+#include "wire_messages.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace gemini {
+
+namespace {
+
+template <typename Wire>
+Wire Construct(MessageTypeEnum::Type messageType) noexcept {
+    // there are no gaps between fields, so this zeroes every byte
+    Wire msg{};
+    msg.header.messageType = static_cast<std::uint8_t>(messageType);
+    msg.header.length = static_cast<std::uint16_t>(sizeof(Wire));
+    return msg;
+}
+
+template <typename Wire>
+bool HasHeader(const Wire &msg, MessageTypeEnum::Type messageType) noexcept {
+    return msg.header.messageType == messageType && msg.header.length == sizeof(Wire);
+}
+
+void CopyOrderId(const OrderId &orderId, char (&bytes)[16]) noexcept {
+    std::memcpy(bytes, orderId.Data(), sizeof(bytes));
+}
+
+// the bytes must be as OrderId keeps them, or comparisons would go wrong
+bool ParseOrderId(const char (&bytes)[16], OrderId &orderId) noexcept {
+    auto size = static_cast<unsigned char>(bytes[OrderId::Capacity]);
+    if (size > OrderId::Capacity) {
+        return false;
+    }
+    for (auto i = std::size_t{size}; i < OrderId::Capacity; ++i) {
+        if (bytes[i] != '\0') {
+            return false;
+        }
+    }
+
+    orderId = OrderId(std::string_view(bytes, size));
+    return true;
+}
+
+bool ParseSide(std::uint8_t value, SideEnum::Type &side) noexcept {
+    if (value != SideEnum::Buy && value != SideEnum::Sell) {
+        return false;
+    }
+    side = static_cast<SideEnum::Type>(value);
+    return true;
+}
+
+// zero is taken as the default, so messages written before there was a choice still read
+bool ParseOrderType(std::uint8_t value, OrderTypeEnum::Type &orderType) noexcept {
+    switch (value) {
+        case 0:
+            orderType = OrderTypeEnum::Limit;
+            return true;
+        case OrderTypeEnum::Limit:
+        case OrderTypeEnum::Market:
+            orderType = static_cast<OrderTypeEnum::Type>(value);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ParseTimeInForce(std::uint8_t value, TimeInForceEnum::Type &timeInForce) noexcept {
+    switch (value) {
+        case 0:
+            timeInForce = TimeInForceEnum::GoodTillCancel;
+            return true;
+        case TimeInForceEnum::GoodTillCancel:
+        case TimeInForceEnum::ImmediateOrCancel:
+        case TimeInForceEnum::FillOrKill:
+            timeInForce = static_cast<TimeInForceEnum::Type>(value);
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool ParseOrderUpdateType(std::uint8_t value, OrderUpdateTypeEnum::Type &updateType) noexcept {
+    switch (value) {
+        case OrderUpdateTypeEnum::Add:
+        case OrderUpdateTypeEnum::Fill:
+        case OrderUpdateTypeEnum::Reduce:
+        case OrderUpdateTypeEnum::Delete:
+            updateType = static_cast<OrderUpdateTypeEnum::Type>(value);
+            return true;
+        default:
+            return false;
+    }
+}
+
+template <typename Ack>
+wire::Ack AckToWire(const Ack &msg) noexcept {
+    auto result = Construct<wire::Ack>(msg.messageType);
+    result.symbol = msg.symbol;
+    CopyOrderId(msg.orderId, result.orderId);
+    result.quantity = msg.quantity;
+    result.price = msg.price;
+    result.side = static_cast<std::uint8_t>(msg.side);
+    return result;
+}
+
+template <typename Ack>
+bool AckFromWire(const wire::Ack &msg, Ack &result) noexcept {
+    Ack ack;
+    if (!HasHeader(msg, ack.messageType) || !ParseOrderId(msg.orderId, ack.orderId) || !ParseSide(msg.side, ack.side)) {
+        return false;
+    }
+    ack.symbol = msg.symbol;
+    ack.quantity = msg.quantity;
+    ack.price = msg.price;
+
+    result = ack;
+    return true;
+}
+
+}  // namespace
+
+wire::NewOrder ToWire(const NewOrder &msg) noexcept {
+    auto result = Construct<wire::NewOrder>(MessageTypeEnum::NewOrder);
+    result.symbol = msg.symbol;
+    CopyOrderId(msg.orderId, result.orderId);
+    result.quantity = msg.quantity;
+    result.price = msg.price;
+    result.side = static_cast<std::uint8_t>(msg.side);
+    result.orderType = static_cast<std::uint8_t>(msg.orderType);
+    result.timeInForce = static_cast<std::uint8_t>(msg.timeInForce);
+    return result;
+}
+
+wire::CancelOrder ToWire(const CancelOrder &msg) noexcept {
+    auto result = Construct<wire::CancelOrder>(MessageTypeEnum::CancelOrder);
+    result.symbol = msg.symbol;
+    CopyOrderId(msg.orderId, result.orderId);
+    return result;
+}
+
+wire::ReplaceOrder ToWire(const ReplaceOrder &msg) noexcept {
+    auto result = Construct<wire::ReplaceOrder>(MessageTypeEnum::ReplaceOrder);
+    result.symbol = msg.symbol;
+    CopyOrderId(msg.orderId, result.orderId);
+    result.quantity = msg.quantity;
+    result.price = msg.price;
+    return result;
+}
+
+wire::Trade ToWire(const Trade &msg) noexcept {
+    auto result = Construct<wire::Trade>(MessageTypeEnum::Trade);
+    result.symbol = msg.symbol;
+    CopyOrderId(msg.orderId, result.orderId);
+    CopyOrderId(msg.contraOrderId, result.contraOrderId);
+    result.quantity = msg.quantity;
+    result.price = msg.price;
+    return result;
+}
+
+wire::Ack ToWire(const CancelAck &msg) noexcept { return AckToWire(msg); }
+
+wire::Ack ToWire(const ReplaceAck &msg) noexcept { return AckToWire(msg); }
+
+wire::Reject ToWire(const Reject &msg) noexcept {
+    auto result = Construct<wire::Reject>(MessageTypeEnum::Reject);
+    result.symbol = msg.symbol;
+    CopyOrderId(msg.orderId, result.orderId);
+    result.rejectedMessageType = static_cast<std::uint8_t>(msg.rejectedMessageType);
+    result.reason = static_cast<std::uint8_t>(msg.reason);
+    return result;
+}
+
+wire::RestingOrder ToWire(const Order &order) noexcept {
+    auto result = Construct<wire::RestingOrder>(MessageTypeEnum::RestingOrder);
+    result.side = static_cast<std::uint8_t>(order.Side());
+    CopyOrderId(order.OrderId(), result.orderId);
+    result.sequenceNumber = order.SequenceNumber();
+    result.quantity = order.Quantity();
+    result.price = order.Price();
+    return result;
+}
+
+wire::LevelUpdate ToWire(const LevelUpdate &msg) noexcept {
+    auto result = Construct<wire::LevelUpdate>(MessageTypeEnum::LevelUpdate);
+    result.symbol = msg.symbol;
+    result.price = msg.price;
+    result.quantity = msg.quantity;
+    result.numOrders = msg.numOrders;
+    result.side = static_cast<std::uint8_t>(msg.side);
+    return result;
+}
+
+wire::OrderUpdate ToWire(const OrderUpdate &msg) noexcept {
+    auto result = Construct<wire::OrderUpdate>(MessageTypeEnum::OrderUpdate);
+    result.symbol = msg.symbol;
+    result.sequenceNumber = msg.sequenceNumber;
+    CopyOrderId(msg.orderId, result.orderId);
+    result.price = msg.price;
+    result.quantity = msg.quantity;
+    result.updateType = static_cast<std::uint8_t>(msg.updateType);
+    result.side = static_cast<std::uint8_t>(msg.side);
+    return result;
+}
+
+bool FromWire(const wire::NewOrder &msg, NewOrder &result) noexcept {
+    NewOrder newOrder;
+    if (!HasHeader(msg, MessageTypeEnum::NewOrder) || !ParseOrderId(msg.orderId, newOrder.orderId) ||
+        !ParseSide(msg.side, newOrder.side) || !ParseOrderType(msg.orderType, newOrder.orderType) ||
+        !ParseTimeInForce(msg.timeInForce, newOrder.timeInForce)) {
+        return false;
+    }
+    newOrder.symbol = msg.symbol;
+    newOrder.quantity = msg.quantity;
+    newOrder.price = msg.price;
+
+    result = newOrder;
+    return true;
+}
+
+bool FromWire(const wire::CancelOrder &msg, CancelOrder &result) noexcept {
+    CancelOrder cancelOrder;
+    if (!HasHeader(msg, MessageTypeEnum::CancelOrder) || !ParseOrderId(msg.orderId, cancelOrder.orderId)) {
+        return false;
+    }
+    cancelOrder.symbol = msg.symbol;
+
+    result = cancelOrder;
+    return true;
+}
+
+bool FromWire(const wire::ReplaceOrder &msg, ReplaceOrder &result) noexcept {
+    ReplaceOrder replaceOrder;
+    if (!HasHeader(msg, MessageTypeEnum::ReplaceOrder) || !ParseOrderId(msg.orderId, replaceOrder.orderId)) {
+        return false;
+    }
+    replaceOrder.symbol = msg.symbol;
+    replaceOrder.quantity = msg.quantity;
+    replaceOrder.price = msg.price;
+
+    result = replaceOrder;
+    return true;
+}
+
+bool FromWire(const wire::Trade &msg, Trade &result) noexcept {
+    Trade trade;
+    if (!HasHeader(msg, MessageTypeEnum::Trade) || !ParseOrderId(msg.orderId, trade.orderId) ||
+        !ParseOrderId(msg.contraOrderId, trade.contraOrderId)) {
+        return false;
+    }
+    trade.symbol = msg.symbol;
+    trade.quantity = msg.quantity;
+    trade.price = msg.price;
+
+    result = trade;
+    return true;
+}
+
+bool FromWire(const wire::Ack &msg, CancelAck &result) noexcept { return AckFromWire(msg, result); }
+
+bool FromWire(const wire::Ack &msg, ReplaceAck &result) noexcept { return AckFromWire(msg, result); }
+
+bool FromWire(const wire::Reject &msg, Reject &result) noexcept {
+    Reject reject;
+    if (!HasHeader(msg, MessageTypeEnum::Reject) || !ParseOrderId(msg.orderId, reject.orderId)) {
+        return false;
+    }
+
+    switch (msg.rejectedMessageType) {
+        case MessageTypeEnum::NewOrder:
+        case MessageTypeEnum::CancelOrder:
+        case MessageTypeEnum::ReplaceOrder:
+            reject.rejectedMessageType = static_cast<MessageTypeEnum::Type>(msg.rejectedMessageType);
+            break;
+        default:
+            return false;
+    }
+
+    switch (msg.reason) {
+        case RejectReasonEnum::UnknownOrder:
+        case RejectReasonEnum::DuplicateOrderId:
+        case RejectReasonEnum::PriceNotHeld:
+        case RejectReasonEnum::BookFull:
+        case RejectReasonEnum::InvalidQuantity:
+        case RejectReasonEnum::InsufficientQuantity:
+        case RejectReasonEnum::JournalFailed:
+            reject.reason = static_cast<RejectReasonEnum::Type>(msg.reason);
+            break;
+        default:
+            return false;
+    }
+
+    reject.symbol = msg.symbol;
+
+    result = reject;
+    return true;
+}
+
+bool FromWire(const wire::LevelUpdate &msg, LevelUpdate &result) noexcept {
+    LevelUpdate update;
+    if (!HasHeader(msg, MessageTypeEnum::LevelUpdate) || !ParseSide(msg.side, update.side)) {
+        return false;
+    }
+    update.symbol = msg.symbol;
+    update.price = msg.price;
+    update.quantity = msg.quantity;
+    update.numOrders = msg.numOrders;
+
+    result = update;
+    return true;
+}
+
+bool FromWire(const wire::OrderUpdate &msg, OrderUpdate &result) noexcept {
+    OrderUpdate update;
+    if (!HasHeader(msg, MessageTypeEnum::OrderUpdate) || !ParseOrderId(msg.orderId, update.orderId) ||
+        !ParseOrderUpdateType(msg.updateType, update.updateType) || !ParseSide(msg.side, update.side)) {
+        return false;
+    }
+    update.symbol = msg.symbol;
+    update.sequenceNumber = msg.sequenceNumber;
+    update.price = msg.price;
+    update.quantity = msg.quantity;
+
+    result = update;
+    return true;
+}
+
+bool FromWire(const wire::RestingOrder &msg, NewOrder &result, unsigned long &sequenceNumber) noexcept {
+    NewOrder newOrder;
+    if (!HasHeader(msg, MessageTypeEnum::RestingOrder) || !ParseOrderId(msg.orderId, newOrder.orderId) ||
+        !ParseSide(msg.side, newOrder.side)) {
+        return false;
+    }
+    newOrder.symbol = 0;
+    newOrder.quantity = msg.quantity;
+    newOrder.price = msg.price;
+
+    result = newOrder;
+    sequenceNumber = msg.sequenceNumber;
+    return true;
+}
+
+}  // namespace gemini
@@ -0,0 +1,43 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+std::atomic<std::size_t> allocationCount{0};
+
+void *CountedAllocate(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    auto *result = std::malloc(size == 0 ? 1 : size);
+    if (result == nullptr) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+// the nothrow forms must come from the same heap, or the replaced delete would
+// free what the library's own nothrow new allocated
+void *CountedAllocate(std::size_t size, const std::nothrow_t &) noexcept {
+    try {
+        return CountedAllocate(size);
+    } catch (const std::bad_alloc &) {
+        return nullptr;
+    }
+}
+}  // namespace
+
+std::size_t AllocationCount() noexcept { return allocationCount.load(std::memory_order_relaxed); }
+
+void *operator new(std::size_t size) { return CountedAllocate(size); }
+void *operator new[](std::size_t size) { return CountedAllocate(size); }
+void *operator new(std::size_t size, const std::nothrow_t &tag) noexcept { return CountedAllocate(size, tag); }
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return CountedAllocate(size, tag); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
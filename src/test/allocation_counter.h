@@ -0,0 +1,10 @@
+#ifndef MATCHING_ENGINE__ALLOCATION_COUNTER_H
+#define MATCHING_ENGINE__ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+// the test binary replaces the global operator new, every allocation made by
+// any thread bumps this count
+std::size_t AllocationCount() noexcept;
+
+#endif  // MATCHING_ENGINE__ALLOCATION_COUNTER_H
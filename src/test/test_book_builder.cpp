@@ -0,0 +1,242 @@
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "book_builder.h"
+#include "catch.hpp"
+#include "matching_engine.h"
+#include "test_helpers.h"
+#include "wire_messages.h"
+
+using namespace gemini;
+
+namespace {
+
+OrderUpdate ConstructOrderUpdate(OrderUpdateTypeEnum::Type updateType, unsigned long sequenceNumber,
+                                 const char *orderId, SideEnum::Type side, unsigned long quantity,
+                                 unsigned long price) {
+    OrderUpdate update;
+    update.updateType = updateType;
+    update.symbol = 0;
+    update.sequenceNumber = sequenceNumber;
+    update.orderId = OrderId(orderId);
+    update.side = side;
+    update.quantity = quantity;
+    update.price = price;
+    return update;
+}
+
+// records order updates as "TYPE sequenceNumber orderId SIDE quantity price"
+struct OrderRecorder {
+    std::vector<std::string> *updates;
+
+    void operator()(const LevelUpdate &) const {}
+    void operator()(const OrderUpdate &update) const {
+        updates->push_back(std::string(OrderUpdateTypeEnum::ToString(update.updateType)) + ' ' +
+                           std::to_string(update.sequenceNumber) + ' ' + std::string(update.orderId.View()) + ' ' +
+                           SideEnum::ToString(update.side) + ' ' + std::to_string(update.quantity) + ' ' +
+                           std::to_string(update.price));
+    }
+};
+
+// feeds order updates to a builder through their wire layout, as a reader of
+// the feed would get them, and counts any the builder refuses
+struct BuilderFeed {
+    BookBuilder *builder;
+    unsigned long *refused;
+
+    void operator()(const LevelUpdate &) const {}
+    void operator()(const OrderUpdate &update) const {
+        auto msg = ToWire(update);
+        OrderUpdate decoded;
+        if (!FromWire(msg, decoded) || !builder->Apply(decoded)) {
+            (*refused)++;
+        }
+    }
+};
+
+using Engine = BasicMatchingEngine<std::function<void(const MessageHeader &)>, OrderRecorder>;
+
+}  // namespace
+
+TEST_CASE("Test order updates follow every change to a resting order", "[bookbuilder]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<std::string> updates;
+    Engine engine(TestSymbols(), [](const MessageHeader &) {}, OrderRecorder{&updates});
+    engine.ConfigureSymbol(TestSymbols().Intern("L3USD"), ConstructBookConfig(bookType));
+
+    engine.OnMessage(ConstructNewOrder("1", "L3USD", SideEnum::Sell, 10, 1100));
+    engine.OnMessage(ConstructNewOrder("2", "L3USD", SideEnum::Sell, 5, 1100));
+    engine.OnMessage(ConstructNewOrder("3", "L3USD", SideEnum::Sell, 7, 1101));
+    REQUIRE(updates == std::vector<std::string>{"ADD 1 1 SELL 10 1100", "ADD 2 2 SELL 5 1100", "ADD 3 3 SELL 7 1101"});
+    updates.clear();
+
+    // fills the first order, part of the second and rests the rest of itself
+    engine.OnMessage(ConstructNewOrder("4", "L3USD", SideEnum::Buy, 14, 1100));
+    engine.OnMessage(ConstructNewOrder("5", "L3USD", SideEnum::Buy, 3, 1100));
+    REQUIRE(updates == std::vector<std::string>{"FILL 1 1 SELL 10 1100", "FILL 2 2 SELL 4 1100", "FILL 2 2 SELL 1 1100",
+                                                "ADD 5 5 BUY 2 1100"});
+    updates.clear();
+
+    // an amendment down keeps its sequence number, one to the same quantity
+    // changes nothing, any other is a delete and an add
+    engine.OnMessage(ConstructReplaceOrder("3", "L3USD", 6, 1101));
+    engine.OnMessage(ConstructReplaceOrder("3", "L3USD", 6, 1101));
+    engine.OnMessage(ConstructReplaceOrder("5", "L3USD", 2, 1099));
+    engine.OnMessage(ConstructCancelOrder("3", "L3USD"));
+    REQUIRE(updates == std::vector<std::string>{"REDUCE 3 3 SELL 1 1101", "DELETE 5 5 BUY 2 1100", "ADD 8 5 BUY 2 1099",
+                                                "DELETE 3 3 SELL 6 1101"});
+    updates.clear();
+
+    // orders that never rest only show up in what they fill
+    auto ioc = ConstructNewOrder("6", "L3USD", SideEnum::Sell, 5, 1099);
+    ioc.timeInForce = TimeInForceEnum::ImmediateOrCancel;
+    engine.OnMessage(ioc);
+    auto fok = ConstructNewOrder("7", "L3USD", SideEnum::Sell, 5, 1099);
+    fok.timeInForce = TimeInForceEnum::FillOrKill;
+    engine.OnMessage(fok);
+    REQUIRE(updates == std::vector<std::string>{"FILL 8 5 BUY 2 1099"});
+    updates.clear();
+
+    // rejects change nothing
+    engine.OnMessage(ConstructReplaceOrder("3", "L3USD", 1, 1100));
+    engine.OnMessage(ConstructCancelOrder("3", "L3USD"));
+    REQUIRE(updates.empty());
+}
+
+TEST_CASE("Test book builder refuses updates that do not follow from its books", "[bookbuilder]") {
+    BookBuilder builder(4);
+
+    REQUIRE(builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Add, 1, "a", SideEnum::Buy, 10, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Add, 1, "b", SideEnum::Buy, 10, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Add, 0, "b", SideEnum::Buy, 10, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Add, 2, "b", SideEnum::Buy, 0, 100)));
+
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 2, "a", SideEnum::Buy, 1, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 1, "x", SideEnum::Buy, 1, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 1, "a", SideEnum::Sell, 1, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 1, "a", SideEnum::Buy, 1, 101)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 1, "a", SideEnum::Buy, 11, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 1, "a", SideEnum::Buy, 0, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Reduce, 1, "a", SideEnum::Buy, 10, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Reduce, 1, "a", SideEnum::Buy, 0, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Delete, 1, "a", SideEnum::Buy, 9, 100)));
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Unknown, 1, "a", SideEnum::Buy, 1, 100)));
+    REQUIRE(builder.FindOrder(1)->Quantity() == 10);
+
+    REQUIRE(builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 1, "a", SideEnum::Buy, 4, 100)));
+    REQUIRE(builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Reduce, 1, "a", SideEnum::Buy, 5, 100)));
+    REQUIRE(builder.FindOrder(1)->Quantity() == 1);
+    REQUIRE(builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Delete, 1, "a", SideEnum::Buy, 1, 100)));
+    REQUIRE(builder.FindOrder(1) == nullptr);
+    REQUIRE(builder.NumOrders() == 0);
+
+    // gone once deleted
+    REQUIRE(!builder.Apply(ConstructOrderUpdate(OrderUpdateTypeEnum::Delete, 1, "a", SideEnum::Buy, 1, 100)));
+}
+
+TEST_CASE("Test book builder grows and dumps as the engine does", "[bookbuilder]") {
+    BookBuilder builder(4);
+
+    SymbolRegistry symbols;
+    auto second = symbols.Intern("ZZZUSD");
+    auto first = symbols.Intern("AAAUSD");
+
+    // well past the initial table, added out of order across sides and symbols
+    for (unsigned long i = 1; i <= 200; ++i) {
+        auto side = i % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+        auto update = ConstructOrderUpdate(OrderUpdateTypeEnum::Add, 1000 - i, "", side, i, 100 + i % 7);
+        update.orderId = OrderId(std::to_string(i));
+        update.symbol = i % 3 == 0 ? first : second;
+        REQUIRE(builder.Apply(update));
+    }
+    for (unsigned long i = 1; i <= 200; i += 4) {
+        auto const *order = builder.FindOrder(1000 - i);
+        REQUIRE(order != nullptr);
+
+        auto update = ConstructOrderUpdate(OrderUpdateTypeEnum::Fill, 1000 - i, "", order->Side(),
+                                           order->Quantity(), order->Price());
+        update.orderId = order->OrderId();
+        update.symbol = order->Symbol();
+        REQUIRE(builder.Apply(update));
+    }
+    REQUIRE(builder.NumOrders() == 150);
+
+    auto dump = builder.Dump(symbols);
+    REQUIRE(dump.size() == 150);
+
+    // asks before bids and each side by sequence number, one book after the other
+    std::vector<std::string> expected;
+    for (auto symbol : {first, second}) {
+        for (auto side : {SideEnum::Sell, SideEnum::Buy}) {
+            for (unsigned long i = 200; i >= 1; --i) {
+                auto const *order = builder.FindOrder(1000 - i);
+                if (order != nullptr && order->Symbol() == symbol && order->Side() == side) {
+                    expected.push_back(order->ToString(symbols.Name(symbol)));
+                }
+            }
+        }
+    }
+    REQUIRE(dump == expected);
+
+    auto firstDump = builder.Dump(first, "AAAUSD");
+    auto firstEnd = dump.begin() + static_cast<std::ptrdiff_t>(firstDump.size());
+    REQUIRE(std::vector<std::string>(dump.begin(), firstEnd) == firstDump);
+}
+
+TEST_CASE("Test book builder rebuilds the books from the order updates", "[bookbuilder]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    auto &symbols = TestSymbols();
+    BookBuilder builder;
+    unsigned long refused = 0;
+    BasicMatchingEngine<std::function<void(const MessageHeader &)>, BuilderFeed> engine(
+        symbols, [](const MessageHeader &) {}, BuilderFeed{&builder, &refused});
+
+    std::vector<std::string> books{"L3A", "L3B", "L3C"};
+    for (auto const &book : books) {
+        REQUIRE(engine.ConfigureSymbol(symbols.Intern(book), ConstructBookConfig(bookType)));
+    }
+
+    std::mt19937 random(25);
+    for (unsigned long i = 0; i < 30000; ++i) {
+        auto symbol = books[random() % books.size()];
+        auto orderId = std::to_string(random() % (i + 1));
+        auto action = random() % 12;
+
+        if (action == 0) {
+            engine.OnMessage(ConstructCancelOrder(orderId, symbol));
+        } else if (action == 1) {
+            engine.OnMessage(ConstructReplaceOrder(orderId, symbol, random() % 50, 1090 + random() % 20));
+        } else {
+            auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+            auto newOrder =
+                ConstructNewOrder(std::to_string(i), symbol, side, 1 + random() % 50, 1090 + random() % 20);
+            if (action == 2) {
+                newOrder.timeInForce = TimeInForceEnum::ImmediateOrCancel;
+            } else if (action == 3) {
+                newOrder.timeInForce = TimeInForceEnum::FillOrKill;
+            } else if (action == 4) {
+                newOrder.orderType = OrderTypeEnum::Market;
+                newOrder.timeInForce = TimeInForceEnum::ImmediateOrCancel;
+            }
+            engine.OnMessage(newOrder);
+        }
+
+        if (i % 5000 == 0) {
+            REQUIRE(builder.Dump(symbols) == engine.Dump());
+        }
+    }
+
+    REQUIRE(refused == 0);
+    REQUIRE(builder.NumOrders() > 100);
+    REQUIRE(builder.Dump(symbols) == engine.Dump());
+
+    std::vector<std::string> bookDump;
+    engine.ForEachOrder(symbols.Intern(books[1]), [&](const std::string &symbolName, const Order &order) {
+        bookDump.push_back(order.ToString(symbolName));
+    });
+    REQUIRE(builder.Dump(symbols.Intern(books[1]), books[1]) == bookDump);
+}
@@ -0,0 +1,66 @@
+#include "test_helpers.h"
+
+using namespace gemini;
+
+SymbolRegistry &TestSymbols() {
+    static SymbolRegistry symbols;
+    return symbols;
+}
+
+NewOrder ConstructNewOrder(std::string orderId, std::string symbol, SideEnum::Type side, unsigned long quantity,
+                           unsigned long price) {
+    NewOrder newOrder;
+
+    newOrder.orderId = OrderId(orderId);
+    newOrder.symbol = TestSymbols().Intern(symbol);
+    newOrder.side = side;
+    newOrder.quantity = quantity;
+    newOrder.price = price;
+
+    return newOrder;
+}
+
+Trade ConstructTrade(std::string symbol, std::string orderId, std::string contraOrderId, unsigned long quantity,
+                     unsigned long price) {
+    Trade trade;
+
+    trade.symbol = TestSymbols().Intern(symbol);
+    trade.orderId = OrderId(orderId);
+    trade.contraOrderId = OrderId(contraOrderId);
+    trade.quantity = quantity;
+    trade.price = price;
+
+    return trade;
+}
+
+OrderBookConfig ConstructBookConfig(BookTypeEnum::Type bookType) {
+    OrderBookConfig config;
+
+    config.bookType = bookType;
+    config.basePrice = 1000;
+    config.tickSize = 1;
+    config.numLevels = 1000;
+
+    return config;
+}
+
+CancelOrder ConstructCancelOrder(std::string orderId, std::string symbol) {
+    CancelOrder cancelOrder;
+
+    cancelOrder.orderId = OrderId(orderId);
+    cancelOrder.symbol = TestSymbols().Intern(symbol);
+
+    return cancelOrder;
+}
+
+ReplaceOrder ConstructReplaceOrder(std::string orderId, std::string symbol, unsigned long quantity,
+                                   unsigned long price) {
+    ReplaceOrder replaceOrder;
+
+    replaceOrder.orderId = OrderId(orderId);
+    replaceOrder.symbol = TestSymbols().Intern(symbol);
+    replaceOrder.quantity = quantity;
+    replaceOrder.price = price;
+
+    return replaceOrder;
+}
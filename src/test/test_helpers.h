@@ -0,0 +1,25 @@
+#ifndef MATCHING_ENGINE__TEST_HELPERS_H
+#define MATCHING_ENGINE__TEST_HELPERS_H
+
+#include <string>
+
+#include "messages.h"
+#include "order_book.h"
+#include "symbol_registry.h"
+
+// tests share one registry so symbols can be named inline
+gemini::SymbolRegistry &TestSymbols();
+
+// messages on symbols named in TestSymbols()
+gemini::NewOrder ConstructNewOrder(std::string orderId, std::string symbol, gemini::SideEnum::Type side,
+                                   unsigned long quantity, unsigned long price);
+gemini::CancelOrder ConstructCancelOrder(std::string orderId, std::string symbol);
+gemini::ReplaceOrder ConstructReplaceOrder(std::string orderId, std::string symbol, unsigned long quantity,
+                                           unsigned long price);
+gemini::Trade ConstructTrade(std::string symbol, std::string orderId, std::string contraOrderId,
+                             unsigned long quantity, unsigned long price);
+
+// a config covering the prices used by the tests
+gemini::OrderBookConfig ConstructBookConfig(gemini::BookTypeEnum::Type bookType);
+
+#endif  // MATCHING_ENGINE__TEST_HELPERS_H
@@ -0,0 +1,325 @@
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "binary_parser.h"
+#include "catch.hpp"
+#include "frame_reader.h"
+#include "line_reader.h"
+#include "text_parser.h"
+
+using namespace gemini;
+
+namespace {
+
+// calls fn(int fd) with a descriptor reading the bytes from a pipe or a temporary file
+template <typename Fn>
+void WithInput(const std::string &bytes, bool fromFile, Fn &&fn) {
+    if (fromFile) {
+        auto *file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        REQUIRE(std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+        std::fflush(file);
+
+        fn(fileno(file));
+        std::fclose(file);
+    } else {
+        // small enough to fit in the pipe buffer without a writer thread
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        REQUIRE(write(fds[1], bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()));
+        close(fds[1]);
+
+        fn(fds[0]);
+        close(fds[0]);
+    }
+}
+
+// reads all lines of the text through a pipe or a temporary file
+std::vector<std::string> ReadLines(const std::string &text, bool fromFile, std::size_t chunkSize) {
+    std::vector<std::string> result;
+
+    WithInput(text, fromFile, [&](int fd) {
+        LineReader reader(fd, chunkSize);
+        REQUIRE(reader.IsMapped() == (fromFile && !text.empty()));
+
+        reader.ForEachLine([&](std::string_view line) {
+            result.emplace_back(line);
+            return true;
+        });
+
+        REQUIRE(reader.Lines() == result.size());
+        REQUIRE(reader.Bytes() == text.size());
+    });
+
+    return result;
+}
+
+// every field of an inbound message, with its symbol by name
+std::string Describe(const SymbolRegistry &symbols, const MessageHeader &msg) {
+    std::string result = MessageTypeEnum::ToString(msg.messageType);
+
+    switch (msg.messageType) {
+        case MessageTypeEnum::NewOrder: {
+            auto const &newOrder = static_cast<const NewOrder &>(msg);
+            result += ' ' + std::string(newOrder.orderId.View()) + ' ' + SideEnum::ToString(newOrder.side) + ' ' +
+                      symbols.Name(newOrder.symbol) + ' ' + std::to_string(newOrder.quantity) + ' ' +
+                      std::to_string(newOrder.price);
+            break;
+        }
+        case MessageTypeEnum::CancelOrder: {
+            auto const &cancelOrder = static_cast<const CancelOrder &>(msg);
+            result += ' ' + std::string(cancelOrder.orderId.View()) + ' ' + symbols.Name(cancelOrder.symbol);
+            break;
+        }
+        case MessageTypeEnum::ReplaceOrder: {
+            auto const &replaceOrder = static_cast<const ReplaceOrder &>(msg);
+            result += ' ' + std::string(replaceOrder.orderId.View()) + ' ' + symbols.Name(replaceOrder.symbol) + ' ' +
+                      std::to_string(replaceOrder.quantity) + ' ' + std::to_string(replaceOrder.price);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return result;
+}
+
+// reads all messages of the binary input through a pipe or a temporary file
+std::vector<std::string> ReadMessages(const std::string &bytes, bool fromFile, std::size_t chunkSize,
+                                      bool &corrupt) {
+    std::vector<std::string> result;
+
+    WithInput(bytes, fromFile, [&](int fd) {
+        SymbolRegistry symbols;
+        FrameReader reader(fd, chunkSize);
+        BinaryParser parser(symbols);
+        REQUIRE(reader.IsMapped() == (fromFile && !bytes.empty()));
+
+        reader.ForEachFrame([&](const wire::Header &frame) {
+            // messages are handed out aligned, wherever they are in the input
+            REQUIRE(reinterpret_cast<std::uintptr_t>(&frame) % alignof(wire::NewOrder) == 0);
+
+            auto status = parser.Parse(frame);
+            if (status == ParseStatusEnum::Ok) {
+                result.push_back(Describe(symbols, parser.Message()));
+            } else if (status != ParseStatusEnum::Definition) {
+                result.push_back(ParseStatusEnum::ToString(status));
+            }
+            return true;
+        });
+
+        corrupt = reader.Corrupt();
+    });
+
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Test line reader splits mapped and streamed input the same way", "[input]") {
+    auto fromFile = GENERATE(false, true);
+
+    // a chunk smaller than most lines exercises lines straddling reads and the buffer growing
+    auto chunkSize = GENERATE(std::size_t{4}, std::size_t{4096});
+
+    std::vector<std::string> expected{"1 BUY BTCUSD 100 1234", "", "2 CANCEL BTCUSD", "last line without newline"};
+    REQUIRE(expected == ReadLines("1 BUY BTCUSD 100 1234\n\n2 CANCEL BTCUSD\nlast line without newline", fromFile,
+                                  chunkSize));
+
+    REQUIRE(ReadLines("", fromFile, chunkSize).empty());
+}
+
+TEST_CASE("Test line reader stops when asked", "[input]") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+
+    std::string text = "a\nexit\nb\n";
+    REQUIRE(write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+    close(fds[1]);
+
+    std::vector<std::string> lines;
+    LineReader reader(fds[0]);
+    reader.ForEachLine([&](std::string_view line) {
+        lines.emplace_back(line);
+        return line != "exit";
+    });
+    close(fds[0]);
+
+    std::vector<std::string> expected{"a", "exit"};
+    REQUIRE(expected == lines);
+}
+
+TEST_CASE("Test line reader calls its idle handler while waiting for input", "[input]") {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+
+    // the first call times out on an empty pipe, the second supplies the input
+    int calls = 0;
+    LineReader reader(fds[0]);
+    reader.SetIdleHandler([&] {
+        if (++calls == 2) {
+            std::string text = "a\n";
+            REQUIRE(write(fds[1], text.data(), text.size()) == static_cast<ssize_t>(text.size()));
+            close(fds[1]);
+        }
+        return calls == 1 ? 1 : -1;
+    });
+
+    std::vector<std::string> lines;
+    reader.ForEachLine([&](std::string_view line) {
+        lines.emplace_back(line);
+        return true;
+    });
+    close(fds[0]);
+
+    std::vector<std::string> expected{"a"};
+    REQUIRE(expected == lines);
+    REQUIRE(calls >= 2);
+}
+
+TEST_CASE("Test text parser builds messages in place", "[input]") {
+    SymbolRegistry symbols;
+    TextParser parser(symbols);
+
+    REQUIRE(parser.Parse("1  BUY\tBTCUSD 100 1234\r") == ParseStatusEnum::Ok);
+    REQUIRE(parser.Message().messageType == MessageTypeEnum::NewOrder);
+
+    auto const &newOrder = static_cast<const NewOrder &>(parser.Message());
+    REQUIRE(newOrder.orderId == OrderId("1"));
+    REQUIRE(newOrder.side == SideEnum::Buy);
+    REQUIRE(symbols.Name(newOrder.symbol) == "BTCUSD");
+    REQUIRE(newOrder.quantity == 100);
+    REQUIRE(newOrder.price == 1234);
+    REQUIRE(newOrder.orderType == OrderTypeEnum::Limit);
+    REQUIRE(newOrder.timeInForce == TimeInForceEnum::GoodTillCancel);
+
+    REQUIRE(parser.Parse("2 SELL BTCUSD 10 MARKET IOC") == ParseStatusEnum::Ok);
+    REQUIRE(newOrder.orderType == OrderTypeEnum::Market);
+    REQUIRE(newOrder.timeInForce == TimeInForceEnum::ImmediateOrCancel);
+    REQUIRE(newOrder.price == 0);
+
+    REQUIRE(parser.Parse("3 BUY BTCUSD 10 1234 FOK") == ParseStatusEnum::Ok);
+    REQUIRE(newOrder.orderType == OrderTypeEnum::Limit);
+    REQUIRE(newOrder.timeInForce == TimeInForceEnum::FillOrKill);
+    REQUIRE(newOrder.price == 1234);
+
+    // a plain order after them is back to the defaults
+    REQUIRE(parser.Parse("4 BUY BTCUSD 10 1234") == ParseStatusEnum::Ok);
+    REQUIRE(newOrder.timeInForce == TimeInForceEnum::GoodTillCancel);
+
+    REQUIRE(parser.Parse("1 CANCEL BTCUSD") == ParseStatusEnum::Ok);
+    REQUIRE(parser.Message().messageType == MessageTypeEnum::CancelOrder);
+
+    REQUIRE(parser.Parse("1 REPLACE BTCUSD 50 1235") == ParseStatusEnum::Ok);
+    auto const &replaceOrder = static_cast<const ReplaceOrder &>(parser.Message());
+    REQUIRE(replaceOrder.messageType == MessageTypeEnum::ReplaceOrder);
+    REQUIRE(replaceOrder.quantity == 50);
+    REQUIRE(replaceOrder.price == 1235);
+
+    REQUIRE(parser.Parse("") == ParseStatusEnum::Blank);
+    REQUIRE(parser.Parse("   ") == ParseStatusEnum::Blank);
+    REQUIRE(parser.Parse("1 BUY BTCUSD") == ParseStatusEnum::Malformed);
+    REQUIRE(parser.Parse("1 BUY BTCUSD 100 1234 extra") == ParseStatusEnum::Malformed);
+    REQUIRE(parser.Parse("1 BUY BTCUSD 100 1234 IOC extra") == ParseStatusEnum::Malformed);
+    REQUIRE(parser.Parse("1 REPLACE BTCUSD 100 1234 IOC") == ParseStatusEnum::Malformed);
+    REQUIRE(parser.Parse("1 BUY BTCUSD 1x0 1234") == ParseStatusEnum::Malformed);
+    REQUIRE(parser.Parse("1 BUY BTCUSD -100 1234") == ParseStatusEnum::Malformed);
+    REQUIRE(parser.Parse("1 FOO BTCUSD 100 1234") == ParseStatusEnum::Malformed);
+    REQUIRE(parser.Parse("1234567890123456 BUY BTCUSD 100 1234") == ParseStatusEnum::OrderIdTooLong);
+
+    // only the symbols of accepted lines are interned
+    REQUIRE(symbols.Size() == 1);
+}
+
+TEST_CASE("Test binary input replays text input", "[input]") {
+    auto fromFile = GENERATE(false, true);
+
+    // smaller than a message, and one that does not divide the message sizes
+    auto chunkSize = GENERATE(std::size_t{4}, std::size_t{100}, std::size_t{4096});
+
+    // long enough names that their definitions straddle the smaller chunks
+    std::vector<std::string> lines{"1 BUY BTCUSD 100 1234",
+                                   "2 SELL A_RATHER_LONG_SYMBOL_NAME_THAT_TAKES_SEVERAL_WORDS 18446744073709551615 0",
+                                   "1 REPLACE BTCUSD 50 1235",
+                                   "123456789012345 CANCEL ETHUSD",
+                                   "4 FOO BTCUSD 5 1234",
+                                   "3 BUY BTCUSD 1 1"};
+
+    SymbolRegistry textSymbols;
+    TextParser textParser(textSymbols);
+    BinaryEncoder encoder(textSymbols);
+
+    std::vector<std::string> expected;
+    std::string bytes;
+    for (auto const &line : lines) {
+        // skipped lines are left out, as text_to_binary leaves them out
+        if (textParser.Parse(line) != ParseStatusEnum::Ok) {
+            continue;
+        }
+        expected.push_back(Describe(textSymbols, textParser.Message()));
+
+        auto encoded = encoder.Encode(textParser.Message());
+        REQUIRE(encoded.size() % wire::FrameAlignment == 0);
+        bytes.append(encoded);
+    }
+
+    REQUIRE(expected.size() == lines.size() - 1);
+
+    bool corrupt = true;
+    REQUIRE(expected == ReadMessages(bytes, fromFile, chunkSize, corrupt));
+    REQUIRE(!corrupt);
+
+    // a message cut short by the end of the input
+    auto truncated = ReadMessages(bytes.substr(0, bytes.size() - 8), fromFile, chunkSize, corrupt);
+    REQUIRE(truncated.size() == expected.size() - 1);
+    REQUIRE(corrupt);
+
+    REQUIRE(ReadMessages("", fromFile, chunkSize, corrupt).empty());
+    REQUIRE(!corrupt);
+}
+
+TEST_CASE("Test binary parser skips malformed messages", "[input]") {
+    SymbolRegistry symbols;
+    BinaryParser parser(symbols);
+
+    NewOrder newOrder;
+    newOrder.orderId = OrderId("1");
+    newOrder.symbol = 0;
+    newOrder.side = SideEnum::Buy;
+    newOrder.quantity = 100;
+    newOrder.price = 1234;
+
+    // no symbol has been defined yet
+    auto encoded = ToWire(newOrder);
+    REQUIRE(parser.Parse(encoded.header) == ParseStatusEnum::Malformed);
+
+    // the stream's ids start at 0, so this one skips ahead
+    struct {
+        wire::SymbolDefinition definition;
+        char name[8];
+    } define{};
+    define.definition.header.messageType = MessageTypeEnum::SymbolDefinition;
+    define.definition.header.length = static_cast<std::uint16_t>(wire::SymbolDefinitionSize(6));
+    define.definition.symbol = 1;
+    define.definition.nameLength = 6;
+    std::memcpy(define.name, "BTCUSD", 6);
+    REQUIRE(parser.Parse(define.definition.header) == ParseStatusEnum::Malformed);
+
+    define.definition.symbol = 0;
+    REQUIRE(parser.Parse(define.definition.header) == ParseStatusEnum::Definition);
+    REQUIRE(parser.Parse(encoded.header) == ParseStatusEnum::Ok);
+    REQUIRE(symbols.Name(static_cast<const NewOrder &>(parser.Message()).symbol) == "BTCUSD");
+
+    // a name longer than the message holds
+    define.definition.nameLength = 9;
+    REQUIRE(parser.Parse(define.definition.header) == ParseStatusEnum::Malformed);
+
+    // outbound messages are not input
+    Trade trade;
+    REQUIRE(parser.Parse(ToWire(trade).header) == ParseStatusEnum::Malformed);
+}
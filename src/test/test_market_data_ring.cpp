@@ -0,0 +1,322 @@
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "catch.hpp"
+#include "market_data_ring.h"
+#include "matching_engine.h"
+
+using namespace gemini;
+
+namespace {
+
+Trade MakeTrade(SymbolId symbol, unsigned long quantity, unsigned long price) {
+    Trade trade;
+    trade.symbol = symbol;
+    trade.orderId = OrderId("aggressor");
+    trade.contraOrderId = OrderId("resting");
+    trade.quantity = quantity;
+    trade.price = price;
+    return trade;
+}
+
+void PublishTrade(MarketDataWriter &writer, unsigned long price) {
+    auto msg = ToWire(MakeTrade(1, 1, price));
+    writer.Publish(msg.header);
+}
+
+// the price of the trade last read, the tests publish trades numbered by price
+unsigned long ReadPrice(const MarketDataReader &reader) {
+    Trade trade;
+    REQUIRE(FromWire(reinterpret_cast<const wire::Trade &>(reader.Message()), trade));
+    return trade.price;
+}
+
+// passes trades on to the ring and drops everything else
+struct RingSink {
+    MarketDataPublisher publish;
+
+    void operator()(TradeSpan trades) const { publish(trades); }
+    void operator()(const MessageHeader &) const {}
+};
+
+NewOrder MakeNewOrder(const char *orderId, SymbolId symbol, SideEnum::Type side, unsigned long quantity,
+                      unsigned long price) {
+    NewOrder newOrder;
+    newOrder.orderId = OrderId(orderId);
+    newOrder.symbol = symbol;
+    newOrder.side = side;
+    newOrder.quantity = quantity;
+    newOrder.price = price;
+    return newOrder;
+}
+
+}  // namespace
+
+TEST_CASE("Test market data ring reads in order", "[marketdataring]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    MarketDataRingConfig config;
+    config.capacity = 6;
+    config.maxSymbols = 4;
+    MarketDataWriter writer(fileno(file), config);
+    REQUIRE(writer.IsMapped());
+    REQUIRE(writer.Capacity() == 8);
+
+    MarketDataReader reader(fileno(file));
+    REQUIRE(reader.IsMapped());
+    REQUIRE(reader.Read() == RingReadStatusEnum::Empty);
+
+    // several laps of the ring, read as they go
+    for (unsigned long i = 1; i <= 20; ++i) {
+        PublishTrade(writer, i);
+        REQUIRE(writer.SequenceNumber() == i);
+
+        REQUIRE(reader.Read() == RingReadStatusEnum::Ok);
+        REQUIRE(reader.SequenceNumber() == i);
+        REQUIRE(reader.Message().messageType == MessageTypeEnum::Trade);
+        REQUIRE(ReadPrice(reader) == i);
+        REQUIRE(reader.Read() == RingReadStatusEnum::Empty);
+    }
+
+    // and a whole ring's worth at once
+    for (unsigned long i = 21; i <= 28; ++i) {
+        PublishTrade(writer, i);
+    }
+    for (unsigned long i = 21; i <= 28; ++i) {
+        REQUIRE(reader.Read() == RingReadStatusEnum::Ok);
+        REQUIRE(ReadPrice(reader) == i);
+    }
+    REQUIRE(reader.Read() == RingReadStatusEnum::Empty);
+    REQUIRE(reader.Missed() == 0);
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test market data ring names symbols for late readers", "[marketdataring]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    MarketDataRingConfig config;
+    config.capacity = 4;
+    config.maxSymbols = 4;
+    MarketDataWriter writer(fileno(file), config);
+
+    REQUIRE(writer.DefineSymbol(0, "BTCUSD"));
+    REQUIRE(writer.DefineSymbol(3, "ETHUSD"));
+    REQUIRE(!writer.DefineSymbol(4, "LTCUSD"));
+    REQUIRE(!writer.DefineSymbol(1, std::string(ring::MaxSymbolName + 1, 'X')));
+    REQUIRE(writer.IsDefined(3));
+    REQUIRE(!writer.IsDefined(1));
+
+    PublishTrade(writer, 1);
+    PublishTrade(writer, 2);
+
+    // starts after what was already published
+    MarketDataReader reader(fileno(file));
+    REQUIRE(reader.IsMapped());
+    REQUIRE(reader.SymbolName(0) == "BTCUSD");
+    REQUIRE(reader.SymbolName(3) == "ETHUSD");
+    REQUIRE(reader.SymbolName(1).empty());
+    REQUIRE(reader.SymbolName(4).empty());
+    REQUIRE(reader.Read() == RingReadStatusEnum::Empty);
+
+    PublishTrade(writer, 3);
+    REQUIRE(reader.Read() == RingReadStatusEnum::Ok);
+    REQUIRE(reader.SequenceNumber() == 3);
+    REQUIRE(ReadPrice(reader) == 3);
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test market data ring refuses descriptors without a ring", "[marketdataring]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    MarketDataReader empty(fileno(file));
+    REQUIRE(!empty.IsMapped());
+    REQUIRE(empty.Read() == RingReadStatusEnum::Empty);
+
+    std::string junk(4096, 'x');
+    REQUIRE(write(fileno(file), junk.data(), junk.size()) == static_cast<ssize_t>(junk.size()));
+    MarketDataReader garbage(fileno(file));
+    REQUIRE(!garbage.IsMapped());
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test market data ring readers find out they were lapped", "[marketdataring]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    MarketDataRingConfig config;
+    config.capacity = 4;
+    config.maxSymbols = 1;
+    MarketDataWriter writer(fileno(file), config);
+    MarketDataReader reader(fileno(file));
+
+    PublishTrade(writer, 1);
+    REQUIRE(reader.Read() == RingReadStatusEnum::Ok);
+
+    // 2 to 6 are published, 2 is overwritten by 6 before it is read
+    for (unsigned long i = 2; i <= 6; ++i) {
+        PublishTrade(writer, i);
+    }
+    REQUIRE(reader.Read() == RingReadStatusEnum::Lapped);
+    REQUIRE(reader.Missed() == 5);
+    REQUIRE(reader.Read() == RingReadStatusEnum::Empty);
+
+    // caught up again from the next message on
+    PublishTrade(writer, 7);
+    REQUIRE(reader.Read() == RingReadStatusEnum::Ok);
+    REQUIRE(reader.SequenceNumber() == 7);
+    REQUIRE(ReadPrice(reader) == 7);
+    REQUIRE(reader.Missed() == 5);
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test market data ring carries an engine's trades, level and order updates", "[marketdataring]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    MarketDataWriter writer(fileno(file));
+    MarketDataReader reader(fileno(file));
+
+    SymbolRegistry symbols;
+    auto symbol = symbols.Intern("RINGUSD");
+    MarketDataPublisher publisher(writer, symbols);
+    BasicMatchingEngine<RingSink, MarketDataPublisher> engine(symbols, RingSink{publisher}, publisher);
+
+    engine.OnMessage(MakeNewOrder("1", symbol, SideEnum::Sell, 10, 1100));
+    engine.OnMessage(MakeNewOrder("2", symbol, SideEnum::Buy, 4, 1100));
+
+    std::vector<std::string> messages;
+    while (reader.Read() == RingReadStatusEnum::Ok) {
+        auto const &msg = reader.Message();
+        if (msg.messageType == MessageTypeEnum::Trade) {
+            Trade trade;
+            REQUIRE(FromWire(reinterpret_cast<const wire::Trade &>(msg), trade));
+            messages.push_back("TRADE " + std::string(reader.SymbolName(trade.symbol)) + ' ' +
+                               std::string(trade.orderId.View()) + ' ' + std::string(trade.contraOrderId.View()) +
+                               ' ' + std::to_string(trade.quantity) + ' ' + std::to_string(trade.price));
+        } else if (msg.messageType == MessageTypeEnum::OrderUpdate) {
+            OrderUpdate update;
+            REQUIRE(FromWire(reinterpret_cast<const wire::OrderUpdate &>(msg), update));
+            messages.push_back("ORDER " + std::string(reader.SymbolName(update.symbol)) + ' ' +
+                               OrderUpdateTypeEnum::ToString(update.updateType) + ' ' +
+                               std::to_string(update.sequenceNumber) + ' ' + std::string(update.orderId.View()) +
+                               ' ' + std::to_string(update.quantity));
+        } else {
+            REQUIRE(msg.messageType == MessageTypeEnum::LevelUpdate);
+            LevelUpdate update;
+            REQUIRE(FromWire(reinterpret_cast<const wire::LevelUpdate &>(msg), update));
+            messages.push_back("LEVEL " + std::string(reader.SymbolName(update.symbol)) + ' ' +
+                               SideEnum::ToString(update.side) + ' ' + std::to_string(update.price) + ' ' +
+                               std::to_string(update.quantity) + ' ' + std::to_string(update.numOrders));
+        }
+    }
+
+    // each order update comes just before the level update it causes, and the trades after both
+    REQUIRE(messages == std::vector<std::string>{"ORDER RINGUSD ADD 1 1 10", "LEVEL RINGUSD SELL 1100 10 1",
+                                                 "ORDER RINGUSD FILL 1 1 4", "LEVEL RINGUSD SELL 1100 6 1",
+                                                 "TRADE RINGUSD 2 1 4 1100"});
+    REQUIRE(reader.Missed() == 0);
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test market data ring readers on other threads account for every message", "[marketdataring]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    // small enough that the readers are lapped now and then
+    constexpr unsigned long kMessages = 200000;
+    MarketDataRingConfig config;
+    config.capacity = 64;
+    config.maxSymbols = 1;
+    MarketDataWriter writer(fileno(file), config);
+
+    constexpr unsigned kReaders = 2;
+    std::vector<unsigned long> received(kReaders);
+    std::vector<unsigned long> missed(kReaders);
+    std::vector<int> inOrder(kReaders, 1);
+    std::atomic<unsigned> ready{0};
+
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&, r] {
+            // each reader maps the ring for itself, as another process would
+            MarketDataReader reader(fileno(file));
+            ready.fetch_add(1);
+
+            // every sequence number is either read or counted as missed
+            unsigned long last = 0;
+            while (received[r] + reader.Missed() < kMessages) {
+                auto status = reader.Read();
+                if (status == RingReadStatusEnum::Ok) {
+                    // a copy torn by the writer would not carry its own sequence number as its price
+                    Trade trade;
+                    if (!FromWire(reinterpret_cast<const wire::Trade &>(reader.Message()), trade) ||
+                        trade.price != reader.SequenceNumber() || reader.SequenceNumber() <= last) {
+                        inOrder[r] = 0;
+                    }
+                    last = reader.SequenceNumber();
+                    received[r]++;
+                } else if (status == RingReadStatusEnum::Empty) {
+                    std::this_thread::yield();
+                }
+            }
+            missed[r] = reader.Missed();
+        });
+    }
+
+    while (ready.load() < kReaders) {
+        std::this_thread::yield();
+    }
+    for (unsigned long i = 1; i <= kMessages; ++i) {
+        PublishTrade(writer, i);
+    }
+
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    for (unsigned r = 0; r < kReaders; ++r) {
+        REQUIRE(inOrder[r]);
+        REQUIRE(received[r] + missed[r] == kMessages);
+    }
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test market data ring through posix shared memory", "[marketdataring]") {
+    auto name = "/gemini-test-" + std::to_string(getpid());
+
+    auto writerFd = OpenSharedMemory(name, true);
+    REQUIRE(writerFd >= 0);
+    MarketDataWriter writer(writerFd);
+    close(writerFd);
+    REQUIRE(writer.IsMapped());
+    REQUIRE(writer.DefineSymbol(0, "SHMUSD"));
+
+    auto readerFd = OpenSharedMemory(name, false);
+    REQUIRE(readerFd >= 0);
+    MarketDataReader reader(readerFd);
+    close(readerFd);
+    REQUIRE(reader.IsMapped());
+
+    PublishTrade(writer, 42);
+    REQUIRE(reader.Read() == RingReadStatusEnum::Ok);
+    REQUIRE(ReadPrice(reader) == 42);
+    REQUIRE(reader.SymbolName(0) == "SHMUSD");
+
+    // mappings outlive the name
+    REQUIRE(UnlinkSharedMemory(name));
+    REQUIRE(!UnlinkSharedMemory(name));
+    PublishTrade(writer, 43);
+    REQUIRE(reader.Read() == RingReadStatusEnum::Ok);
+    REQUIRE(ReadPrice(reader) == 43);
+}
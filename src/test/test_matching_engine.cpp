@@ -1,5 +1,26 @@
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <optional>
+#include <random>
+#include <thread>
+#include <tuple>
+
+#include "allocation_counter.h"
+#include "binary_parser.h"
 #include "catch.hpp"
+#include "frame_reader.h"
+#include "journal.h"
 #include "matching_engine.h"
+#include "pipelined_matching_engine.h"
+#include "recovery.h"
+#include "sharded_matching_engine.h"
+#include "snapshot.h"
+#include "test_helpers.h"
+#include "text_parser.h"
 
 using namespace gemini;
 
@@ -9,11 +30,11 @@ struct StringMaker<gemini::Trade> {
     static std::string convert(const gemini::Trade &trade) {
         std::string result;
 
-        result += trade.symbol;
+        result += TestSymbols().Name(trade.symbol);
         result += ' ';
-        result += trade.orderId;
+        result += trade.orderId.View();
         result += ' ';
-        result += trade.contraOrderId;
+        result += trade.contraOrderId.View();
         result += ' ';
         result += std::to_string(trade.quantity);
         result += ' ';
@@ -24,45 +45,25 @@ struct StringMaker<gemini::Trade> {
 };
 }  // namespace Catch
 
-NewOrder ConstructNewOrder(std::string orderId, std::string symbol, SideEnum::Type side, unsigned long quantity,
-                           unsigned long price) {
-    NewOrder newOrder;
-
-    newOrder.orderId = orderId;
-    newOrder.symbol = symbol;
-    newOrder.side = side;
-    newOrder.quantity = quantity;
-    newOrder.price = price;
-
-    return newOrder;
-}
-
-Trade ConstructTrade(std::string symbol, std::string orderId, std::string contraOrderId, unsigned long quantity,
-                     unsigned long price) {
-    Trade trade;
-
-    trade.symbol = symbol;
-    trade.orderId = orderId;
-    trade.contraOrderId = contraOrderId;
-    trade.quantity = quantity;
-    trade.price = price;
-
-    return trade;
+// adds a BTCUSD order straight to a book, bypassing the engine's sequencing
+RejectReasonEnum::Type AddToBook(OrderBook &orderBook, unsigned long sequenceNumber, std::string orderId,
+                                 SideEnum::Type side, unsigned long quantity, unsigned long price) {
+    return orderBook.AddOrder(Order(sequenceNumber, ConstructNewOrder(orderId, "BTCUSD", side, quantity, price)));
 }
 
 TEST_CASE("Test constructor", "[basic]") {
-    MatchingEngine engine([](const MessageHeader &) {});
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
     REQUIRE(engine.Dump().empty());
 }
 
 TEST_CASE("Test basic add order", "[basic]") {
-    MatchingEngine engine([](const MessageHeader &) {});
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
 
     auto newOrder1 = ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, 100, 1234);
     engine.OnMessage(newOrder1);
 
     std::vector<std::string> expectedOrders;
-    expectedOrders.push_back(Order(1, newOrder1).ToString());
+    expectedOrders.push_back(Order(1, newOrder1).ToString("BTCUSD"));
 
     auto actualOrders = engine.Dump();
     REQUIRE(actualOrders.size() == 1);
@@ -72,7 +73,7 @@ TEST_CASE("Test basic add order", "[basic]") {
 TEST_CASE("Test basic order fill", "[basic]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -96,7 +97,7 @@ TEST_CASE("Test basic order fill", "[basic]") {
 TEST_CASE("Test basic partial fill", "[basic]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -118,7 +119,7 @@ TEST_CASE("Test basic partial fill", "[basic]") {
 
     // check order 1 left on book
     std::vector<std::string> expectedOrders;
-    expectedOrders.push_back(Order(1, newOrder1).ToString());
+    expectedOrders.push_back(Order(1, newOrder1).ToString("BTCUSD"));
 
     auto actualOrders = engine.Dump();
     REQUIRE(actualOrders.size() == 1);
@@ -128,7 +129,7 @@ TEST_CASE("Test basic partial fill", "[basic]") {
 TEST_CASE("Test basic non-matching orders", "[basic]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -143,8 +144,8 @@ TEST_CASE("Test basic non-matching orders", "[basic]") {
 
     // check both orders left on book in correct order
     std::vector<std::string> expectedOrders;
-    expectedOrders.push_back(Order(2, newOrder2).ToString());
-    expectedOrders.push_back(Order(1, newOrder1).ToString());
+    expectedOrders.push_back(Order(2, newOrder2).ToString("BTCUSD"));
+    expectedOrders.push_back(Order(1, newOrder1).ToString("BTCUSD"));
 
     auto actualOrders = engine.Dump();
     REQUIRE(actualOrders.size() == 2);
@@ -154,7 +155,7 @@ TEST_CASE("Test basic non-matching orders", "[basic]") {
 TEST_CASE("Test inbound order hits multiple resting", "[fills]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -181,7 +182,7 @@ TEST_CASE("Test inbound order hits multiple resting", "[fills]") {
 TEST_CASE("Test inbound order hits multiple resting before resting", "[fills]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -207,7 +208,7 @@ TEST_CASE("Test inbound order hits multiple resting before resting", "[fills]")
 
     // check order 3 left on book
     std::vector<std::string> expectedOrders;
-    expectedOrders.push_back(Order(3, newOrder3).ToString());
+    expectedOrders.push_back(Order(3, newOrder3).ToString("BTCUSD"));
 
     auto actualOrders = engine.Dump();
     REQUIRE(!actualOrders.empty());
@@ -217,7 +218,7 @@ TEST_CASE("Test inbound order hits multiple resting before resting", "[fills]")
 TEST_CASE("Test inbound order trades at best price", "[fills]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -241,7 +242,7 @@ TEST_CASE("Test inbound order trades at best price", "[fills]") {
 TEST_CASE("Test inbound order trades at multiple price levels", "[fills]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -269,7 +270,7 @@ TEST_CASE("Test inbound order trades at multiple price levels", "[fills]") {
 TEST_CASE("Test inbound order hits multiple orders by time priority", "[fills]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -297,7 +298,7 @@ TEST_CASE("Test inbound order hits multiple orders by time priority", "[fills]")
 TEST_CASE("Test inbound order hits multiple price levels by time priority", "[fills]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -331,7 +332,7 @@ TEST_CASE("Test inbound order hits multiple price levels by time priority", "[fi
 TEST_CASE("Test inbound order hits resting order rests and gets hit later", "[fills]") {
     std::vector<Trade> actualTrades;
 
-    MatchingEngine engine([&](const MessageHeader &msg) {
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
         REQUIRE(msg.messageType == MessageTypeEnum::Trade);
         actualTrades.push_back(static_cast<const Trade &>(msg));
     });
@@ -353,7 +354,7 @@ TEST_CASE("Test inbound order hits resting order rests and gets hit later", "[fi
 
     // check order 2 left on book
     std::vector<std::string> expectedOrders;
-    expectedOrders.push_back(Order(2, newOrder2).ToString());
+    expectedOrders.push_back(Order(2, newOrder2).ToString("BTCUSD"));
 
     auto actualOrders = engine.Dump();
     REQUIRE(!actualOrders.empty());
@@ -376,3 +377,1597 @@ TEST_CASE("Test inbound order hits resting order rests and gets hit later", "[fi
     // order book should now be empty
     REQUIRE(engine.Dump().empty());
 }
+
+TEST_CASE("Test ladder book rejects unheld prices", "[ladder]") {
+    std::vector<Trade> actualTrades;
+    std::vector<Reject> actualRejects;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        if (msg.messageType == MessageTypeEnum::Reject) {
+            actualRejects.push_back(static_cast<const Reject &>(msg));
+            return;
+        }
+        REQUIRE(msg.messageType == MessageTypeEnum::Trade);
+        actualTrades.push_back(static_cast<const Trade &>(msg));
+    });
+
+    OrderBookConfig config;
+    config.bookType = BookTypeEnum::Ladder;
+    config.basePrice = 1000;
+    config.tickSize = 5;
+    config.numLevels = 100;
+
+    REQUIRE(engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), config));
+    REQUIRE(!engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), config));
+
+    // below the base, off tick and past the last level
+    engine.OnMessage(ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, 100, 995));
+    engine.OnMessage(ConstructNewOrder("2", "BTCUSD", SideEnum::Buy, 100, 1234));
+    engine.OnMessage(ConstructNewOrder("3", "BTCUSD", SideEnum::Buy, 100, 1500));
+    REQUIRE(engine.Dump().empty());
+
+    REQUIRE(actualRejects.size() == 3);
+    for (auto const &reject : actualRejects) {
+        REQUIRE(reject.rejectedMessageType == MessageTypeEnum::NewOrder);
+        REQUIRE(reject.reason == RejectReasonEnum::PriceNotHeld);
+    }
+    REQUIRE(actualRejects[1].orderId == OrderId("2"));
+
+    auto newOrder4 = ConstructNewOrder("4", "BTCUSD", SideEnum::Buy, 100, 1495);
+    auto newOrder5 = ConstructNewOrder("5", "BTCUSD", SideEnum::Sell, 100, 1000);
+    engine.OnMessage(newOrder4);
+    engine.OnMessage(newOrder5);
+
+    std::vector<Trade> expectedTrades;
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "5", "4", 100, 1495));
+
+    REQUIRE(expectedTrades == actualTrades);
+    REQUIRE(engine.Dump().empty());
+}
+
+TEST_CASE("Test ladder book trades identically to map book", "[ladder]") {
+    std::vector<Trade> mapTrades;
+    std::vector<Trade> ladderTrades;
+
+    MatchingEngine mapEngine(TestSymbols(),
+                             [&](const MessageHeader &msg) { mapTrades.push_back(static_cast<const Trade &>(msg)); });
+    MatchingEngine ladderEngine(TestSymbols(), [&](const MessageHeader &msg) {
+        ladderTrades.push_back(static_cast<const Trade &>(msg));
+    });
+
+    OrderBookConfig config;
+    config.bookType = BookTypeEnum::Ladder;
+    config.basePrice = 900;
+    config.tickSize = 1;
+    config.numLevels = 200;
+    ladderEngine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), config);
+
+    // prices random walk around the touch so that orders both rest and sweep
+    std::mt19937 random(42);
+    for (unsigned long i = 0; i < 5000; ++i) {
+        auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+        auto quantity = 1 + random() % 50;
+        auto price = side == SideEnum::Buy ? 990 + random() % 15 : 996 + random() % 15;
+
+        auto newOrder = ConstructNewOrder(std::to_string(i), "BTCUSD", side, quantity, price);
+        mapEngine.OnMessage(newOrder);
+        ladderEngine.OnMessage(newOrder);
+    }
+
+    REQUIRE(!mapTrades.empty());
+    REQUIRE(mapTrades == ladderTrades);
+    REQUIRE(mapEngine.Dump() == ladderEngine.Dump());
+}
+
+TEST_CASE("Test order pool reuses nodes and tracks high water mark", "[pool]") {
+    std::vector<Trade> actualTrades;
+
+    OrderBookConfig config;
+    config.pool.initialCapacity = 2;
+    config.pool.growBy = 0;
+
+    auto onTrade = [&](TradeSpan trades) { actualTrades.insert(actualTrades.end(), trades.begin(), trades.end()); };
+
+    OrderBook orderBook(TestSymbols().Intern("BTCUSD"), config, onTrade);
+
+    REQUIRE(AddToBook(orderBook, 1, "1", SideEnum::Buy, 100, 1234) == RejectReasonEnum::None);
+    REQUIRE(AddToBook(orderBook, 2, "2", SideEnum::Buy, 100, 1233) == RejectReasonEnum::None);
+    REQUIRE(orderBook.Pool().InUse() == 2);
+
+    // no room to hold the inbound order, even though it would fully trade
+    REQUIRE(RejectReasonEnum::BookFull == AddToBook(orderBook, 3, "3", SideEnum::Sell, 100, 1234));
+    REQUIRE(actualTrades.empty());
+    REQUIRE(orderBook.Dump("BTCUSD").size() == 2);
+
+    // a pool that grows one node at a time
+    OrderBookConfig growConfig;
+    growConfig.pool.initialCapacity = 1;
+    growConfig.pool.growBy = 1;
+
+    OrderBook growBook(TestSymbols().Intern("BTCUSD"), growConfig, onTrade);
+
+    REQUIRE(AddToBook(growBook, 1, "1", SideEnum::Buy, 100, 1234) == RejectReasonEnum::None);
+    REQUIRE(AddToBook(growBook, 2, "2", SideEnum::Buy, 100, 1233) == RejectReasonEnum::None);
+    REQUIRE(growBook.Pool().Capacity() == 2);
+    REQUIRE(growBook.Pool().HighWaterMark() == 2);
+
+    REQUIRE(AddToBook(growBook, 3, "3", SideEnum::Sell, 200, 1233) == RejectReasonEnum::None);
+    REQUIRE(actualTrades.size() == 2);
+    REQUIRE(growBook.Dump("BTCUSD").empty());
+    REQUIRE(growBook.Pool().InUse() == 0);
+
+    // the book grew once to hold the inbound order and never needs to again
+    REQUIRE(growBook.Pool().Capacity() == 3);
+    REQUIRE(growBook.Pool().HighWaterMark() == 3);
+
+    REQUIRE(AddToBook(growBook, 4, "4", SideEnum::Buy, 100, 1234) == RejectReasonEnum::None);
+    REQUIRE(AddToBook(growBook, 5, "5", SideEnum::Buy, 100, 1234) == RejectReasonEnum::None);
+    REQUIRE(growBook.Pool().Capacity() == 3);
+}
+
+TEST_CASE("Test symbol registry interns symbols once", "[symbols]") {
+    SymbolRegistry symbols;
+
+    auto btc = symbols.Intern("BTCUSD");
+    auto eth = symbols.Intern("ETHUSD");
+
+    REQUIRE(btc == 0);
+    REQUIRE(eth == 1);
+    REQUIRE(symbols.Intern(std::string("BTCUSD")) == btc);
+    REQUIRE(symbols.Size() == 2);
+    REQUIRE(symbols.Name(eth) == "ETHUSD");
+    REQUIRE(!symbols.Contains(2));
+}
+
+TEST_CASE("Test dump is in symbol name order", "[symbols]") {
+    SymbolRegistry symbols;
+    MatchingEngine engine(symbols, [](const MessageHeader &) {});
+
+    // intern in reverse name order
+    auto newOrder1 = ConstructNewOrder("1", "ETHUSD", SideEnum::Buy, 100, 175);
+    newOrder1.symbol = symbols.Intern("ETHUSD");
+    auto newOrder2 = ConstructNewOrder("2", "BTCUSD", SideEnum::Buy, 100, 1234);
+    newOrder2.symbol = symbols.Intern("BTCUSD");
+
+    engine.OnMessage(newOrder1);
+    engine.OnMessage(newOrder2);
+
+    std::vector<std::string> expectedOrders;
+    expectedOrders.push_back(Order(2, newOrder2).ToString("BTCUSD"));
+    expectedOrders.push_back(Order(1, newOrder1).ToString("ETHUSD"));
+
+    REQUIRE(expectedOrders == engine.Dump());
+}
+
+TEST_CASE("Test order id is stored inline", "[orderid]") {
+    OrderId empty;
+    OrderId full("0123456789abcde");
+
+    REQUIRE(empty.Empty());
+    REQUIRE(full.Size() == OrderId::Capacity);
+    REQUIRE(full.View() == "0123456789abcde");
+    REQUIRE(!OrderId::Fits("0123456789abcdef"));
+
+    // trailing bytes are zeroed so prefixes compare unequal
+    REQUIRE(OrderId("abc") == OrderId(std::string("abc")));
+    REQUIRE(OrderId("abc") != OrderId("ab"));
+    REQUIRE(OrderId("abc").Hash() == OrderId("abc").Hash());
+}
+
+TEST_CASE("Test order id index insert find and erase", "[orderid]") {
+    OrderIdIndex index(4);
+    std::vector<std::unique_ptr<OrderNode>> nodes;
+
+    // enough entries to force collisions and several rehashes
+    for (unsigned long i = 0; i < 1000; ++i) {
+        auto newOrder = ConstructNewOrder(std::to_string(i), "BTCUSD", SideEnum::Buy, 1, i);
+        nodes.push_back(std::make_unique<OrderNode>(Order(i, newOrder)));
+        REQUIRE(index.Insert(newOrder.orderId, nodes.back().get()));
+    }
+    REQUIRE(index.Size() == 1000);
+    REQUIRE(!index.Insert(OrderId("7"), nodes[7].get()));
+
+    // erase every other entry, the rest must still be reachable past the holes
+    for (unsigned long i = 0; i < 1000; i += 2) {
+        REQUIRE(index.Erase(OrderId(std::to_string(i))));
+    }
+    REQUIRE(!index.Erase(OrderId("0")));
+    REQUIRE(index.Size() == 500);
+
+    for (unsigned long i = 0; i < 1000; ++i) {
+        auto *node = index.Find(OrderId(std::to_string(i)));
+        if (i % 2 == 0) {
+            REQUIRE(node == nullptr);
+        } else {
+            REQUIRE(node == nodes[i].get());
+        }
+    }
+}
+
+TEST_CASE("Test order book finds resting orders by id", "[orderid]") {
+    std::vector<Trade> actualTrades;
+
+    auto onTrade = [&](TradeSpan trades) { actualTrades.insert(actualTrades.end(), trades.begin(), trades.end()); };
+
+    OrderBook orderBook(TestSymbols().Intern("BTCUSD"), onTrade);
+
+    REQUIRE(AddToBook(orderBook, 1, "1", SideEnum::Buy, 100, 1234) == RejectReasonEnum::None);
+    REQUIRE(orderBook.FindOrder(OrderId("1")) != nullptr);
+    REQUIRE(orderBook.FindOrder(OrderId("1"))->Quantity() == 100);
+
+    // an id that is already resting is rejected
+    REQUIRE(RejectReasonEnum::DuplicateOrderId == AddToBook(orderBook, 2, "1", SideEnum::Sell, 100, 1234));
+    REQUIRE(actualTrades.empty());
+
+    // fully filled orders leave the index
+    REQUIRE(AddToBook(orderBook, 3, "3", SideEnum::Sell, 100, 1234) == RejectReasonEnum::None);
+    REQUIRE(actualTrades.size() == 1);
+    REQUIRE(orderBook.FindOrder(OrderId("1")) == nullptr);
+    REQUIRE(orderBook.FindOrder(OrderId("3")) == nullptr);
+}
+
+TEST_CASE("Test cancel resting order", "[cancel]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<CancelAck> actualAcks;
+    std::vector<Trade> actualTrades;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        if (msg.messageType == MessageTypeEnum::CancelAck) {
+            actualAcks.push_back(static_cast<const CancelAck &>(msg));
+            return;
+        }
+        REQUIRE(msg.messageType == MessageTypeEnum::Trade);
+        actualTrades.push_back(static_cast<const Trade &>(msg));
+    });
+    engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), ConstructBookConfig(bookType));
+
+    auto newOrder1 = ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, 100, 1234);
+    auto newOrder2 = ConstructNewOrder("2", "BTCUSD", SideEnum::Buy, 100, 1234);
+    auto newOrder3 = ConstructNewOrder("3", "BTCUSD", SideEnum::Buy, 100, 1234);
+
+    engine.OnMessage(newOrder1);
+    engine.OnMessage(newOrder2);
+    engine.OnMessage(newOrder3);
+
+    // cancel from the middle of the level
+    engine.OnMessage(ConstructCancelOrder("2", "BTCUSD"));
+
+    REQUIRE(actualAcks.size() == 1);
+    REQUIRE(actualAcks[0].orderId == OrderId("2"));
+    REQUIRE(actualAcks[0].side == SideEnum::Buy);
+    REQUIRE(actualAcks[0].quantity == 100);
+    REQUIRE(actualAcks[0].price == 1234);
+
+    std::vector<std::string> expectedOrders;
+    expectedOrders.push_back(Order(1, newOrder1).ToString("BTCUSD"));
+    expectedOrders.push_back(Order(3, newOrder3).ToString("BTCUSD"));
+    REQUIRE(expectedOrders == engine.Dump());
+
+    // the remaining orders keep their time priority
+    engine.OnMessage(ConstructNewOrder("5", "BTCUSD", SideEnum::Sell, 200, 1234));
+
+    std::vector<Trade> expectedTrades;
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "5", "1", 100, 1234));
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "5", "3", 100, 1234));
+
+    REQUIRE(expectedTrades == actualTrades);
+    REQUIRE(engine.Dump().empty());
+}
+
+TEST_CASE("Test cancel best level moves to next best", "[cancel]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<Trade> actualTrades;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        if (msg.messageType == MessageTypeEnum::Trade) {
+            actualTrades.push_back(static_cast<const Trade &>(msg));
+        }
+    });
+    engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), ConstructBookConfig(bookType));
+
+    engine.OnMessage(ConstructNewOrder("1", "BTCUSD", SideEnum::Sell, 100, 1236));
+    engine.OnMessage(ConstructNewOrder("2", "BTCUSD", SideEnum::Sell, 100, 1234));
+    engine.OnMessage(ConstructNewOrder("3", "BTCUSD", SideEnum::Sell, 100, 1235));
+
+    // take out the best ask, then cancel the next best out from under it
+    engine.OnMessage(ConstructCancelOrder("2", "BTCUSD"));
+    engine.OnMessage(ConstructCancelOrder("3", "BTCUSD"));
+    engine.OnMessage(ConstructNewOrder("4", "BTCUSD", SideEnum::Buy, 100, 1240));
+
+    std::vector<Trade> expectedTrades;
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "4", "1", 100, 1236));
+
+    REQUIRE(expectedTrades == actualTrades);
+    REQUIRE(engine.Dump().empty());
+}
+
+TEST_CASE("Test cancel unknown order is rejected", "[cancel]") {
+    std::vector<Reject> actualRejects;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        if (msg.messageType == MessageTypeEnum::Reject) {
+            actualRejects.push_back(static_cast<const Reject &>(msg));
+        }
+    });
+
+    // no book for the symbol yet
+    engine.OnMessage(ConstructCancelOrder("1", "BTCUSD"));
+
+    // the book exists but the order has already gone
+    engine.OnMessage(ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, 100, 1234));
+    engine.OnMessage(ConstructNewOrder("2", "BTCUSD", SideEnum::Sell, 100, 1234));
+    engine.OnMessage(ConstructCancelOrder("1", "BTCUSD"));
+
+    REQUIRE(actualRejects.size() == 2);
+    for (auto const &reject : actualRejects) {
+        REQUIRE(reject.rejectedMessageType == MessageTypeEnum::CancelOrder);
+        REQUIRE(reject.reason == RejectReasonEnum::UnknownOrder);
+        REQUIRE(reject.orderId == OrderId("1"));
+    }
+}
+
+TEST_CASE("Test replace quantity down keeps priority", "[replace]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<ReplaceAck> actualAcks;
+    std::vector<Trade> actualTrades;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        if (msg.messageType == MessageTypeEnum::ReplaceAck) {
+            actualAcks.push_back(static_cast<const ReplaceAck &>(msg));
+            return;
+        }
+        REQUIRE(msg.messageType == MessageTypeEnum::Trade);
+        actualTrades.push_back(static_cast<const Trade &>(msg));
+    });
+    engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), ConstructBookConfig(bookType));
+
+    auto newOrder1 = ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, 100, 1234);
+    auto newOrder2 = ConstructNewOrder("2", "BTCUSD", SideEnum::Buy, 100, 1234);
+
+    engine.OnMessage(newOrder1);
+    engine.OnMessage(newOrder2);
+    engine.OnMessage(ConstructReplaceOrder("1", "BTCUSD", 40, 1234));
+
+    REQUIRE(actualAcks.size() == 1);
+    REQUIRE(actualAcks[0].orderId == OrderId("1"));
+    REQUIRE(actualAcks[0].quantity == 40);
+    REQUIRE(actualAcks[0].price == 1234);
+
+    // order 1 keeps its sequence number and place in the dump
+    newOrder1.quantity = 40;
+
+    std::vector<std::string> expectedOrders;
+    expectedOrders.push_back(Order(1, newOrder1).ToString("BTCUSD"));
+    expectedOrders.push_back(Order(2, newOrder2).ToString("BTCUSD"));
+    REQUIRE(expectedOrders == engine.Dump());
+
+    // and is still first in the queue
+    engine.OnMessage(ConstructNewOrder("3", "BTCUSD", SideEnum::Sell, 50, 1234));
+
+    std::vector<Trade> expectedTrades;
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "3", "1", 40, 1234));
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "3", "2", 10, 1234));
+
+    REQUIRE(expectedTrades == actualTrades);
+}
+
+TEST_CASE("Test replace quantity up or price change loses priority", "[replace]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+    auto quantity = GENERATE(100ul, 150ul);
+
+    std::vector<Trade> actualTrades;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        if (msg.messageType == MessageTypeEnum::Trade) {
+            actualTrades.push_back(static_cast<const Trade &>(msg));
+        }
+    });
+    engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), ConstructBookConfig(bookType));
+
+    auto newOrder2 = ConstructNewOrder("2", "BTCUSD", SideEnum::Buy, 100, 1234);
+
+    engine.OnMessage(ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, 100, 1233));
+    engine.OnMessage(newOrder2);
+
+    // raising the quantity, or the price moving to an occupied level, puts order 1 behind order 2
+    engine.OnMessage(ConstructReplaceOrder("1", "BTCUSD", quantity, quantity == 100 ? 1234 : 1233));
+    if (quantity != 100) {
+        engine.OnMessage(ConstructReplaceOrder("1", "BTCUSD", quantity, 1234));
+    }
+
+    // order 1 now carries the sequence number of the last replace
+    auto expectedSequenceNumber = quantity == 100 ? 3ul : 4ul;
+    auto newOrder1 = ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, quantity, 1234);
+
+    std::vector<std::string> expectedOrders;
+    expectedOrders.push_back(Order(2, newOrder2).ToString("BTCUSD"));
+    expectedOrders.push_back(Order(expectedSequenceNumber, newOrder1).ToString("BTCUSD"));
+    REQUIRE(expectedOrders == engine.Dump());
+
+    engine.OnMessage(ConstructNewOrder("3", "BTCUSD", SideEnum::Sell, 150, 1234));
+
+    std::vector<Trade> expectedTrades;
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "3", "2", 100, 1234));
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "3", "1", 50, 1234));
+
+    REQUIRE(expectedTrades == actualTrades);
+}
+
+TEST_CASE("Test replace to crossing price acks then trades", "[replace]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<MessageTypeEnum::Type> actualMessageTypes;
+    std::vector<Trade> actualTrades;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        actualMessageTypes.push_back(msg.messageType);
+        if (msg.messageType == MessageTypeEnum::Trade) {
+            actualTrades.push_back(static_cast<const Trade &>(msg));
+        }
+    });
+    engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), ConstructBookConfig(bookType));
+
+    engine.OnMessage(ConstructNewOrder("1", "BTCUSD", SideEnum::Sell, 100, 1240));
+    engine.OnMessage(ConstructNewOrder("2", "BTCUSD", SideEnum::Buy, 150, 1234));
+    engine.OnMessage(ConstructReplaceOrder("2", "BTCUSD", 150, 1240));
+
+    std::vector<MessageTypeEnum::Type> expectedMessageTypes{MessageTypeEnum::ReplaceAck, MessageTypeEnum::Trade};
+    REQUIRE(expectedMessageTypes == actualMessageTypes);
+
+    std::vector<Trade> expectedTrades;
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "2", "1", 100, 1240));
+    REQUIRE(expectedTrades == actualTrades);
+
+    // the remainder rests at the new price
+    std::vector<std::string> expectedOrders;
+    expectedOrders.push_back(Order(3, ConstructNewOrder("2", "BTCUSD", SideEnum::Buy, 50, 1240)).ToString("BTCUSD"));
+    REQUIRE(expectedOrders == engine.Dump());
+}
+
+TEST_CASE("Test rejected replace leaves order untouched", "[replace]") {
+    std::vector<Reject> actualRejects;
+
+    MatchingEngine engine(TestSymbols(), [&](const MessageHeader &msg) {
+        REQUIRE(msg.messageType == MessageTypeEnum::Reject);
+        actualRejects.push_back(static_cast<const Reject &>(msg));
+    });
+    engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), ConstructBookConfig(BookTypeEnum::Ladder));
+
+    auto newOrder1 = ConstructNewOrder("1", "BTCUSD", SideEnum::Buy, 100, 1234);
+    engine.OnMessage(newOrder1);
+
+    engine.OnMessage(ConstructReplaceOrder("2", "BTCUSD", 100, 1234));
+    engine.OnMessage(ConstructReplaceOrder("1", "BTCUSD", 0, 1234));
+    engine.OnMessage(ConstructReplaceOrder("1", "BTCUSD", 100, 5000));
+
+    REQUIRE(actualRejects.size() == 3);
+    REQUIRE(actualRejects[0].reason == RejectReasonEnum::UnknownOrder);
+    REQUIRE(actualRejects[1].reason == RejectReasonEnum::InvalidQuantity);
+    REQUIRE(actualRejects[2].reason == RejectReasonEnum::PriceNotHeld);
+    for (auto const &reject : actualRejects) {
+        REQUIRE(reject.rejectedMessageType == MessageTypeEnum::ReplaceOrder);
+    }
+
+    std::vector<std::string> expectedOrders;
+    expectedOrders.push_back(Order(1, newOrder1).ToString("BTCUSD"));
+    REQUIRE(expectedOrders == engine.Dump());
+}
+
+// receives each outbound message by its concrete type, no type erasure
+struct RecordingSink {
+    std::vector<Trade> *trades;
+    std::vector<MessageTypeEnum::Type> *messageTypes;
+
+    void operator()(const Trade &trade) const {
+        messageTypes->push_back(trade.messageType);
+        trades->push_back(trade);
+    }
+    void operator()(const CancelAck &ack) const { messageTypes->push_back(ack.messageType); }
+    void operator()(const ReplaceAck &ack) const { messageTypes->push_back(ack.messageType); }
+    void operator()(const Reject &reject) const { messageTypes->push_back(reject.messageType); }
+};
+
+TEST_CASE("Test static sink sees the same messages as the std::function sink", "[sink]") {
+    std::vector<Trade> actualTrades;
+    std::vector<MessageTypeEnum::Type> actualMessageTypes;
+
+    BasicMatchingEngine<RecordingSink> engine(TestSymbols(), RecordingSink{&actualTrades, &actualMessageTypes});
+
+    engine.OnMessage(ConstructNewOrder("1", "BTCUSD", SideEnum::Sell, 100, 1240));
+    engine.OnMessage(ConstructNewOrder("2", "BTCUSD", SideEnum::Sell, 100, 1250));
+    engine.OnMessage(ConstructNewOrder("3", "BTCUSD", SideEnum::Buy, 150, 1240));
+    engine.OnMessage(ConstructReplaceOrder("2", "BTCUSD", 50, 1250));
+    engine.OnMessage(ConstructCancelOrder("2", "BTCUSD"));
+    engine.OnMessage(ConstructCancelOrder("2", "BTCUSD"));
+
+    std::vector<MessageTypeEnum::Type> expectedMessageTypes{MessageTypeEnum::Trade, MessageTypeEnum::ReplaceAck,
+                                                            MessageTypeEnum::CancelAck, MessageTypeEnum::Reject};
+    REQUIRE(expectedMessageTypes == actualMessageTypes);
+
+    std::vector<Trade> expectedTrades;
+    expectedTrades.push_back(ConstructTrade("BTCUSD", "3", "1", 100, 1240));
+    REQUIRE(expectedTrades == actualTrades);
+
+    std::vector<std::string> expectedOrders;
+    expectedOrders.push_back(Order(3, ConstructNewOrder("3", "BTCUSD", SideEnum::Buy, 50, 1240)).ToString("BTCUSD"));
+    REQUIRE(expectedOrders == engine.Dump());
+}
+
+// counts what it is given without allocating, so only the engine's own
+// allocations are seen
+struct CountingSink {
+    unsigned long *trades;
+    unsigned long *batches;
+    unsigned long *other;
+
+    void operator()(TradeSpan batch) const {
+        *trades += batch.Size();
+        *batches += 1;
+    }
+    void operator()(const CancelAck &) const { *other += 1; }
+    void operator()(const ReplaceAck &) const { *other += 1; }
+    void operator()(const Reject &) const { *other += 1; }
+};
+
+TEST_CASE("Test sweeping the book does not allocate", "[allocations]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    unsigned long trades = 0;
+    unsigned long batches = 0;
+    unsigned long other = 0;
+
+    BasicMatchingEngine<CountingSink> engine(TestSymbols(), CountingSink{&trades, &batches, &other});
+    engine.ConfigureSymbol(TestSymbols().Intern("BTCUSD"), ConstructBookConfig(bookType));
+
+    // 50 resting asks over 10 price levels
+    for (unsigned long i = 0; i < 50; ++i) {
+        engine.OnMessage(ConstructNewOrder(std::to_string(i), "BTCUSD", SideEnum::Sell, 10, 1240 + i % 10));
+    }
+
+    auto sweep = ConstructNewOrder("sweep", "BTCUSD", SideEnum::Buy, 500, 1249);
+
+    // the hook is live
+    auto start = AllocationCount();
+    auto probe = std::make_unique<int>(0);
+    REQUIRE(AllocationCount() == start + 1);
+
+    auto before = AllocationCount();
+    engine.OnMessage(sweep);
+    auto after = AllocationCount();
+
+    REQUIRE(before == after);
+    REQUIRE(trades == 50);
+    REQUIRE(batches == 1);
+    REQUIRE(other == 0);
+    REQUIRE(engine.Dump().empty());
+
+    // the ladder never allocates to rest or cancel an order either
+    if (bookType == BookTypeEnum::Ladder) {
+        auto resting = ConstructNewOrder("rest", "BTCUSD", SideEnum::Buy, 10, 1234);
+        auto cancel = ConstructCancelOrder("rest", "BTCUSD");
+
+        before = AllocationCount();
+        engine.OnMessage(resting);
+        engine.OnMessage(cancel);
+        after = AllocationCount();
+
+        REQUIRE(before == after);
+        REQUIRE(other == 1);
+    }
+}
+
+// writes every outbound message, and where each batch of trades starts, as text
+struct TranscriptSink {
+    std::vector<std::string> *transcript;
+
+    void operator()(TradeSpan trades) const {
+        transcript->push_back("BATCH " + std::to_string(trades.Size()));
+        for (auto const &trade : trades) {
+            transcript->push_back("TRADE " + Catch::StringMaker<Trade>::convert(trade));
+        }
+    }
+    void operator()(const CancelAck &ack) const {
+        transcript->push_back("CANCELED " + std::string(ack.orderId.View()) + ' ' + std::to_string(ack.quantity));
+    }
+    void operator()(const ReplaceAck &ack) const {
+        transcript->push_back("REPLACED " + std::string(ack.orderId.View()) + ' ' + std::to_string(ack.quantity));
+    }
+    void operator()(const Reject &reject) const {
+        transcript->push_back("REJECTED " + std::string(reject.orderId.View()) + ' ' +
+                              RejectReasonEnum::ToString(reject.reason));
+    }
+};
+
+TEST_CASE("Test sharded engine output is identical to a single engine", "[sharded]") {
+    auto numShards = GENERATE(std::size_t{1}, std::size_t{3}, std::size_t{8});
+
+    std::vector<std::string> expected;
+    std::vector<std::string> actual;
+
+    BasicMatchingEngine<TranscriptSink> engine(TestSymbols(), TranscriptSink{&expected});
+    ShardedMatchingEngine<TranscriptSink> sharded(TestSymbols(), numShards, TranscriptSink{&actual});
+
+    // a mix of book types across the shards
+    for (auto name : {"SHARD0", "SHARD2"}) {
+        auto symbol = TestSymbols().Intern(name);
+        REQUIRE(engine.ConfigureSymbol(symbol, ConstructBookConfig(BookTypeEnum::Ladder)));
+        REQUIRE(sharded.ConfigureSymbol(symbol, ConstructBookConfig(BookTypeEnum::Ladder)));
+    }
+
+    std::mt19937 random(7);
+    for (unsigned long i = 0; i < 20000; ++i) {
+        auto symbol = "SHARD" + std::to_string(random() % 10);
+        auto orderId = std::to_string(random() % (i + 1));
+        auto action = random() % 10;
+
+        if (action == 0) {
+            auto cancelOrder = ConstructCancelOrder(orderId, symbol);
+            engine.OnMessage(cancelOrder);
+            sharded.OnMessage(cancelOrder);
+        } else if (action == 1) {
+            auto replaceOrder = ConstructReplaceOrder(orderId, symbol, random() % 50, 1090 + random() % 20);
+            engine.OnMessage(replaceOrder);
+            sharded.OnMessage(replaceOrder);
+        } else {
+            auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+            auto newOrder =
+                ConstructNewOrder(std::to_string(i), symbol, side, 1 + random() % 50, 1090 + random() % 20);
+            engine.OnMessage(newOrder);
+            sharded.OnMessage(newOrder);
+        }
+    }
+
+    sharded.Flush();
+
+    REQUIRE(expected.size() > 20000);
+    REQUIRE(expected == actual);
+    REQUIRE(engine.Dump() == sharded.Dump());
+}
+
+// records each outbound message along with its symbol name, called the way
+// the pipelined engine calls its sink
+struct NamedTranscriptSink {
+    std::vector<std::string> *transcript;
+
+    void operator()(const std::string &symbolName, const Trade &trade) const {
+        transcript->push_back(symbolName + " TRADE " + Catch::StringMaker<Trade>::convert(trade));
+    }
+    void operator()(const std::string &symbolName, const CancelAck &ack) const {
+        transcript->push_back(symbolName + " CANCELED " + std::string(ack.orderId.View()) + ' ' +
+                              std::to_string(ack.quantity));
+    }
+    void operator()(const std::string &symbolName, const ReplaceAck &ack) const {
+        transcript->push_back(symbolName + " REPLACED " + std::string(ack.orderId.View()) + ' ' +
+                              std::to_string(ack.quantity));
+    }
+    void operator()(const std::string &symbolName, const Reject &reject) const {
+        transcript->push_back(symbolName + " REJECTED " + std::string(reject.orderId.View()) + ' ' +
+                              RejectReasonEnum::ToString(reject.reason));
+    }
+};
+
+// the same for BasicMatchingEngine, looking the names up in the registry
+struct RegistryTranscriptSink {
+    NamedTranscriptSink named;
+
+    void operator()(const Trade &trade) const { named(TestSymbols().Name(trade.symbol), trade); }
+    void operator()(const CancelAck &ack) const { named(TestSymbols().Name(ack.symbol), ack); }
+    void operator()(const ReplaceAck &ack) const { named(TestSymbols().Name(ack.symbol), ack); }
+    void operator()(const Reject &reject) const { named(TestSymbols().Name(reject.symbol), reject); }
+};
+
+TEST_CASE("Test pipelined engine output is identical to a single engine", "[pipelined]") {
+    // the smallest queues keep every stage waiting on its neighbours
+    auto queueCapacity = GENERATE(std::size_t{2}, std::size_t{4096});
+
+    std::vector<std::string> expected;
+    std::vector<std::string> actual;
+
+    PipelineConfig config;
+    config.queueCapacity = queueCapacity;
+
+    BasicMatchingEngine<RegistryTranscriptSink> engine(TestSymbols(), RegistryTranscriptSink{{&expected}});
+    PipelinedMatchingEngine<NamedTranscriptSink> pipelined(TestSymbols(), NamedTranscriptSink{&actual}, config);
+
+    auto ladder = TestSymbols().Intern("PIPE0");
+    REQUIRE(engine.ConfigureSymbol(ladder, ConstructBookConfig(BookTypeEnum::Ladder)));
+    REQUIRE(pipelined.ConfigureSymbol(ladder, ConstructBookConfig(BookTypeEnum::Ladder)));
+
+    std::mt19937 random(11);
+    for (unsigned long i = 0; i < 20000; ++i) {
+        auto symbol = "PIPE" + std::to_string(random() % 4);
+        auto orderId = std::to_string(random() % (i + 1));
+        auto action = random() % 10;
+
+        if (action == 0) {
+            auto cancelOrder = ConstructCancelOrder(orderId, symbol);
+            engine.OnMessage(cancelOrder);
+            pipelined.OnMessage(cancelOrder);
+        } else if (action == 1) {
+            auto replaceOrder = ConstructReplaceOrder(orderId, symbol, random() % 50, 1090 + random() % 20);
+            engine.OnMessage(replaceOrder);
+            pipelined.OnMessage(replaceOrder);
+        } else {
+            auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+            auto newOrder =
+                ConstructNewOrder(std::to_string(i), symbol, side, 1 + random() % 50, 1090 + random() % 20);
+            engine.OnMessage(newOrder);
+            pipelined.OnMessage(newOrder);
+        }
+
+        // flushing part way through must not lose or reorder anything
+        if (i == 1000) {
+            pipelined.Flush();
+            REQUIRE(expected == actual);
+        }
+    }
+
+    pipelined.Flush();
+
+    REQUIRE(expected.size() > 10000);
+    REQUIRE(expected == actual);
+    REQUIRE(engine.Dump() == pipelined.Dump());
+
+    auto const &stats = pipelined.Stats();
+    REQUIRE(stats.input.items == 20000);
+    REQUIRE(stats.matching.items == 20000);
+    REQUIRE(stats.output.items == expected.size());
+}
+
+TEST_CASE("Test journal replays to the same output and book", "[journal]") {
+    auto fsyncPolicy = GENERATE(FsyncPolicyEnum::Always, FsyncPolicyEnum::Batched, FsyncPolicyEnum::Deferred,
+                                FsyncPolicyEnum::Never);
+
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    std::vector<std::string> expected;
+    std::vector<std::string> actual;
+
+    BasicMatchingEngine<RegistryTranscriptSink> engine(TestSymbols(), RegistryTranscriptSink{{&expected}});
+
+    JournalConfig config;
+    config.fsyncPolicy = fsyncPolicy;
+    config.batchMessages = 64;
+
+    constexpr unsigned long numMessages = 2000;
+    {
+        Journal journal(fileno(file), TestSymbols(), config);
+        engine.AttachJournal(&journal);
+
+        std::mt19937 random(13);
+        for (unsigned long i = 0; i < numMessages; ++i) {
+            auto symbol = "JOURNAL" + std::to_string(random() % 4);
+            auto orderId = std::to_string(random() % (i + 1));
+            auto action = random() % 10;
+
+            if (action == 0) {
+                engine.OnMessage(ConstructCancelOrder(orderId, symbol));
+            } else if (action == 1) {
+                engine.OnMessage(ConstructReplaceOrder(orderId, symbol, random() % 50, 1090 + random() % 20));
+            } else {
+                auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+                engine.OnMessage(
+                    ConstructNewOrder(std::to_string(i), symbol, side, 1 + random() % 50, 1090 + random() % 20));
+            }
+        }
+
+        REQUIRE(journal.Commit());
+        REQUIRE(!journal.Failed());
+        REQUIRE(journal.Entries() == numMessages);
+
+        if (fsyncPolicy == FsyncPolicyEnum::Always) {
+            REQUIRE(journal.Syncs() > numMessages);
+        } else if (fsyncPolicy == FsyncPolicyEnum::Batched) {
+            REQUIRE(journal.Syncs() > numMessages / config.batchMessages);
+        } else if (fsyncPolicy == FsyncPolicyEnum::Never) {
+            REQUIRE(journal.Syncs() == 0);
+        }
+
+        engine.AttachJournal(nullptr);
+    }
+
+    // a fresh engine fed the journal sees every message under its original sequence number
+    BasicMatchingEngine<RegistryTranscriptSink> replayed(TestSymbols(), RegistryTranscriptSink{{&actual}});
+
+    REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+    FrameReader reader(fileno(file));
+    BinaryParser parser(TestSymbols());
+
+    unsigned long lastSequenceNumber = 0;
+    reader.ForEachFrame([&](const wire::Header &frame) {
+        auto status = parser.Parse(frame);
+        REQUIRE(status != ParseStatusEnum::Malformed);
+
+        if (status == ParseStatusEnum::Ok) {
+            REQUIRE(parser.SequenceNumber() == lastSequenceNumber + 1);
+            lastSequenceNumber = parser.SequenceNumber();
+            replayed.OnMessage(parser.Message(), parser.SequenceNumber());
+        }
+        return true;
+    });
+    std::fclose(file);
+
+    REQUIRE(!reader.Corrupt());
+    REQUIRE(lastSequenceNumber == numMessages);
+    REQUIRE(expected.size() > 1000);
+    REQUIRE(expected == actual);
+    REQUIRE(engine.Dump() == replayed.Dump());
+}
+
+TEST_CASE("Test journal writes an idle tail within the batch interval", "[journal]") {
+    auto fsyncPolicy = GENERATE(FsyncPolicyEnum::Batched, FsyncPolicyEnum::Deferred, FsyncPolicyEnum::Never);
+
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    JournalConfig config;
+    config.fsyncPolicy = fsyncPolicy;
+    config.batchInterval = std::chrono::milliseconds(1);
+
+    auto written = [&] {
+        struct stat info;
+        REQUIRE(fstat(fileno(file), &info) == 0);
+        return info.st_size > 0;
+    };
+
+    {
+        Journal journal(fileno(file), TestSymbols(), config);
+
+        // nothing else is appended, so only the interval gets the entry written
+        REQUIRE(journal.Append(ConstructNewOrder("1", "IDLETAIL", SideEnum::Buy, 5, 100), 1));
+
+        // the calling thread commits once it is due, the sync thread does so by itself
+        auto start = std::chrono::steady_clock::now();
+        while (!written() && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+            if (auto deadline = journal.CommitDeadline()) {
+                REQUIRE(fsyncPolicy != FsyncPolicyEnum::Deferred);
+                std::this_thread::sleep_until(*deadline);
+                REQUIRE(journal.CommitIfDue());
+            } else {
+                std::this_thread::sleep_for(config.batchInterval);
+            }
+        }
+
+        REQUIRE(written());
+        REQUIRE(!journal.CommitDeadline());
+        if (fsyncPolicy == FsyncPolicyEnum::Never) {
+            REQUIRE(journal.Syncs() == 0);
+        } else {
+            // synced straight after writing, give the sync thread the moment it needs
+            while (journal.Syncs() == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5)) {
+                std::this_thread::sleep_for(config.batchInterval);
+            }
+            REQUIRE(journal.Syncs() > 0);
+        }
+    }
+    std::fclose(file);
+}
+
+TEST_CASE("Test messages the journal fails to take are rejected", "[journal]") {
+    auto fsyncPolicy = GENERATE(FsyncPolicyEnum::Always, FsyncPolicyEnum::Batched);
+
+    // writing to the read end of a pipe fails straight away
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+
+    std::vector<std::string> transcript;
+    BasicMatchingEngine<RegistryTranscriptSink> engine(TestSymbols(), RegistryTranscriptSink{{&transcript}});
+
+    JournalConfig config;
+    config.fsyncPolicy = fsyncPolicy;
+    config.batchMessages = 1;
+
+    {
+        Journal journal(fds[0], TestSymbols(), config);
+        engine.AttachJournal(&journal);
+
+        engine.OnMessage(ConstructNewOrder("1", "UNJOURNALLED", SideEnum::Sell, 5, 100));
+        engine.OnMessage(ConstructNewOrder("2", "UNJOURNALLED", SideEnum::Buy, 5, 100));
+        engine.OnMessage(ConstructCancelOrder("1", "UNJOURNALLED"));
+
+        REQUIRE(journal.Failed());
+        engine.AttachJournal(nullptr);
+    }
+    close(fds[0]);
+    close(fds[1]);
+
+    std::vector<std::string> expected{"UNJOURNALLED REJECTED 1 JOURNAL_FAILED",
+                                      "UNJOURNALLED REJECTED 2 JOURNAL_FAILED",
+                                      "UNJOURNALLED REJECTED 1 JOURNAL_FAILED"};
+    REQUIRE(expected == transcript);
+    REQUIRE(engine.Dump().empty());
+}
+
+TEST_CASE("Test snapshot restores the books exactly", "[snapshot]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<std::string> expected;
+    std::vector<std::string> actual;
+
+    BasicMatchingEngine<RegistryTranscriptSink> engine(TestSymbols(), RegistryTranscriptSink{{&expected}});
+    BasicMatchingEngine<RegistryTranscriptSink> restored(TestSymbols(), RegistryTranscriptSink{{&actual}});
+
+    for (auto name : {"SNAPSHOT0", "SNAPSHOT1", "SNAPSHOT2"}) {
+        REQUIRE(engine.ConfigureSymbol(TestSymbols().Intern(name), ConstructBookConfig(bookType)));
+    }
+
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    // the restored engine takes over from the snapshot half way through, after
+    // which both must give the same output
+    constexpr unsigned long numMessages = 20000;
+    std::mt19937 random(17);
+    for (unsigned long i = 0; i < numMessages; ++i) {
+        if (i == numMessages / 2) {
+            SnapshotWriter writer(fileno(file), TestSymbols());
+            REQUIRE(engine.WriteSnapshot(writer));
+
+            REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+            SnapshotReader reader(fileno(file), TestSymbols());
+            REQUIRE(restored.LoadSnapshot(reader));
+
+            REQUIRE(restored.SequenceNumber() == engine.SequenceNumber());
+            REQUIRE(restored.Dump() == engine.Dump());
+            expected.clear();
+        }
+
+        auto symbol = "SNAPSHOT" + std::to_string(random() % 3);
+        auto orderId = std::to_string(random() % (i + 1));
+        auto action = random() % 10;
+
+        auto onMessage = [&](const MessageHeader &msg) {
+            engine.OnMessage(msg);
+            if (i >= numMessages / 2) {
+                restored.OnMessage(msg);
+            }
+        };
+
+        if (action == 0) {
+            onMessage(ConstructCancelOrder(orderId, symbol));
+        } else if (action == 1) {
+            onMessage(ConstructReplaceOrder(orderId, symbol, random() % 50, 1090 + random() % 20));
+        } else {
+            auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+            onMessage(ConstructNewOrder(std::to_string(i), symbol, side, 1 + random() % 50, 1090 + random() % 20));
+        }
+    }
+    std::fclose(file);
+
+    REQUIRE(expected.size() > 5000);
+    REQUIRE(expected == actual);
+    REQUIRE(engine.Dump() == restored.Dump());
+}
+
+TEST_CASE("Test snapshot that is cut short is not loaded", "[snapshot]") {
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    for (unsigned long i = 0; i < 100; ++i) {
+        engine.OnMessage(ConstructNewOrder("CUT" + std::to_string(i), "SNAPSHOTCUT", SideEnum::Buy, 1, 1000 + i));
+    }
+
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    SnapshotWriter writer(fileno(file), TestSymbols());
+    REQUIRE(engine.WriteSnapshot(writer));
+
+    // one whole order short
+    auto size = lseek(fileno(file), 0, SEEK_END);
+    REQUIRE(ftruncate(fileno(file), size - static_cast<off_t>(sizeof(wire::RestingOrder))) == 0);
+
+    REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+    SnapshotReader reader(fileno(file), TestSymbols());
+    MatchingEngine restored(TestSymbols(), [](const MessageHeader &) {});
+    REQUIRE(!restored.LoadSnapshot(reader));
+    REQUIRE(restored.Dump().empty());
+    REQUIRE(restored.SequenceNumber() == 0);
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test snapshot with a corrupt book size is not loaded", "[snapshot]") {
+    // each is far more than could be allocated
+    auto field = GENERATE(&wire::BookSnapshot::numOrders, &wire::BookSnapshot::numLevels,
+                          &wire::BookSnapshot::poolCapacity, &wire::BookSnapshot::poolGrowBy);
+
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    engine.OnMessage(ConstructNewOrder("SIZE", "SNAPSHOTSIZE", SideEnum::Buy, 1, 1000));
+
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    SnapshotWriter writer(fileno(file), TestSymbols());
+    REQUIRE(engine.WriteSnapshot(writer));
+
+    // find the book among the frames and overwrite the size in place
+    off_t offset = 0;
+    wire::BookSnapshot book{};
+    for (;;) {
+        REQUIRE(pread(fileno(file), &book.header, sizeof(book.header), offset) ==
+                static_cast<ssize_t>(sizeof(book.header)));
+        if (book.header.messageType == MessageTypeEnum::BookSnapshot) {
+            break;
+        }
+        offset += static_cast<off_t>(book.header.length);
+    }
+    REQUIRE(pread(fileno(file), &book, sizeof(book), offset) == static_cast<ssize_t>(sizeof(book)));
+    book.*field = std::uint64_t{1} << 40;
+    REQUIRE(pwrite(fileno(file), &book, sizeof(book), offset) == static_cast<ssize_t>(sizeof(book)));
+
+    REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+    SnapshotReader reader(fileno(file), TestSymbols());
+    MatchingEngine restored(TestSymbols(), [](const MessageHeader &) {});
+    REQUIRE(!restored.LoadSnapshot(reader));
+    REQUIRE(restored.Dump().empty());
+    REQUIRE(restored.SequenceNumber() == 0);
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test recovery picks up where the engine crashed", "[recovery]") {
+    auto withSnapshot = GENERATE(true, false);
+
+    std::vector<std::string> expected;
+    std::vector<std::string> actual;
+    std::vector<std::string> crashedOutput;
+
+    BasicMatchingEngine<RegistryTranscriptSink> engine(TestSymbols(), RegistryTranscriptSink{{&expected}});
+    BasicMatchingEngine<RegistryTranscriptSink> recovered(TestSymbols(), RegistryTranscriptSink{{&actual}});
+    std::optional<BasicMatchingEngine<RegistryTranscriptSink>> crashed;
+    crashed.emplace(TestSymbols(), RegistryTranscriptSink{{&crashedOutput}});
+
+    auto *journalFile = std::tmpfile();
+    auto *snapshotFile = std::tmpfile();
+    REQUIRE(journalFile != nullptr);
+    REQUIRE(snapshotFile != nullptr);
+
+    std::optional<Journal> journal;
+    journal.emplace(fileno(journalFile), TestSymbols());
+    crashed->AttachJournal(&*journal);
+
+    // the crashed engine takes a snapshot half way through and stops three
+    // quarters of the way, the recovered one carries on from there
+    constexpr unsigned long numMessages = 20000;
+    constexpr unsigned long snapshotAt = numMessages / 2;
+    constexpr unsigned long crashAt = numMessages * 3 / 4;
+
+    std::mt19937 random(19);
+    for (unsigned long i = 0; i < numMessages; ++i) {
+        if (i == snapshotAt && withSnapshot) {
+            SnapshotWriter writer(fileno(snapshotFile), TestSymbols());
+            REQUIRE(crashed->WriteSnapshot(writer));
+        }
+
+        if (i == crashAt) {
+            REQUIRE(journal->Commit());
+            journal.reset();
+            crashed.reset();
+
+            // and died part way through writing the next entry
+            wire::JournalEntry torn{};
+            torn.header.messageType = MessageTypeEnum::JournalEntry;
+            torn.header.length = sizeof(wire::JournalEntry) + sizeof(wire::NewOrder);
+            torn.sequenceNumber = crashAt + 1;
+
+            auto journalBytes = lseek(fileno(journalFile), 0, SEEK_END);
+            REQUIRE(write(fileno(journalFile), &torn, sizeof(torn)) == static_cast<ssize_t>(sizeof(torn)));
+
+            REQUIRE(lseek(fileno(journalFile), 0, SEEK_SET) == 0);
+            REQUIRE(lseek(fileno(snapshotFile), 0, SEEK_SET) == 0);
+            auto result =
+                Recover(recovered, TestSymbols(), withSnapshot ? fileno(snapshotFile) : -1, fileno(journalFile));
+
+            REQUIRE(result.status == RecoveryStatusEnum::Ok);
+            REQUIRE(result.snapshotSequenceNumber == (withSnapshot ? snapshotAt : 0));
+            REQUIRE(result.replayed == crashAt - result.snapshotSequenceNumber);
+            REQUIRE(result.journalCutShort);
+            REQUIRE(result.journalBytes == static_cast<unsigned long>(journalBytes));
+
+            // the output of the replayed messages went out before the crash
+            REQUIRE(actual.empty());
+            REQUIRE(recovered.SequenceNumber() == engine.SequenceNumber());
+            REQUIRE(recovered.Dump() == engine.Dump());
+            expected.clear();
+        }
+
+        auto symbol = "RECOVERY" + std::to_string(random() % 3);
+        auto orderId = std::to_string(random() % (i + 1));
+        auto action = random() % 10;
+
+        auto onMessage = [&](const MessageHeader &msg) {
+            engine.OnMessage(msg);
+            if (i < crashAt) {
+                crashed->OnMessage(msg);
+            } else {
+                recovered.OnMessage(msg);
+            }
+        };
+
+        if (action == 0) {
+            onMessage(ConstructCancelOrder(orderId, symbol));
+        } else if (action == 1) {
+            onMessage(ConstructReplaceOrder(orderId, symbol, random() % 50, 1090 + random() % 20));
+        } else {
+            auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+            onMessage(ConstructNewOrder(std::to_string(i), symbol, side, 1 + random() % 50, 1090 + random() % 20));
+        }
+    }
+    std::fclose(journalFile);
+    std::fclose(snapshotFile);
+
+    REQUIRE(expected.size() > 2500);
+    REQUIRE(expected == actual);
+    REQUIRE(engine.SequenceNumber() == recovered.SequenceNumber());
+    REQUIRE(engine.Dump() == recovered.Dump());
+}
+
+TEST_CASE("Test recovery refuses a journal corrupt before its end", "[recovery]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    {
+        Journal journal(fileno(file), TestSymbols());
+        for (unsigned long i = 1; i <= 4; ++i) {
+            auto orderId = "BAD" + std::to_string(i);
+            REQUIRE(journal.Append(ConstructNewOrder(orderId, "RECOVERYBAD", SideEnum::Buy, 1, 1000), i));
+        }
+        REQUIRE(journal.Commit());
+    }
+
+    // give the second entry a length too short for any message, past the
+    // symbol definition and the first entry
+    off_t offset = 0;
+    wire::Header header{};
+    for (auto entries = 0; entries < 2;) {
+        REQUIRE(pread(fileno(file), &header, sizeof(header), offset) == static_cast<ssize_t>(sizeof(header)));
+        if (header.messageType == MessageTypeEnum::JournalEntry && ++entries == 2) {
+            break;
+        }
+        offset += static_cast<off_t>(header.length);
+    }
+    header.length = 3;
+    REQUIRE(pwrite(fileno(file), &header, sizeof(header), offset) == static_cast<ssize_t>(sizeof(header)));
+
+    REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    auto result = Recover(engine, TestSymbols(), -1, fileno(file));
+
+    // the entries after the corrupt one are not to be cut off with it
+    REQUIRE(result.status == RecoveryStatusEnum::BadJournal);
+    REQUIRE(!result.journalCutShort);
+    std::fclose(file);
+}
+
+TEST_CASE("Test recovery replays a journal of text input with a bad side", "[recovery]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    {
+        Journal journal(fileno(file), TestSymbols());
+        engine.AttachJournal(&journal);
+
+        // the line with the bad side is skipped, not matched as a sell and
+        // journalled as something recovery cannot read back
+        TextParser parser(TestSymbols());
+        for (auto line : {"1 BUY BADSIDE 10 100", "2 FOO BADSIDE 5 100", "3 SELL BADSIDE 3 100"}) {
+            if (parser.Parse(line) == ParseStatusEnum::Ok) {
+                engine.OnMessage(parser.Message());
+            }
+        }
+        REQUIRE(journal.Commit());
+        engine.AttachJournal(nullptr);
+    }
+    REQUIRE(engine.SequenceNumber() == 2);
+
+    REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+    MatchingEngine recovered(TestSymbols(), [](const MessageHeader &) {});
+    auto result = Recover(recovered, TestSymbols(), -1, fileno(file));
+    std::fclose(file);
+
+    REQUIRE(result.status == RecoveryStatusEnum::Ok);
+    REQUIRE(result.replayed == 2);
+    REQUIRE(recovered.Dump() == engine.Dump());
+}
+
+TEST_CASE("Test recovery stops at a gap in the journal", "[recovery]") {
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    {
+        Journal journal(fileno(file), TestSymbols());
+        REQUIRE(journal.Append(ConstructNewOrder("GAP1", "RECOVERYGAP", SideEnum::Buy, 1, 1000), 1));
+        REQUIRE(journal.Append(ConstructNewOrder("GAP3", "RECOVERYGAP", SideEnum::Buy, 1, 1000), 3));
+        REQUIRE(journal.Commit());
+    }
+
+    REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    auto result = Recover(engine, TestSymbols(), -1, fileno(file));
+    std::fclose(file);
+
+    REQUIRE(result.status == RecoveryStatusEnum::MissingMessages);
+    REQUIRE(result.replayed == 1);
+}
+
+// records each level update as "SIDE price quantity numOrders"
+struct LevelRecorder {
+    std::vector<std::string> *updates;
+
+    void operator()(const LevelUpdate &update) const {
+        updates->push_back(std::string(SideEnum::ToString(update.side)) + ' ' + std::to_string(update.price) + ' ' +
+                           std::to_string(update.quantity) + ' ' + std::to_string(update.numOrders));
+    }
+};
+
+TEST_CASE("Test level updates follow every change to a level", "[marketdata]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<std::string> updates;
+    BasicMatchingEngine<std::function<void(const MessageHeader &)>, LevelRecorder> engine(
+        TestSymbols(), [](const MessageHeader &) {}, LevelRecorder{&updates});
+
+    auto symbol = TestSymbols().Intern("LEVELS");
+    engine.ConfigureSymbol(symbol, ConstructBookConfig(bookType));
+
+    engine.OnMessage(ConstructNewOrder("1", "LEVELS", SideEnum::Buy, 10, 1100));
+    engine.OnMessage(ConstructNewOrder("2", "LEVELS", SideEnum::Buy, 5, 1100));
+    engine.OnMessage(ConstructNewOrder("3", "LEVELS", SideEnum::Buy, 7, 1099));
+    REQUIRE(updates == std::vector<std::string>{"BUY 1100 10 1", "BUY 1100 15 2", "BUY 1099 7 1"});
+    updates.clear();
+
+    // sweeps the first level and part of the second, each reported once
+    engine.OnMessage(ConstructNewOrder("4", "LEVELS", SideEnum::Sell, 20, 1099));
+    REQUIRE(updates == std::vector<std::string>{"BUY 1100 0 0", "BUY 1099 2 1"});
+    updates.clear();
+
+    engine.OnMessage(ConstructReplaceOrder("3", "LEVELS", 1, 1099));
+    engine.OnMessage(ConstructNewOrder("5", "LEVELS", SideEnum::Sell, 3, 1101));
+    engine.OnMessage(ConstructReplaceOrder("5", "LEVELS", 4, 1101));
+    engine.OnMessage(ConstructCancelOrder("3", "LEVELS"));
+    REQUIRE(updates == std::vector<std::string>{"BUY 1099 1 1", "SELL 1101 3 1", "SELL 1101 0 0", "SELL 1101 4 1",
+                                                "BUY 1099 0 0"});
+
+    // rejects and unknown cancels change nothing
+    updates.clear();
+    engine.OnMessage(ConstructNewOrder("5", "LEVELS", SideEnum::Sell, 3, 1101));
+    engine.OnMessage(ConstructCancelOrder("3", "LEVELS"));
+    REQUIRE(updates.empty());
+
+    REQUIRE(engine.Level(symbol, SideEnum::Sell, 1101).quantity == 4);
+    REQUIRE(engine.Level(symbol, SideEnum::Sell, 1101).numOrders == 1);
+    REQUIRE(engine.Level(symbol, SideEnum::Buy, 1099).numOrders == 0);
+}
+
+TEST_CASE("Test level updates rebuild the depth of the books", "[marketdata]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    // the latest update for each level, by symbol, side and price
+    std::map<std::tuple<SymbolId, SideEnum::Type, unsigned long>, LevelTotals> depth;
+    auto onLevel = [&](const LevelUpdate &update) {
+        depth[{update.symbol, update.side, update.price}] = LevelTotals{update.quantity, update.numOrders};
+    };
+    BasicMatchingEngine<std::function<void(const MessageHeader &)>, std::function<void(const LevelUpdate &)>> engine(
+        TestSymbols(), [](const MessageHeader &) {}, onLevel);
+
+    for (auto name : {"DEPTH0", "DEPTH1", "DEPTH2"}) {
+        REQUIRE(engine.ConfigureSymbol(TestSymbols().Intern(name), ConstructBookConfig(bookType)));
+    }
+
+    std::mt19937 random(23);
+    for (unsigned long i = 0; i < 20000; ++i) {
+        auto symbol = "DEPTH" + std::to_string(random() % 3);
+        auto orderId = std::to_string(random() % (i + 1));
+        auto action = random() % 10;
+
+        if (action == 0) {
+            engine.OnMessage(ConstructCancelOrder(orderId, symbol));
+        } else if (action == 1) {
+            engine.OnMessage(ConstructReplaceOrder(orderId, symbol, random() % 50, 1090 + random() % 20));
+        } else {
+            auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+            engine.OnMessage(
+                ConstructNewOrder(std::to_string(i), symbol, side, 1 + random() % 50, 1090 + random() % 20));
+        }
+    }
+
+    // totalled up from the resting orders
+    std::map<std::tuple<SymbolId, SideEnum::Type, unsigned long>, LevelTotals> expected;
+    engine.ForEachOrder([&](const std::string &, const Order &order) {
+        auto &totals = expected[{order.Symbol(), order.Side(), order.Price()}];
+        totals.quantity += order.Quantity();
+        totals.numOrders++;
+    });
+    REQUIRE(expected.size() > 10);
+
+    for (auto const &[level, totals] : depth) {
+        auto const &[symbol, side, price] = level;
+        auto it = expected.find(level);
+
+        auto expectedTotals = it != expected.end() ? it->second : LevelTotals{};
+        REQUIRE(totals.quantity == expectedTotals.quantity);
+        REQUIRE(totals.numOrders == expectedTotals.numOrders);
+        REQUIRE(engine.Level(symbol, side, price).quantity == expectedTotals.quantity);
+        REQUIRE(engine.Level(symbol, side, price).numOrders == expectedTotals.numOrders);
+    }
+    for (auto const &entry : expected) {
+        REQUIRE(depth.count(entry.first) == 1);
+    }
+}
+
+NewOrder WithType(NewOrder newOrder, OrderTypeEnum::Type orderType, TimeInForceEnum::Type timeInForce) {
+    newOrder.orderType = orderType;
+    newOrder.timeInForce = timeInForce;
+    return newOrder;
+}
+
+TEST_CASE("Test market and immediate or cancel orders never rest", "[ordertypes]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<std::string> transcript;
+    std::vector<std::string> updates;
+    BasicMatchingEngine<TranscriptSink, LevelRecorder> engine(TestSymbols(), TranscriptSink{&transcript},
+                                                              LevelRecorder{&updates});
+    engine.ConfigureSymbol(TestSymbols().Intern("TYPES"), ConstructBookConfig(bookType));
+
+    engine.OnMessage(ConstructNewOrder("1", "TYPES", SideEnum::Sell, 10, 1100));
+    engine.OnMessage(ConstructNewOrder("2", "TYPES", SideEnum::Sell, 10, 1105));
+    engine.OnMessage(ConstructNewOrder("3", "TYPES", SideEnum::Sell, 10, 1110));
+    updates.clear();
+
+    // trades up to its price, then the rest is cancelled rather than resting
+    engine.OnMessage(
+        WithType(ConstructNewOrder("4", "TYPES", SideEnum::Buy, 15, 1102), OrderTypeEnum::Limit,
+                 TimeInForceEnum::ImmediateOrCancel));
+    REQUIRE(transcript == std::vector<std::string>{"BATCH 1", "TRADE TYPES 4 1 10 1100", "CANCELED 4 5"});
+    REQUIRE(updates == std::vector<std::string>{"SELL 1100 0 0"});
+    transcript.clear();
+
+    // trades at any price, here through both remaining levels
+    engine.OnMessage(
+        WithType(ConstructNewOrder("5", "TYPES", SideEnum::Buy, 25, 0), OrderTypeEnum::Market,
+                 TimeInForceEnum::GoodTillCancel));
+    REQUIRE(transcript == std::vector<std::string>{"BATCH 2", "TRADE TYPES 5 2 10 1105", "TRADE TYPES 5 3 10 1110",
+                                                   "CANCELED 5 5"});
+    transcript.clear();
+
+    // against an empty side all of it is cancelled
+    engine.OnMessage(
+        WithType(ConstructNewOrder("6", "TYPES", SideEnum::Buy, 7, 0), OrderTypeEnum::Market,
+                 TimeInForceEnum::ImmediateOrCancel));
+    REQUIRE(transcript == std::vector<std::string>{"CANCELED 6 7"});
+
+    REQUIRE(engine.Dump().empty());
+}
+
+TEST_CASE("Test fill or kill orders fill completely or change nothing", "[ordertypes]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    std::vector<std::string> transcript;
+    std::vector<std::string> updates;
+    BasicMatchingEngine<TranscriptSink, LevelRecorder> engine(TestSymbols(), TranscriptSink{&transcript},
+                                                              LevelRecorder{&updates});
+    engine.ConfigureSymbol(TestSymbols().Intern("TYPES"), ConstructBookConfig(bookType));
+
+    engine.OnMessage(ConstructNewOrder("1", "TYPES", SideEnum::Buy, 10, 1100));
+    engine.OnMessage(ConstructNewOrder("2", "TYPES", SideEnum::Buy, 10, 1095));
+    engine.OnMessage(ConstructNewOrder("3", "TYPES", SideEnum::Buy, 10, 1090));
+    auto before = engine.Dump();
+    updates.clear();
+
+    // more than is bid at its price or better, or at any price
+    engine.OnMessage(
+        WithType(ConstructNewOrder("4", "TYPES", SideEnum::Sell, 21, 1095), OrderTypeEnum::Limit,
+                 TimeInForceEnum::FillOrKill));
+    engine.OnMessage(
+        WithType(ConstructNewOrder("5", "TYPES", SideEnum::Sell, 31, 0), OrderTypeEnum::Market,
+                 TimeInForceEnum::FillOrKill));
+    REQUIRE(transcript ==
+            std::vector<std::string>{"REJECTED 4 INSUFFICIENT_QUANTITY", "REJECTED 5 INSUFFICIENT_QUANTITY"});
+    REQUIRE(updates.empty());
+    REQUIRE(engine.Dump() == before);
+    transcript.clear();
+
+    engine.OnMessage(
+        WithType(ConstructNewOrder("6", "TYPES", SideEnum::Sell, 20, 1095), OrderTypeEnum::Limit,
+                 TimeInForceEnum::FillOrKill));
+    REQUIRE(transcript == std::vector<std::string>{"BATCH 2", "TRADE TYPES 6 1 10 1100", "TRADE TYPES 6 2 10 1095"});
+    transcript.clear();
+
+    engine.OnMessage(
+        WithType(ConstructNewOrder("7", "TYPES", SideEnum::Sell, 10, 0), OrderTypeEnum::Market,
+                 TimeInForceEnum::FillOrKill));
+    REQUIRE(transcript == std::vector<std::string>{"BATCH 1", "TRADE TYPES 7 3 10 1090"});
+    REQUIRE(engine.Dump().empty());
+}
+
+TEST_CASE("Test cumulative depth through a price and the price to fill", "[depth]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    auto symbol = TestSymbols().Intern("CUMULATIVE");
+    engine.ConfigureSymbol(symbol, ConstructBookConfig(bookType));
+
+    engine.OnMessage(ConstructNewOrder("1", "CUMULATIVE", SideEnum::Sell, 10, 1100));
+    engine.OnMessage(ConstructNewOrder("2", "CUMULATIVE", SideEnum::Sell, 5, 1105));
+    engine.OnMessage(ConstructNewOrder("3", "CUMULATIVE", SideEnum::Sell, 15, 1105));
+    engine.OnMessage(ConstructNewOrder("4", "CUMULATIVE", SideEnum::Sell, 30, 1110));
+    engine.OnMessage(ConstructNewOrder("5", "CUMULATIVE", SideEnum::Buy, 10, 1095));
+    engine.OnMessage(ConstructNewOrder("6", "CUMULATIVE", SideEnum::Buy, 5, 1090));
+
+    // asks count from the lowest price up, bids from the highest down
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 0) == 0);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 1099) == 0);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 1100) == 10);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 1104) == 10);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 1105) == 30);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 5000) == 60);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Buy, 5000) == 0);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Buy, 1096) == 0);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Buy, 1091) == 10);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Buy, 1090) == 15);
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Buy, 0) == 15);
+
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, 1) == 1100);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, 10) == 1100);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, 11) == 1105);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, 60) == 1110);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, 61) == std::nullopt);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Buy, 11) == 1090);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Buy, 16) == std::nullopt);
+
+    // kept up to date through fills, replaces and cancels
+    engine.OnMessage(ConstructNewOrder("7", "CUMULATIVE", SideEnum::Buy, 15, 1105));
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 1105) == 15);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, 16) == 1110);
+
+    engine.OnMessage(ConstructReplaceOrder("4", "CUMULATIVE", 10, 1110));
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, 1110) == 25);
+
+    engine.OnMessage(ConstructCancelOrder("5", "CUMULATIVE"));
+    REQUIRE(engine.QuantityThrough(symbol, SideEnum::Buy, 1090) == 5);
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Buy, 5) == 1090);
+
+    REQUIRE(engine.QuantityThrough(TestSymbols().Intern("NO_BOOK"), SideEnum::Buy, 0) == 0);
+    REQUIRE(engine.PriceToFill(TestSymbols().Intern("NO_BOOK"), SideEnum::Buy, 1) == std::nullopt);
+}
+
+TEST_CASE("Test cumulative depth matches the resting orders", "[depth]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    auto symbol = TestSymbols().Intern("CUMULATIVE");
+    engine.ConfigureSymbol(symbol, ConstructBookConfig(bookType));
+
+    std::mt19937 random(31);
+    for (unsigned long i = 0; i < 20000; ++i) {
+        auto orderId = std::to_string(random() % (i + 1));
+        auto action = random() % 10;
+
+        if (action == 0) {
+            engine.OnMessage(ConstructCancelOrder(orderId, "CUMULATIVE"));
+        } else if (action == 1) {
+            engine.OnMessage(ConstructReplaceOrder(orderId, "CUMULATIVE", random() % 50, 1050 + random() % 100));
+        } else {
+            auto side = random() % 2 == 0 ? SideEnum::Buy : SideEnum::Sell;
+            engine.OnMessage(ConstructNewOrder(std::to_string(i), "CUMULATIVE", side, 1 + random() % 50,
+                                               1050 + random() % 100));
+        }
+    }
+
+    // totalled up from the resting orders, by side and price
+    std::map<unsigned long, unsigned long> bids;
+    std::map<unsigned long, unsigned long> asks;
+    engine.ForEachOrder([&](const std::string &, const Order &order) {
+        (order.Side() == SideEnum::Buy ? bids : asks)[order.Price()] += order.Quantity();
+    });
+    REQUIRE(bids.size() > 10);
+    REQUIRE(asks.size() > 10);
+
+    for (unsigned long price = 1000; price < 1200; ++price) {
+        unsigned long bidTotal = 0;
+        for (auto it = bids.lower_bound(price); it != bids.end(); ++it) {
+            bidTotal += it->second;
+        }
+        unsigned long askTotal = 0;
+        for (auto it = asks.begin(); it != asks.end() && it->first <= price; ++it) {
+            askTotal += it->second;
+        }
+
+        REQUIRE(engine.QuantityThrough(symbol, SideEnum::Buy, price) == bidTotal);
+        REQUIRE(engine.QuantityThrough(symbol, SideEnum::Sell, price) == askTotal);
+    }
+
+    unsigned long askTotal = 0;
+    for (auto const &[price, quantity] : asks) {
+        REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, askTotal + 1) == price);
+        askTotal += quantity;
+        REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, askTotal) == price);
+    }
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Sell, askTotal + 1) == std::nullopt);
+
+    unsigned long bidTotal = 0;
+    for (auto it = bids.rbegin(); it != bids.rend(); ++it) {
+        REQUIRE(engine.PriceToFill(symbol, SideEnum::Buy, bidTotal + 1) == it->first);
+        bidTotal += it->second;
+        REQUIRE(engine.PriceToFill(symbol, SideEnum::Buy, bidTotal) == it->first);
+    }
+    REQUIRE(engine.PriceToFill(symbol, SideEnum::Buy, bidTotal + 1) == std::nullopt);
+}
+
+TEST_CASE("Test top of book follows the best prices and the last trade", "[topofbook]") {
+    auto bookType = GENERATE(BookTypeEnum::Map, BookTypeEnum::Ladder);
+
+    MatchingEngine engine(TestSymbols(), [](const MessageHeader &) {});
+    auto symbol = TestSymbols().Intern("TOP");
+    REQUIRE(engine.Top(symbol) == nullptr);
+    engine.ConfigureSymbol(symbol, ConstructBookConfig(bookType));
+
+    auto *top = engine.Top(symbol);
+    REQUIRE(top != nullptr);
+    REQUIRE(top->Read() == TopOfBook{});
+
+    engine.OnMessage(ConstructNewOrder("1", "TOP", SideEnum::Buy, 10, 1095));
+    engine.OnMessage(ConstructNewOrder("2", "TOP", SideEnum::Sell, 5, 1100));
+    engine.OnMessage(ConstructNewOrder("3", "TOP", SideEnum::Sell, 7, 1100));
+    REQUIRE(top->Read() == TopOfBook{1095, 10, 1100, 12, 0, 0, 3});
+
+    // nothing changes at the top
+    engine.OnMessage(ConstructNewOrder("4", "TOP", SideEnum::Sell, 20, 1105));
+    engine.OnMessage(ConstructNewOrder("5", "TOP", SideEnum::Buy, 20, 1090));
+    REQUIRE(top->Read().version == 3);
+
+    engine.OnMessage(ConstructNewOrder("6", "TOP", SideEnum::Buy, 8, 1100));
+    REQUIRE(top->Read() == TopOfBook{1095, 10, 1100, 4, 1100, 3, 4});
+
+    engine.OnMessage(ConstructCancelOrder("3", "TOP"));
+    REQUIRE(top->Read() == TopOfBook{1095, 10, 1105, 20, 1100, 3, 5});
+
+    engine.OnMessage(ConstructReplaceOrder("1", "TOP", 4, 1095));
+    REQUIRE(top->Read() == TopOfBook{1095, 4, 1105, 20, 1100, 3, 6});
+
+    engine.OnMessage(ConstructNewOrder("7", "TOP", SideEnum::Sell, 24, 1090));
+    REQUIRE(top->Read() == TopOfBook{0, 0, 1105, 20, 1090, 20, 7});
+}
+
+TEST_CASE("Test top of book reads are never torn", "[topofbook]") {
+    TopOfBookCache cache;
+    constexpr unsigned long numUpdates = 200000;
+
+    // every field of each update is the same, so a copy mixing two is seen
+    std::thread writer([&] {
+        for (unsigned long i = 1; i <= numUpdates; ++i) {
+            cache.Publish(TopOfBook{i, i, i, i, i, i, i});
+        }
+    });
+
+    unsigned long lastVersion = 0;
+    unsigned long consistent = 0;
+    while (lastVersion < numUpdates) {
+        TopOfBook top;
+        if (!cache.TryRead(top)) {
+            continue;
+        }
+
+        auto fields = {top.bidPrice, top.bidQuantity, top.askPrice, top.askQuantity, top.lastTradePrice,
+                       top.lastTradeQuantity};
+        for (auto field : fields) {
+            if (field != top.version) {
+                FAIL("torn read of version " << top.version);
+            }
+        }
+        REQUIRE(top.version >= lastVersion);
+
+        lastVersion = top.version;
+        consistent++;
+    }
+
+    writer.join();
+    REQUIRE(consistent > 0);
+    REQUIRE(cache.Read() == TopOfBook{numUpdates, numUpdates, numUpdates, numUpdates, numUpdates, numUpdates,
+                                      numUpdates});
+}
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <string>
+
+#include "catch.hpp"
+#include "output_writer.h"
+
+using namespace gemini;
+
+namespace {
+
+// everything written to the file so far
+std::string ReadBack(std::FILE *file) {
+    std::string result;
+
+    std::rewind(file);
+    char chunk[256];
+    std::size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        result.append(chunk, count);
+    }
+
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("Test output writer formats every message", "[output]") {
+    // the smallest buffer forces flushes in the middle of lines
+    auto capacity = GENERATE(std::size_t{1}, std::size_t{1 << 16});
+
+    auto *file = std::tmpfile();
+    REQUIRE(file != nullptr);
+
+    NewOrder newOrder;
+    newOrder.orderId = OrderId("12");
+    newOrder.symbol = 0;
+    newOrder.side = SideEnum::Sell;
+    newOrder.quantity = 18446744073709551615ul;
+    newOrder.price = 0;
+    Order order(1, newOrder);
+
+    // long enough that the dump line is cut short like snprintf would
+    std::string longSymbol(70, 'S');
+
+    {
+        OutputWriter writer(fileno(file), capacity);
+
+        Trade trade;
+        trade.orderId = OrderId("1");
+        trade.contraOrderId = OrderId("2");
+        trade.quantity = 100;
+        trade.price = 1234;
+        writer.WriteTrade("BTCUSD", trade);
+
+        CancelAck cancelAck;
+        cancelAck.orderId = OrderId("3");
+        cancelAck.quantity = 5;
+        cancelAck.price = 10;
+        writer.WriteCancelAck("ETHUSD", cancelAck);
+
+        ReplaceAck replaceAck;
+        replaceAck.orderId = OrderId("4");
+        replaceAck.quantity = 6;
+        replaceAck.price = 11;
+        writer.WriteReplaceAck("ETHUSD", replaceAck);
+
+        Reject reject;
+        reject.orderId = OrderId("5");
+        reject.reason = RejectReasonEnum::UnknownOrder;
+        writer.WriteReject("ZEC", reject);
+
+        writer.Append('\n');
+        writer.WriteOrder("BTCUSD", order);
+        writer.WriteOrder(longSymbol, order);
+
+        // the rest is written when the writer goes away
+    }
+
+    std::string expected;
+    expected += "TRADE BTCUSD 1 2 100 1234\n";
+    expected += "CANCELED ETHUSD 3 5 10\n";
+    expected += "REPLACED ETHUSD 4 6 11\n";
+    expected += std::string("REJECTED ZEC 5 ") + RejectReasonEnum::ToString(RejectReasonEnum::UnknownOrder) + "\n";
+    expected += "\n";
+    expected += order.ToString("BTCUSD") + "\n";
+    expected += order.ToString(longSymbol) + "\n";
+
+    REQUIRE(expected == ReadBack(file));
+
+    std::fclose(file);
+}
+
+TEST_CASE("Test dump line matches snprintf", "[output]") {
+    NewOrder newOrder;
+    newOrder.orderId = OrderId("123456789012345");
+    newOrder.symbol = 0;
+    newOrder.side = SideEnum::Buy;
+    newOrder.quantity = 100;
+    newOrder.price = 1234;
+    Order order(1, newOrder);
+
+    for (std::size_t symbolSize : {0ul, 6ul, 30ul, 40ul, 100ul}) {
+        std::string symbol(symbolSize, 'S');
+
+        std::string expected(Order::DumpLineSize, '\0');
+        std::snprintf(expected.data(), expected.size(), "%s %s %s %lu %lu", "123456789012345", "BUY", symbol.c_str(),
+                      100ul, 1234ul);
+
+        REQUIRE(expected == order.ToString(symbol));
+    }
+}
@@ -0,0 +1,99 @@
+#include <thread>
+#include <vector>
+
+#include "catch.hpp"
+#include "spsc_queue.h"
+
+using namespace gemini;
+
+TEST_CASE("Test spsc queue wraps around and stays bounded", "[spsc]") {
+    SpscQueue<unsigned long> queue(3);
+    REQUIRE(queue.Capacity() == 4);
+
+    unsigned long value = 0;
+    REQUIRE(!queue.TryPop(value));
+
+    // several laps of the ring
+    for (unsigned long lap = 0; lap < 5; ++lap) {
+        for (unsigned long i = 0; i < 4; ++i) {
+            REQUIRE(queue.TryPush(lap * 4 + i));
+        }
+        REQUIRE(!queue.TryPush(99));
+
+        for (unsigned long i = 0; i < 4; ++i) {
+            REQUIRE(queue.TryPop(value));
+            REQUIRE(value == lap * 4 + i);
+        }
+        REQUIRE(!queue.TryPop(value));
+    }
+}
+
+TEST_CASE("Test spsc queue only shows staged records once published", "[spsc]") {
+    SpscQueue<unsigned long> queue(8);
+
+    REQUIRE(queue.TryStage(1));
+    REQUIRE(queue.TryStage(2));
+    REQUIRE(queue.TryStage(3));
+
+    unsigned long value = 0;
+    REQUIRE(!queue.TryPop(value));
+
+    queue.Publish();
+
+    std::vector<unsigned long> popped;
+    auto count = queue.PopBatch([&](unsigned long record) { popped.push_back(record); }, 2);
+    REQUIRE(count == 2);
+    REQUIRE(popped == std::vector<unsigned long>{1, 2});
+
+    count = queue.PopBatch([&](unsigned long record) { popped.push_back(record); }, 8);
+    REQUIRE(count == 1);
+    REQUIRE(popped == std::vector<unsigned long>{1, 2, 3});
+
+    REQUIRE(queue.PopBatch([](unsigned long) {}, 8) == 0);
+}
+
+TEMPLATE_TEST_CASE("Test spsc queue hands records between threads in order", "[spsc]", BusyPollWait, FutexWait) {
+    constexpr unsigned long count = 100000;
+
+    // small enough that both sides keep waiting on each other
+    SpscQueue<unsigned long, TestType> queue(16);
+
+    std::thread producer([&] {
+        for (unsigned long i = 0; i < count; ++i) {
+            // a mix of single pushes and staged batches of varying length
+            if (i % 7 == 0) {
+                queue.Push(i);
+            } else {
+                queue.Stage(i);
+                if (i % 5 == 0) {
+                    queue.Publish();
+                }
+            }
+        }
+        queue.Publish();
+    });
+
+    unsigned long expected = 0;
+    bool inOrder = true;
+    while (expected < count) {
+        if (expected % 2 == 0) {
+            unsigned long value = 0;
+            queue.Pop(value);
+            inOrder = inOrder && value == expected;
+            expected++;
+        } else {
+            queue.WaitForRecords();
+            queue.PopBatch(
+                [&](unsigned long value) {
+                    inOrder = inOrder && value == expected;
+                    expected++;
+                },
+                3);
+        }
+    }
+
+    producer.join();
+
+    REQUIRE(inOrder);
+    REQUIRE(expected == count);
+}
@@ -0,0 +1,281 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "catch.hpp"
+#include "matching_engine.h"
+#include "wire_messages.h"
+
+using namespace gemini;
+
+namespace {
+
+NewOrder MakeNewOrder(const char *orderId, SymbolId symbol, SideEnum::Type side, unsigned long quantity,
+                      unsigned long price) {
+    NewOrder newOrder;
+    newOrder.orderId = OrderId(orderId);
+    newOrder.symbol = symbol;
+    newOrder.side = side;
+    newOrder.quantity = quantity;
+    newOrder.price = price;
+    return newOrder;
+}
+
+// every field of the messages compared, the message structs only compare trades
+template <typename Message>
+std::string Describe(const Message &msg) {
+    std::string result = MessageTypeEnum::ToString(msg.messageType);
+    result += ' ' + std::to_string(msg.symbol) + ' ' + std::string(msg.orderId.View());
+    if constexpr (std::is_same_v<Message, NewOrder> || std::is_same_v<Message, CancelAck> ||
+                  std::is_same_v<Message, ReplaceAck>) {
+        result += ' ' + std::string(SideEnum::ToString(msg.side));
+    }
+    if constexpr (!std::is_same_v<Message, CancelOrder> && !std::is_same_v<Message, Reject>) {
+        result += ' ' + std::to_string(msg.quantity) + ' ' + std::to_string(msg.price);
+    }
+    if constexpr (std::is_same_v<Message, NewOrder>) {
+        result += ' ' + std::string(OrderTypeEnum::ToString(msg.orderType)) + ' ' +
+                  TimeInForceEnum::ToString(msg.timeInForce);
+    }
+    if constexpr (std::is_same_v<Message, Trade>) {
+        result += ' ' + std::string(msg.contraOrderId.View());
+    }
+    if constexpr (std::is_same_v<Message, Reject>) {
+        result += ' ' + std::string(MessageTypeEnum::ToString(msg.rejectedMessageType)) + ' ' +
+                  RejectReasonEnum::ToString(msg.reason);
+    }
+    return result;
+}
+
+std::string Describe(const LevelUpdate &msg) {
+    return std::string(MessageTypeEnum::ToString(msg.messageType)) + ' ' + std::to_string(msg.symbol) + ' ' +
+           SideEnum::ToString(msg.side) + ' ' + std::to_string(msg.price) + ' ' + std::to_string(msg.quantity) + ' ' +
+           std::to_string(msg.numOrders);
+}
+
+std::string Describe(const OrderUpdate &msg) {
+    return std::string(MessageTypeEnum::ToString(msg.messageType)) + ' ' +
+           OrderUpdateTypeEnum::ToString(msg.updateType) + ' ' + std::to_string(msg.symbol) + ' ' +
+           std::to_string(msg.sequenceNumber) + ' ' + std::string(msg.orderId.View()) + ' ' +
+           SideEnum::ToString(msg.side) + ' ' + std::to_string(msg.price) + ' ' + std::to_string(msg.quantity);
+}
+
+template <typename Message>
+void RequireRoundTrip(const Message &msg) {
+    auto encoded = ToWire(msg);
+    REQUIRE(encoded.header.messageType == msg.messageType);
+    REQUIRE(encoded.header.length == sizeof(encoded));
+
+    // the layouts are plain bytes, so a copy through a byte buffer decodes the same
+    unsigned char bytes[sizeof(encoded)];
+    std::memcpy(bytes, &encoded, sizeof(encoded));
+    decltype(encoded) copied;
+    std::memcpy(&copied, bytes, sizeof(copied));
+
+    Message decoded;
+    REQUIRE(FromWire(copied, decoded));
+    REQUIRE(Describe(decoded) == Describe(msg));
+}
+
+}  // namespace
+
+TEST_CASE("Test wire messages round trip", "[wire]") {
+    RequireRoundTrip(MakeNewOrder("123456789012345", 7, SideEnum::Sell, 18446744073709551615ul, 0));
+    RequireRoundTrip(MakeNewOrder("", 0, SideEnum::Buy, 1, 1));
+
+    auto marketOrder = MakeNewOrder("m1", 2, SideEnum::Buy, 3, 0);
+    marketOrder.orderType = OrderTypeEnum::Market;
+    marketOrder.timeInForce = TimeInForceEnum::FillOrKill;
+    RequireRoundTrip(marketOrder);
+
+    auto immediateOrder = MakeNewOrder("i1", 2, SideEnum::Sell, 3, 4);
+    immediateOrder.timeInForce = TimeInForceEnum::ImmediateOrCancel;
+    RequireRoundTrip(immediateOrder);
+
+    CancelOrder cancelOrder;
+    cancelOrder.orderId = OrderId("c1");
+    cancelOrder.symbol = 3;
+    RequireRoundTrip(cancelOrder);
+
+    ReplaceOrder replaceOrder;
+    replaceOrder.orderId = OrderId("r1");
+    replaceOrder.symbol = 4294967295u;
+    replaceOrder.quantity = 5;
+    replaceOrder.price = 6;
+    RequireRoundTrip(replaceOrder);
+
+    Trade trade;
+    trade.symbol = 1;
+    trade.orderId = OrderId("aggressor");
+    trade.contraOrderId = OrderId("resting");
+    trade.quantity = 10;
+    trade.price = 11;
+    RequireRoundTrip(trade);
+
+    CancelAck cancelAck;
+    cancelAck.symbol = 2;
+    cancelAck.orderId = OrderId("ca");
+    cancelAck.side = SideEnum::Buy;
+    cancelAck.quantity = 12;
+    cancelAck.price = 13;
+    RequireRoundTrip(cancelAck);
+
+    ReplaceAck replaceAck;
+    replaceAck.symbol = 2;
+    replaceAck.orderId = OrderId("ra");
+    replaceAck.side = SideEnum::Sell;
+    replaceAck.quantity = 14;
+    replaceAck.price = 15;
+    RequireRoundTrip(replaceAck);
+
+    Reject reject;
+    reject.symbol = 9;
+    reject.orderId = OrderId("rj");
+    reject.rejectedMessageType = MessageTypeEnum::ReplaceOrder;
+    reject.reason = RejectReasonEnum::PriceNotHeld;
+    RequireRoundTrip(reject);
+
+    LevelUpdate levelUpdate;
+    levelUpdate.symbol = 5;
+    levelUpdate.side = SideEnum::Sell;
+    levelUpdate.price = 16;
+    levelUpdate.quantity = 0;
+    levelUpdate.numOrders = 0;
+    RequireRoundTrip(levelUpdate);
+
+    OrderUpdate orderUpdate;
+    orderUpdate.updateType = OrderUpdateTypeEnum::Fill;
+    orderUpdate.symbol = 6;
+    orderUpdate.sequenceNumber = 17;
+    orderUpdate.orderId = OrderId("ou");
+    orderUpdate.side = SideEnum::Buy;
+    orderUpdate.price = 18;
+    orderUpdate.quantity = 19;
+    RequireRoundTrip(orderUpdate);
+}
+
+TEST_CASE("Test wire messages reject malformed input", "[wire]") {
+    auto good = ToWire(MakeNewOrder("42", 1, SideEnum::Buy, 10, 100));
+    NewOrder decoded;
+
+    auto wrongType = good;
+    wrongType.header.messageType = MessageTypeEnum::CancelOrder;
+    REQUIRE(!FromWire(wrongType, decoded));
+
+    auto wrongLength = good;
+    wrongLength.header.length = sizeof(wire::CancelOrder);
+    REQUIRE(!FromWire(wrongLength, decoded));
+
+    auto badSide = good;
+    badSide.side = 'X';
+    REQUIRE(!FromWire(badSide, decoded));
+
+    auto badOrderType = good;
+    badOrderType.orderType = 'X';
+    REQUIRE(!FromWire(badOrderType, decoded));
+
+    auto badTimeInForce = good;
+    badTimeInForce.timeInForce = 'X';
+    REQUIRE(!FromWire(badTimeInForce, decoded));
+
+    // left as zero, as in messages written before there was a choice
+    auto plain = good;
+    plain.orderType = 0;
+    plain.timeInForce = 0;
+    REQUIRE(FromWire(plain, decoded));
+    REQUIRE(decoded.orderType == OrderTypeEnum::Limit);
+    REQUIRE(decoded.timeInForce == TimeInForceEnum::GoodTillCancel);
+
+    auto longOrderId = good;
+    longOrderId.orderId[OrderId::Capacity] = 16;
+    REQUIRE(!FromWire(longOrderId, decoded));
+
+    // bytes after the id would make it compare unequal to the same id typed in
+    auto trailingBytes = good;
+    trailingBytes.orderId[5] = 'x';
+    REQUIRE(!FromWire(trailingBytes, decoded));
+
+    // acks of one kind do not decode as the other
+    CancelAck cancelAck;
+    cancelAck.orderId = OrderId("1");
+    cancelAck.side = SideEnum::Buy;
+    ReplaceAck replaceAck;
+    REQUIRE(!FromWire(ToWire(cancelAck), replaceAck));
+
+    OrderUpdate orderUpdate;
+    orderUpdate.updateType = OrderUpdateTypeEnum::Delete;
+    orderUpdate.side = SideEnum::Sell;
+    auto badUpdateType = ToWire(orderUpdate);
+    badUpdateType.updateType = 'X';
+    REQUIRE(!FromWire(badUpdateType, orderUpdate));
+
+    REQUIRE(FromWire(good, decoded));
+    REQUIRE(decoded.orderId == OrderId("42"));
+}
+
+TEST_CASE("Test engine takes wire messages", "[wire]") {
+    SymbolRegistry symbols;
+    auto symbol = symbols.Intern("BTCUSD");
+
+    std::vector<std::string> fromStructs;
+    std::vector<std::string> fromWire;
+
+    auto recorder = [](std::vector<std::string> &transcript) {
+        return [&transcript](const MessageHeader &msg) {
+            transcript.push_back(MessageTypeEnum::ToString(msg.messageType));
+            if (msg.messageType == MessageTypeEnum::Trade) {
+                transcript.back() += ' ' + Describe(static_cast<const Trade &>(msg));
+            }
+        };
+    };
+
+    MatchingEngine structEngine(symbols, recorder(fromStructs));
+    MatchingEngine wireEngine(symbols, recorder(fromWire));
+
+    auto newOrder1 = MakeNewOrder("1", symbol, SideEnum::Buy, 100, 1234);
+    auto newOrder2 = MakeNewOrder("2", symbol, SideEnum::Sell, 150, 1234);
+
+    ReplaceOrder replaceOrder;
+    replaceOrder.orderId = OrderId("2");
+    replaceOrder.symbol = symbol;
+    replaceOrder.quantity = 40;
+    replaceOrder.price = 1235;
+
+    CancelOrder cancelOrder;
+    cancelOrder.orderId = OrderId("2");
+    cancelOrder.symbol = symbol;
+
+    structEngine.OnMessage(newOrder1);
+    structEngine.OnMessage(newOrder2);
+    structEngine.OnMessage(replaceOrder);
+    structEngine.OnMessage(cancelOrder);
+    structEngine.OnMessage(cancelOrder);
+
+    REQUIRE(wireEngine.OnMessage(ToWire(newOrder1).header));
+    REQUIRE(wireEngine.OnMessage(ToWire(newOrder2).header));
+    REQUIRE(wireEngine.OnMessage(ToWire(replaceOrder).header));
+    REQUIRE(wireEngine.OnMessage(ToWire(cancelOrder).header));
+    REQUIRE(wireEngine.OnMessage(ToWire(cancelOrder).header));
+
+    REQUIRE(fromStructs.size() == 4);
+    REQUIRE(fromStructs == fromWire);
+    REQUIRE(structEngine.Dump() == wireEngine.Dump());
+
+    // outbound layouts and malformed messages are refused without being sequenced
+    Trade trade;
+    REQUIRE(!wireEngine.OnMessage(ToWire(trade).header));
+
+    auto truncated = ToWire(newOrder1);
+    truncated.header.length = sizeof(wire::Header);
+    REQUIRE(!wireEngine.OnMessage(truncated.header));
+
+    // symbol ids the registry never handed out
+    auto unregistered = MakeNewOrder("3", 5, SideEnum::Buy, 10, 1234);
+    REQUIRE(!wireEngine.OnMessage(ToWire(unregistered).header));
+
+    auto huge = MakeNewOrder("4", 200000000, SideEnum::Buy, 10, 1234);
+    REQUIRE(!wireEngine.OnMessage(ToWire(huge).header));
+
+    REQUIRE(fromWire.size() == 4);
+    REQUIRE(structEngine.Dump() == wireEngine.Dump());
+}